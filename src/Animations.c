@@ -1,4 +1,7 @@
 #include "TexturePack.h"
+#ifdef CC_BUILD_SSE2
+#include <emmintrin.h>
+#endif
 #include "String.h"
 #include "Constants.h"
 #include "Stream.h"
@@ -13,7 +16,7 @@
 #include "Logger.h"
 
 #ifndef CC_DISABLE_ANIMATIONS
-static void Animations_Update(int loc, struct Bitmap* bmp, int stride);
+static void Animations_Queue(int loc, struct Bitmap* bmp, int stride);
 
 #ifdef CC_BUILD_LOWMEM
 	#define LIQUID_ANIM_MAX 16
@@ -24,6 +27,10 @@ static void Animations_Update(int loc, struct Bitmap* bmp, int stride);
 #define WATER_TEX_LOC 14
 #define LAVA_TEX_LOC  30
 
+#if defined CC_BUILD_SSE2 && !defined BITMAP_16BPP
+#define ANIMS_SSE2
+#endif
+
 #ifndef CC_BUILD_WEB
 /* Based off the incredible work from https://dl.dropboxusercontent.com/u/12694594/lava.txt
 	mirrored at https://github.com/ClassiCube/ClassiCube/wiki/Minecraft-Classic-lava-animation-algorithm
@@ -35,13 +42,52 @@ static void Animations_Update(int loc, struct Bitmap* bmp, int stride);
 static float L_soupHeat[LIQUID_ANIM_MAX  * LIQUID_ANIM_MAX];
 static float L_potHeat[LIQUID_ANIM_MAX   * LIQUID_ANIM_MAX];
 static float L_flameHeat[LIQUID_ANIM_MAX * LIQUID_ANIM_MAX];
+static BitmapCol L_pixels[LIQUID_ANIM_MAX * LIQUID_ANIM_MAX];
 static RNGState L_rnd;
 static cc_bool  L_rndInited;
 
+/* Converts the first 'count' soup heat values into lava pixels */
+static void LavaAnimation_Output(int count) {
+	float color;
+	int i = 0;
+#ifdef ANIMS_SSE2
+	__m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	__m128 c, c2, r, g, b;
+	__m128i alpha = _mm_set1_epi32(BitmapColor_A_Bits(255));
+	__m128i pixels;
+
+	for (; i + 4 <= count; i += 4) {
+		c  = _mm_mul_ps(_mm_set1_ps(2.0f), _mm_loadu_ps(&L_soupHeat[i]));
+		c  = _mm_min_ps(_mm_max_ps(c, zero), one);
+		c2 = _mm_mul_ps(c, c);
+
+		/* Same operation order as scalar path below, so output is identical */
+		r = _mm_add_ps(_mm_mul_ps(c, _mm_set1_ps(100.0f)), _mm_set1_ps(155.0f));
+		g = _mm_mul_ps(c2, _mm_set1_ps(255.0f));
+		b = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(c2, c), c), _mm_set1_ps(128.0f));
+
+		pixels = _mm_or_si128(alpha,
+			_mm_or_si128(_mm_slli_epi32(_mm_cvttps_epi32(r), BITMAPCOLOR_R_SHIFT),
+			_mm_or_si128(_mm_slli_epi32(_mm_cvttps_epi32(g), BITMAPCOLOR_G_SHIFT),
+						 _mm_slli_epi32(_mm_cvttps_epi32(b), BITMAPCOLOR_B_SHIFT))));
+		_mm_storeu_si128((__m128i*)&L_pixels[i], pixels);
+	}
+#endif
+
+	for (; i < count; i++) {
+		color = 2.0f * L_soupHeat[i];
+		Math_Clamp(color, 0.0f, 1.0f);
+
+		L_pixels[i] = BitmapCol_Make(
+			color * 100.0f + 155.0f,
+			color * color * 255.0f,
+			color * color * color * color * 128.0f,
+			255);
+	}
+}
+
 static void LavaAnimation_Tick(void) {
-	BitmapCol pixels[LIQUID_ANIM_MAX * LIQUID_ANIM_MAX];
-	BitmapCol* ptr = pixels;
-	float soupHeat, potHeat, color;
+	float soupHeat, potHeat;
 	int size, mask, shift;
 	int x, y, i = 0;
 	struct Bitmap bmp;
@@ -90,23 +136,14 @@ static void LavaAnimation_Tick(void) {
 
 			L_flameHeat[i] -= 0.06f * 0.01f;
 			if (Random_Float(&L_rnd) <= 0.005f) L_flameHeat[i] = 1.5f * 0.01f;
-
-			/* Output the pixel */
-			color = 2.0f * L_soupHeat[i];
-			Math_Clamp(color, 0.0f, 1.0f);
-
-			*ptr = BitmapCol_Make(
-				color * 100.0f + 155.0f,
-				color * color * 255.0f,
-				color * color * color * color * 128.0f,
-				255);
-
-			ptr++; i++;
+			i++;
 		}
 	}
 
-	Bitmap_Init(bmp, size, size, pixels);
-	Animations_Update(LAVA_TEX_LOC, &bmp, size);
+	/* Heat simulation is inherently serial (updated in place), but output conversion isn't */
+	LavaAnimation_Output(size * size);
+	Bitmap_Init(bmp, size, size, L_pixels);
+	Animations_Queue(LAVA_TEX_LOC, &bmp, size);
 }
 
 
@@ -116,13 +153,51 @@ static void LavaAnimation_Tick(void) {
 static float W_soupHeat[LIQUID_ANIM_MAX  * LIQUID_ANIM_MAX];
 static float W_potHeat[LIQUID_ANIM_MAX   * LIQUID_ANIM_MAX];
 static float W_flameHeat[LIQUID_ANIM_MAX * LIQUID_ANIM_MAX];
+static BitmapCol W_pixels[LIQUID_ANIM_MAX * LIQUID_ANIM_MAX];
 static RNGState W_rnd;
 static cc_bool  W_rndInited;
 
+/* Converts the first 'count' soup heat values into water pixels */
+static void WaterAnimation_Output(int count) {
+	float color;
+	int i = 0;
+#ifdef ANIMS_SSE2
+	__m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	__m128 c, r, g, a;
+	__m128i blue = _mm_set1_epi32(BitmapColor_B_Bits(255));
+	__m128i pixels;
+
+	for (; i + 4 <= count; i += 4) {
+		c = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&W_soupHeat[i]), zero), one);
+		c = _mm_mul_ps(c, c);
+
+		r = _mm_add_ps(_mm_set1_ps(32.0f),  _mm_mul_ps(c, _mm_set1_ps(32.0f)));
+		g = _mm_add_ps(_mm_set1_ps(50.0f),  _mm_mul_ps(c, _mm_set1_ps(64.0f)));
+		a = _mm_add_ps(_mm_set1_ps(146.0f), _mm_mul_ps(c, _mm_set1_ps(50.0f)));
+
+		pixels = _mm_or_si128(blue,
+			_mm_or_si128(_mm_slli_epi32(_mm_cvttps_epi32(r), BITMAPCOLOR_R_SHIFT),
+			_mm_or_si128(_mm_slli_epi32(_mm_cvttps_epi32(g), BITMAPCOLOR_G_SHIFT),
+						 _mm_slli_epi32(_mm_cvttps_epi32(a), BITMAPCOLOR_A_SHIFT))));
+		_mm_storeu_si128((__m128i*)&W_pixels[i], pixels);
+	}
+#endif
+
+	for (; i < count; i++) {
+		color = W_soupHeat[i];
+		Math_Clamp(color, 0.0f, 1.0f);
+		color = color * color;
+
+		W_pixels[i] = BitmapCol_Make(
+			32.0f  + color * 32.0f,
+			50.0f  + color * 64.0f,
+			255,
+			146.0f + color * 50.0f);
+	}
+}
+
 static void WaterAnimation_Tick(void) {
-	BitmapCol pixels[LIQUID_ANIM_MAX * LIQUID_ANIM_MAX];
-	BitmapCol* ptr = pixels;
-	float soupHeat, color;
+	float soupHeat;
 	int size, mask, shift;
 	int x, y, i = 0;
 	struct Bitmap bmp;
@@ -151,26 +226,117 @@ static void WaterAnimation_Tick(void) {
 
 			W_flameHeat[i] -= 0.1f * 0.05f;
 			if (Random_Float(&W_rnd) <= 0.05f) W_flameHeat[i] = 0.5f * 0.05f;
+			i++;
+		}
+	}
+
+	WaterAnimation_Output(size * size);
+	Bitmap_Init(bmp, size, size, W_pixels);
+	Animations_Queue(WATER_TEX_LOC, &bmp, size);
+}
+#endif
 
-			/* Output the pixel */
-			color = W_soupHeat[i];
-			Math_Clamp(color, 0.0f, 1.0f);
-			color = color * color;
 
-			*ptr = BitmapCol_Make(
-				32.0f  + color * 32.0f,
-				50.0f  + color * 64.0f,
-				255,
-				146.0f + color * 50.0f);
+/*########################################################################################################################*
+*----------------------------------------------------Animation uploads----------------------------------------------------*
+*#########################################################################################################################*/
+/* Frames are queued during a tick, then uploaded together at the end of it, so that */
+/*  frames for adjacent tiles in the same 1D atlas can be uploaded in one update */
+struct AnimationUpload { int texLoc, stride; struct Bitmap bmp; };
+static struct AnimationUpload anims_uploads[ATLAS1D_MAX_ATLASES + 2];
+static int anims_uploadsCount;
+static BitmapCol* anims_staging;
+static int anims_stagingCount;
+
+static void Animations_Update(int texLoc, struct Bitmap* bmp, int stride) {
+	int dstX = Atlas1D_Index(texLoc);
+	int dstY = Atlas1D_RowId(texLoc) * Atlas2D.TileSize;
+	GfxResourceID tex;
+
+	tex = Atlas1D.TexIds[dstX];
+	if (tex) Gfx_UpdateTexture(tex, 0, dstY, bmp, stride, Gfx.Mipmaps);
+}
+
+#define Animations_IsWholeTile(up) ((up)->bmp.width == Atlas2D.TileSize && (up)->bmp.height == Atlas2D.TileSize)
+static cc_bool Animations_CanMerge(struct AnimationUpload* a, struct AnimationUpload* b) {
+	return b->texLoc == a->texLoc + 1 && Atlas1D_Index(a->texLoc) == Atlas1D_Index(b->texLoc)
+		&& Animations_IsWholeTile(a) && Animations_IsWholeTile(b);
+}
+
+static cc_bool Animations_EnsureStaging(int count) {
+	BitmapCol* staging;
+	if (count <= anims_stagingCount) return true;
 
-			ptr++; i++;
+	staging = (BitmapCol*)Mem_TryRealloc(anims_staging, count, BITMAPCOLOR_SIZE);
+	if (!staging) return false;
+
+	anims_staging      = staging;
+	anims_stagingCount = count;
+	return true;
+}
+
+/* Uploads a run of vertically adjacent tiles in a 1D atlas */
+static void Animations_UploadRun(struct AnimationUpload* ups, int count) {
+	int size = Atlas2D.TileSize, tilePixels = size * size;
+	struct Bitmap part;
+	BitmapCol* dst;
+	int i, y;
+
+	if (!Animations_EnsureStaging(count * tilePixels)) {
+		for (i = 0; i < count; i++) {
+			Animations_Update(ups[i].texLoc, &ups[i].bmp, ups[i].stride);
+		}
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		dst = anims_staging + i * tilePixels;
+		for (y = 0; y < size; y++) {
+			Mem_Copy(dst + y * size, ups[i].bmp.scan0 + y * ups[i].stride, size * BITMAPCOLOR_SIZE);
 		}
 	}
 
-	Bitmap_Init(bmp, size, size, pixels);
-	Animations_Update(WATER_TEX_LOC, &bmp, size);
+	Bitmap_Init(part, size, size * count, anims_staging);
+	Animations_Update(ups[0].texLoc, &part, size);
+}
+
+static void Animations_Flush(void) {
+	struct AnimationUpload* ups = anims_uploads;
+	int i, j;
+
+	for (i = 0; i < anims_uploadsCount; i = j) {
+		for (j = i + 1; j < anims_uploadsCount && Animations_CanMerge(&ups[j - 1], &ups[j]); j++) { }
+
+		if (j - i == 1) {
+			Animations_Update(ups[i].texLoc, &ups[i].bmp, ups[i].stride);
+		} else {
+			Animations_UploadRun(&ups[i], j - i);
+		}
+	}
+	anims_uploadsCount = 0;
+}
+
+/* Queues the given frame to be uploaded to the given tile at the end of this tick */
+static void Animations_Queue(int texLoc, struct Bitmap* bmp, int stride) {
+	int i;
+	if (anims_uploadsCount == Array_Elems(anims_uploads)) Animations_Flush();
+
+	/* Keep queue sorted by tile, but in queued order for frames of the same tile */
+	for (i = anims_uploadsCount; i > 0 && anims_uploads[i - 1].texLoc > texLoc; i--) {
+		anims_uploads[i] = anims_uploads[i - 1];
+	}
+
+	anims_uploads[i].texLoc = texLoc;
+	anims_uploads[i].bmp    = *bmp;
+	anims_uploads[i].stride = stride;
+	anims_uploadsCount++;
+}
+
+static void Animations_FreeStaging(void) {
+	Mem_Free(anims_staging);
+	anims_staging      = NULL;
+	anims_stagingCount = 0;
 }
-#endif
 
 
 /*########################################################################################################################*
@@ -184,7 +350,9 @@ struct AnimationData {
 	cc_uint16 statesCount;    /* Total number of animation frames */
 	cc_uint16 delay;          /* Delay in ticks until next frame is drawn */
 	cc_uint16 frameDelay;     /* Delay between each frame */
+	cc_uint16 uploaded;       /* Frame index last uploaded to the atlas, or ANIM_FRAME_NONE */
 };
+#define ANIM_FRAME_NONE 0xFFFF
 
 static struct Bitmap anims_bmp;
 static struct AnimationData anims_list[ATLAS1D_MAX_ATLASES];
@@ -233,7 +401,7 @@ static void Animations_ReadDescription(struct Stream* stream, const cc_string* p
 		if (!Convert_ParseUInt16(&parts[4], &data.frameSize) || !data.frameSize) {
 			Chat_Add1("&cInvalid anim frame size: %s", &parts[4]); continue;
 		}
-		if (!Convert_ParseUInt16(&parts[5], &data.statesCount)) {
+		if (!Convert_ParseUInt16(&parts[5], &data.statesCount) || !data.statesCount) {
 			Chat_Add1("&cInvalid anim states count: %s", &parts[5]); continue;
 		}
 		if (!Convert_ParseUInt16(&parts[6], &data.frameDelay)) {
@@ -244,20 +412,12 @@ static void Animations_ReadDescription(struct Stream* stream, const cc_string* p
 			Chat_AddRaw("&cCannot show over 512 animations"); return;
 		}
 
-		data.texLoc = tileX + (tileY * ATLAS2D_TILES_PER_ROW);
+		data.texLoc   = tileX + (tileY * ATLAS2D_TILES_PER_ROW);
+		data.uploaded = ANIM_FRAME_NONE;
 		anims_list[anims_count++] = data;
 	}
 }
 
-static void Animations_Update(int texLoc, struct Bitmap* bmp, int stride) {
-	int dstX = Atlas1D_Index(texLoc);
-	int dstY = Atlas1D_RowId(texLoc) * Atlas2D.TileSize;
-	GfxResourceID tex;
-
-	tex = Atlas1D.TexIds[dstX];
-	if (tex) Gfx_UpdateTexture(tex, 0, dstY, bmp, stride, Gfx.Mipmaps);
-}
-
 static void Animations_Apply(struct AnimationData* data) {
 	struct Bitmap frame;
 	int loc, size;
@@ -272,6 +432,9 @@ static void Animations_Apply(struct AnimationData* data) {
 	if (loc == LAVA_TEX_LOC  && useLavaAnim)  return;
 	if (loc == WATER_TEX_LOC && useWaterAnim) return;
 #endif
+	/* Frame is still in the atlas (e.g. single frame animations) */
+	if (data->state == data->uploaded) return;
+	data->uploaded = data->state;
 
 	size = data->frameSize;
 	Bitmap_Init(frame, size, size, NULL);
@@ -279,7 +442,7 @@ static void Animations_Apply(struct AnimationData* data) {
 	frame.scan0 = anims_bmp.scan0 
 				+ data->frameY * anims_bmp.width
 				+ (data->frameX + data->state * size);
-	Animations_Update(loc, &frame, anims_bmp.width);
+	Animations_Queue(loc, &frame, anims_bmp.width);
 }
 
 static cc_bool Animations_IsDefaultZip(void) {
@@ -292,6 +455,7 @@ static cc_bool Animations_IsDefaultZip(void) {
 }
 
 static void Animations_Clear(void) {
+	Animations_FreeStaging();
 	Mem_Free(anims_bmp.scan0);
 	anims_count = 0;
 	anims_bmp.scan0 = NULL;
@@ -340,18 +504,18 @@ static void Animations_Tick(struct ScheduledTask* task) {
 	if (useWaterAnim) WaterAnimation_Tick();
 #endif
 
-	if (!anims_count) return;
-	if (!anims_bmp.scan0) {
+	if (anims_count && !anims_bmp.scan0) {
 		Chat_AddRaw("&cCurrent texture pack specifies it uses animations,");
 		Chat_AddRaw("&cbut is missing animations.png");
-		anims_count = 0; return;
+		anims_count = 0;
 	}
 
 	/* deferred, because when reading animations.txt, might not have read animations.png yet */
-	if (!anims_validated) Animations_Validate();
+	if (anims_count && !anims_validated) Animations_Validate();
 	for (i = 0; i < anims_count; i++) {
 		Animations_Apply(&anims_list[i]);
 	}
+	Animations_Flush();
 }
 
 
@@ -389,6 +553,14 @@ static void OnPackChanged(void* obj) {
 	alwaysLavaAnim  = false;
 	alwaysWaterAnim = false;
 }
+/* Atlas textures are recreated from terrain.png, so all frames need to be uploaded again */
+static void OnAtlasReset(void* obj) {
+	int i;
+	for (i = 0; i < anims_count; i++) {
+		anims_list[i].uploaded = ANIM_FRAME_NONE;
+	}
+}
+
 static void OnInit(void) {
 	TextureEntry_Register(&animations_entry);
 	TextureEntry_Register(&animations_txt);
@@ -396,7 +568,9 @@ static void OnInit(void) {
 	TextureEntry_Register(&lava_entry);
 
 	ScheduledTask_Add(GAME_DEF_TICKS, Animations_Tick);
-	Event_Register_(&TextureEvents.PackChanged, NULL, OnPackChanged);
+	Event_Register_(&TextureEvents.PackChanged,  NULL, OnPackChanged);
+	Event_Register_(&TextureEvents.AtlasChanged, NULL, OnAtlasReset);
+	Event_Register_(&GfxEvents.ContextRecreated, NULL, OnAtlasReset);
 }
 #else
 static void Animations_Clear(void) { }
@@ -23,9 +23,21 @@ const cc_string Sounds_ZipPathMC = String_FromConst("audio/default.zip");
 const cc_string Sounds_ZipPathCC = String_FromConst("audio/classicube.zip");
 static const cc_string audio_dir = String_FromConst("audio");
 
+#ifdef CC_BUILD_AUDIOMIXER
+#define SOUND_MAX_VARIANTS 2
+/* Copy of a sound's samples, already resampled for a particular playback rate */
+struct SoundVariant {
+	int rate;
+	struct AudioChunk chunk;
+};
+#endif
+
 struct Sound {
 	int channels, sampleRate;
 	struct AudioChunk chunk;
+#ifdef CC_BUILD_AUDIOMIXER
+	struct SoundVariant variants[SOUND_MAX_VARIANTS];
+#endif
 };
 
 
@@ -106,6 +118,92 @@ static cc_result Sound_ReadWaveData(struct Stream* stream, struct Sound* snd) {
 	}
 }
 
+/* Returns the rate that sounds of the given type are played at */
+static int Soundboard_Rate(struct Soundboard* board, cc_uint8 type) {
+	/* https://minecraft.wiki/w/Block_of_Gold#Sounds */
+	/* https://minecraft.wiki/w/Grass#Sounds */
+	if (board == &digBoard) {
+		return type == SOUND_METAL ? 120 : 80;
+	} else {
+		return type == SOUND_METAL ? 140 : 100;
+	}
+}
+
+#ifdef CC_BUILD_AUDIOMIXER
+/* Resamples a sound to the mixer's sample rate, with the given playback rate already applied */
+/*  (so playing the sound later only needs to mix it in, instead of resampling it every time) */
+static cc_result Sound_Resample(const struct Sound* snd, int rate, struct AudioChunk* dst) {
+	const cc_int16* src = (const cc_int16*)snd->chunk.data;
+	cc_uint32 srcFrames = snd->chunk.size / (snd->channels * 2);
+	cc_uint32 i, dstFrames, index, next, frac;
+	cc_uint64 pos, step;
+	int c, a, b, channels = snd->channels;
+	cc_int16* out;
+	cc_result res;
+
+	/* Source frames advanced per output frame, as 32.32 fixed point */
+	step = ((cc_uint64)snd->sampleRate * rate << 32) / ((cc_uint64)AUDIO_MIXER_SAMPLE_RATE * 100);
+	if (!srcFrames || !step) return ERR_INVALID_ARGUMENT;
+	dstFrames = (cc_uint32)(((cc_uint64)srcFrames << 32) / step);
+	if (!dstFrames) return ERR_INVALID_ARGUMENT;
+
+	if ((res = Audio_AllocChunks(dstFrames * channels * 2, dst, 1))) return res;
+	out = (cc_int16*)dst->data;
+
+	for (i = 0, pos = 0; i < dstFrames; i++, pos += step) 
+	{
+		index = (cc_uint32)(pos >> 32);
+		next  = index + 1 < srcFrames ? index + 1 : index;
+		frac  = (cc_uint32)(pos >> 17) & 0x7FFF;
+
+		/* Linearly interpolate between this frame and the next */
+		for (c = 0; c < channels; c++) 
+		{
+			a = src[index * channels + c];
+			b = src[next  * channels + c];
+			*out++ = (cc_int16)(a + (((b - a) * (int)frac) >> 15));
+		}
+	}
+	return 0;
+}
+
+/* Creates a resampled copy of the sound for each rate it can be played at */
+static void Sound_MakeVariants(struct Sound* snd, const int* rates, int count) {
+	struct SoundVariant* variant;
+	cc_result res;
+	int i;
+	if (snd->channels != 1 && snd->channels != 2) return;
+
+	for (i = 0; i < count && i < SOUND_MAX_VARIANTS; i++) 
+	{
+		/* Mixer can already play these without resampling */
+		if ((cc_uint64)snd->sampleRate * rates[i] == (cc_uint64)AUDIO_MIXER_SAMPLE_RATE * 100) continue;
+		variant = &snd->variants[i];
+
+		res = Sound_Resample(snd, rates[i], &variant->chunk);
+		if (res) { Audio_Warn(res, "resampling sound"); return; }
+		variant->rate = rates[i];
+	}
+}
+
+/* Switches to playing a pre-resampled copy of the sound, if there is one for the given rate */
+static void Sound_SelectVariant(const struct Sound* snd, struct AudioData* data) {
+	const struct SoundVariant* variant;
+	int i;
+
+	for (i = 0; i < SOUND_MAX_VARIANTS; i++) 
+	{
+		variant = &snd->variants[i];
+		if (!variant->chunk.data || variant->rate != data->rate) continue;
+
+		data->chunk      = variant->chunk;
+		data->sampleRate = AUDIO_MIXER_SAMPLE_RATE;
+		data->rate       = 100;
+		return;
+	}
+}
+#endif
+
 static struct SoundGroup* Soundboard_FindGroup(struct Soundboard* board, const cc_string* name) {
 	struct SoundGroup* groups = board->groups;
 	int i;
@@ -123,6 +221,9 @@ static void Soundboard_Load(struct Soundboard* board, const cc_string* boardName
 	cc_string name = *file;
 	cc_result res;
 	int dotIndex;
+#ifdef CC_BUILD_AUDIOMIXER
+	int rates[2];
+#endif
 	Utils_UNSAFE_TrimFirstDirectory(&name);
 
 	/* dig_grass1.wav -> dig_grass1 */
@@ -150,7 +251,16 @@ static void Soundboard_Load(struct Soundboard* board, const cc_string* boardName
 		Audio_FreeChunks(&snd->chunk, 1);
 		snd->chunk.data = NULL;
 		snd->chunk.size = 0;
-	} else { group->count++; }
+		return;
+	}
+	group->count++;
+
+#ifdef CC_BUILD_AUDIOMIXER
+	rates[0] = Soundboard_Rate(board, (cc_uint8)(group - board->groups));
+	rates[1] = Soundboard_Rate(board, SOUND_METAL);
+	/* Metal sounds are played using the stone sounds */
+	Sound_MakeVariants(snd, rates, group == &board->groups[SOUND_STONE] ? 2 : 1);
+#endif
 }
 
 static const struct Sound* Soundboard_PickRandom(struct Soundboard* board, cc_uint8 type) {
@@ -186,19 +296,14 @@ static void Sounds_Play(cc_uint8 type, struct Soundboard* board) {
 	data.chunk      = snd->chunk;
 	data.channels   = snd->channels;
 	data.sampleRate = snd->sampleRate;
-	data.rate       = 100;
+	data.rate       = Soundboard_Rate(board, type);
 	data.volume     = Audio_SoundsVolume;
+	if (board == &stepBoard) data.volume /= 2;
+
+#ifdef CC_BUILD_AUDIOMIXER
+	Sound_SelectVariant(snd, &data);
+#endif
 
-	/* https://minecraft.wiki/w/Block_of_Gold#Sounds */
-	/* https://minecraft.wiki/w/Grass#Sounds */
-	if (board == &digBoard) {
-		if (type == SOUND_METAL) data.rate = 120;
-		else data.rate = 80;
-	} else {
-		data.volume /= 2;
-		if (type == SOUND_METAL) data.rate = 140;
-	}
-	
 	res = AudioPool_Play(&data);
 	if (res) Sounds_Fail(res);
 }
@@ -90,5 +90,11 @@ void Audio_Warn(cc_result res, const char* action);
 cc_result AudioPool_Play(struct AudioData* data);
 void AudioPool_Close(void);
 
+#ifdef CC_BUILD_AUDIOMIXER
+/* Sample rate all sounds are mixed together at */
+/* Sounds already at this rate (and played at 100 rate) are mixed without resampling */
+#define AUDIO_MIXER_SAMPLE_RATE 44100
+#endif
+
 CC_END_HEADER
 #endif
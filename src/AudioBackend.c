@@ -5,13 +5,16 @@
 #include "Errors.h"
 #include "Utils.h"
 #include "Platform.h"
+#include "Profiler.h"
 
 void Audio_Warn(cc_result res, const char* action) {
 	Logger_Warn(res, action, Audio_DescribeError);
 }
 
+#ifndef CC_BUILD_AUDIOMIXER
 /* Whether the given audio data can be played without recreating the underlying audio device */
 static cc_bool Audio_FastPlay(struct AudioContext* ctx, struct AudioData* data);
+#endif
 
 /* Common/Base methods */
 static void AudioBase_Clear(struct AudioContext* ctx);
@@ -242,14 +245,23 @@ cc_result Audio_QueueChunk(struct AudioContext* ctx, struct AudioChunk* chunk) {
 }
 
 cc_result Audio_Play(struct AudioContext* ctx) {
+	ALint state = 0;
+	_alGetError(); /* Reset error state */
+
+	/* Source stops once it runs out of queued buffers, so may need restarting */
+	/* (but calling alSourcePlay on an already playing source rewinds it) */
+	_alGetSourcei(ctx->source, AL_SOURCE_STATE, &state);
+	if (state == AL_PLAYING) return _alGetError();
+
 	_alSourcePlay(ctx->source);
 	return _alGetError();
 }
 
 cc_result Audio_Poll(struct AudioContext* ctx, int* inUse) {
+	ALuint buffers[AUDIO_MAX_BUFFERS];
 	ALint processed = 0;
-	ALuint buffer;
 	ALenum err;
+	int i;
 
 	*inUse = 0;
 	if (!ctx->source) return 0;
@@ -257,20 +269,26 @@ cc_result Audio_Poll(struct AudioContext* ctx, int* inUse) {
 	_alGetError(); /* Reset error state */
 	_alGetSourcei(ctx->source, AL_BUFFERS_PROCESSED, &processed);
 	if ((err = _alGetError())) return err;
+	processed = min(processed, ctx->count - ctx->free);
 
 	if (processed > 0) {
-		_alSourceUnqueueBuffers(ctx->source, 1, &buffer);
+		_alSourceUnqueueBuffers(ctx->source, processed, buffers);
 		if ((err = _alGetError())) return err;
 
-		ctx->freeIDs[ctx->free++] = buffer;
+		for (i = 0; i < processed; i++) 
+		{
+			ctx->freeIDs[ctx->free++] = buffers[i];
+		}
 	}
 	*inUse = ctx->count - ctx->free; return 0;
 }
 
+#ifndef CC_BUILD_AUDIOMIXER
 static cc_bool Audio_FastPlay(struct AudioContext* ctx, struct AudioData* data) {
 	/* Channels/Sample rate is per buffer, not a per source property */
 	return true;
 }
+#endif
 
 static const char* GetError(cc_result res) {
 	switch (res) {
@@ -443,11 +461,13 @@ cc_result Audio_Poll(struct AudioContext* ctx, int* inUse) {
 }
 
 
+#ifndef CC_BUILD_AUDIOMIXER
 static cc_bool Audio_FastPlay(struct AudioContext* ctx, struct AudioData* data) {
 	int channels   = data->channels;
 	int sampleRate = Audio_AdjustSampleRate(data->sampleRate, data->rate);
 	return !ctx->channels || (ctx->channels == channels && ctx->sampleRate == sampleRate);
 }
+#endif
 
 cc_bool Audio_DescribeError(cc_result res, cc_string* dst) {
 	char buffer[NATIVE_STR_LEN] = { 0 };
@@ -1684,6 +1704,195 @@ cc_result Audio_AllocChunks(cc_uint32 size, struct AudioChunk* chunks, int numCh
 	return AudioBase_AllocChunks(size, chunks, numChunks);
 }
 
+void Audio_FreeChunks(struct AudioChunk* chunks, int numChunks) {
+	AudioBase_FreeChunks(chunks, numChunks);
+}
+#elif CC_AUD_BACKEND == CC_AUD_BACKEND_WAVFILE
+/*########################################################################################################################*
+*----------------------------------------------------WAV file backend-----------------------------------------------------*
+*#########################################################################################################################*/
+/* Writes all audio to .wav files in audio-out folder, instead of playing it on an audio device */
+/* Buffers are only released once they would have finished playing, so timing still */
+/*  behaves like a real audio device (useful for testing audio code on headless systems) */
+#include "Stream.h"
+#define WAV_HEADER_SIZE 44
+#define WAV_FourCC(a, b, c, d) (((cc_uint32)a << 24) | ((cc_uint32)b << 16) | ((cc_uint32)c << 8) | (cc_uint32)d)
+
+struct AudioContext {
+	struct Stream file;
+	cc_bool fileOpen;
+	cc_uint32 dataSize;
+	cc_uint64 bufferEnds[AUDIO_MAX_BUFFERS]; /* Time each queued buffer finishes playing at, 0 if free */
+	int count, channels, sampleRate, volume;
+	cc_uint32 _tmpSize[AUDIO_MAX_BUFFERS];
+	void* _tmpData[AUDIO_MAX_BUFFERS];
+};
+#define AUDIO_COMMON_VOLUME
+#define AUDIO_COMMON_ALLOC
+
+static cc_uint64 wav_startTime;
+static int wav_filesCount;
+
+cc_bool AudioBackend_Init(void) {
+	if (!wav_startTime) wav_startTime = Stopwatch_Measure();
+	return Utils_EnsureDirectory("audio-out");
+}
+
+void AudioBackend_Tick(void) { }
+void AudioBackend_Free(void) { }
+
+/* Returns current time in microseconds (never 0, as that means a buffer is free) */
+static cc_uint64 WavFile_Now(void) {
+	return Stopwatch_ElapsedMicroseconds(wav_startTime, Stopwatch_Measure()) + 1;
+}
+
+static void WavFile_MakeHeader(struct AudioContext* ctx, cc_uint8* header) {
+	int sampleSize = ctx->channels * 2;
+
+	Stream_SetU32_BE(header +  0, WAV_FourCC('R','I','F','F'));
+	Stream_SetU32_LE(header +  4, ctx->dataSize + WAV_HEADER_SIZE - 8);
+	Stream_SetU32_BE(header +  8, WAV_FourCC('W','A','V','E'));
+	Stream_SetU32_BE(header + 12, WAV_FourCC('f','m','t',' '));
+	Stream_SetU32_LE(header + 16, 16);
+	Stream_SetU16_LE(header + 20, 1); /* PCM */
+	Stream_SetU16_LE(header + 22, ctx->channels);
+	Stream_SetU32_LE(header + 24, ctx->sampleRate);
+	Stream_SetU32_LE(header + 28, ctx->sampleRate * sampleSize);
+	Stream_SetU16_LE(header + 32, sampleSize);
+	Stream_SetU16_LE(header + 34, 16);
+	Stream_SetU32_BE(header + 36, WAV_FourCC('d','a','t','a'));
+	Stream_SetU32_LE(header + 40, ctx->dataSize);
+}
+
+static cc_result WavFile_Open(struct AudioContext* ctx) {
+	cc_uint8 header[WAV_HEADER_SIZE];
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_result res;
+
+	String_InitArray(path, pathBuffer);
+	String_Format1(&path, "audio-out/stream%i.wav", &wav_filesCount);
+	wav_filesCount++;
+
+	if ((res = Stream_CreateFile(&ctx->file, &path))) return res;
+	ctx->fileOpen = true;
+	ctx->dataSize = 0;
+
+	/* Header is rewritten with the actual data size when file is closed */
+	WavFile_MakeHeader(ctx, header);
+	return Stream_Write(&ctx->file, header, WAV_HEADER_SIZE);
+}
+
+static void WavFile_Close(struct AudioContext* ctx) {
+	cc_uint8 header[WAV_HEADER_SIZE];
+	cc_result res;
+	if (!ctx->fileOpen) return;
+	ctx->fileOpen = false;
+
+	WavFile_MakeHeader(ctx, header);
+	res = ctx->file.Seek(&ctx->file, 0);
+	if (!res) res = Stream_Write(&ctx->file, header, WAV_HEADER_SIZE);
+	if (res) Audio_Warn(res, "writing .wav header");
+
+	res = ctx->file.Close(&ctx->file);
+	if (res) Audio_Warn(res, "closing .wav file");
+}
+
+cc_result Audio_Init(struct AudioContext* ctx, int buffers) {
+	int i;
+	for (i = 0; i < AUDIO_MAX_BUFFERS; i++) {
+		ctx->bufferEnds[i] = 0;
+		ctx->_tmpData[i]   = NULL;
+		ctx->_tmpSize[i]   = 0;
+	}
+
+	ctx->fileOpen = false;
+	ctx->count    = buffers;
+	ctx->volume   = 100;
+	return 0;
+}
+
+void Audio_Close(struct AudioContext* ctx) {
+	int i;
+	WavFile_Close(ctx);
+
+	for (i = 0; i < AUDIO_MAX_BUFFERS; i++) {
+		ctx->bufferEnds[i] = 0;
+	}
+	AudioBase_Clear(ctx);
+}
+
+cc_result Audio_SetFormat(struct AudioContext* ctx, int channels, int sampleRate, int playbackRate) {
+	sampleRate = Audio_AdjustSampleRate(sampleRate, playbackRate);
+	if (ctx->channels == channels && ctx->sampleRate == sampleRate) return 0;
+
+	/* .wav files can only have one format, so start a new file */
+	WavFile_Close(ctx);
+	ctx->channels   = channels;
+	ctx->sampleRate = sampleRate;
+	return 0;
+}
+
+void Audio_SetVolume(struct AudioContext* ctx, int volume) { ctx->volume = volume; }
+
+cc_result Audio_QueueChunk(struct AudioContext* ctx, struct AudioChunk* chunk) {
+	struct AudioChunk tmp = *chunk;
+	cc_uint64 beg, frames;
+	cc_result res;
+	int i, j;
+
+	if (!ctx->channels || !ctx->sampleRate) return ERR_INVALID_ARGUMENT;
+	if (!ctx->fileOpen && (res = WavFile_Open(ctx))) return res;
+
+	for (i = 0; i < ctx->count; i++) {
+		if (ctx->bufferEnds[i]) continue;
+		if (!AudioBase_AdjustSound(ctx, i, &tmp)) return ERR_OUT_OF_MEMORY;
+
+		if ((res = Stream_Write(&ctx->file, (cc_uint8*)tmp.data, tmp.size))) return res;
+		ctx->dataSize += tmp.size;
+
+		/* Buffer starts playing once all the other queued buffers have finished */
+		beg = WavFile_Now();
+		for (j = 0; j < ctx->count; j++) {
+			beg = max(beg, ctx->bufferEnds[j]);
+		}
+
+		frames = tmp.size / (ctx->channels * 2);
+		ctx->bufferEnds[i] = beg + (frames * 1000 * 1000) / ctx->sampleRate;
+		return 0;
+	}
+	/* tried to queue data without polling for free buffers first */
+	return ERR_INVALID_ARGUMENT;
+}
+
+cc_result Audio_Play(struct AudioContext* ctx) { return 0; }
+
+cc_result Audio_Poll(struct AudioContext* ctx, int* inUse) {
+	cc_uint64 now = WavFile_Now();
+	int i, count = 0;
+
+	for (i = 0; i < ctx->count; i++) {
+		if (ctx->bufferEnds[i] <= now) {
+			ctx->bufferEnds[i] = 0;
+		} else { count++; }
+	}
+
+	*inUse = count; return 0;
+}
+
+#ifndef CC_BUILD_AUDIOMIXER
+static cc_bool Audio_FastPlay(struct AudioContext* ctx, struct AudioData* data) {
+	int channels   = data->channels;
+	int sampleRate = Audio_AdjustSampleRate(data->sampleRate, data->rate);
+	return !ctx->channels || (ctx->channels == channels && ctx->sampleRate == sampleRate);
+}
+#endif
+
+cc_bool Audio_DescribeError(cc_result res, cc_string* dst) { return false; }
+
+cc_result Audio_AllocChunks(cc_uint32 size, struct AudioChunk* chunks, int numChunks) {
+	return AudioBase_AllocChunks(size, chunks, numChunks);
+}
+
 void Audio_FreeChunks(struct AudioChunk* chunks, int numChunks) {
 	AudioBase_FreeChunks(chunks, numChunks);
 }
@@ -1824,10 +2033,299 @@ static void AudioBase_FreeChunks(struct AudioChunk* chunks, int numChunks) {
 *---------------------------------------------------Audio context code----------------------------------------------------*
 *#########################################################################################################################*/
 struct AudioContext music_ctx;
+
+#ifndef CC_BUILD_NOSOUNDS
+#ifdef CC_BUILD_AUDIOMIXER
+/*########################################################################################################################*
+*-------------------------------------------------------Audio mixer-------------------------------------------------------*
+*#########################################################################################################################*/
+/* Mixes all sounds into a single stereo stream, which is played on one audio context by a background thread */
+/*  (so no audio context ever needs to be recreated, and sounds are never dropped due to all contexts being busy) */
+#define MIXER_SAMPLE_RATE  AUDIO_MIXER_SAMPLE_RATE
+#define MIXER_CHUNK_FRAMES 1024 /* ~23 milliseconds of audio per buffer */
+#define MIXER_CHUNK_SIZE   (MIXER_CHUNK_FRAMES * 2 * sizeof(cc_int16))
+#define MIXER_FRAC_BITS    16
+#define MIXER_MAX_MIXED    256 /* Max number of sounds mixed into one buffer */
+
+struct MixerVoice {
+	const cc_int16* data;
+	cc_uint32 frames;      /* Number of frames in data */
+	cc_uint32 index, frac; /* Current position in data, in frames plus fraction of a frame */
+	cc_uint32 step;        /* Frames advanced per output frame, as 16.16 fixed point */
+	int channels, gain;    /* Volume as 8.8 fixed point */
+};
+
+static struct AudioContext mixer_ctx;
+static struct AudioChunk mixer_chunks[AUDIO_MAX_BUFFERS];
+static struct MixerVoice* mixer_voices;
+static int mixer_voicesCount, mixer_voicesCapacity;
+/* Copy of voices being mixed (only accessed by mixer thread) */
+static struct MixerVoice* mixer_active;
+static int mixer_activeCapacity;
+
+static void* mixer_mutex;
+static void* mixer_waitable;
+static void* mixer_thread;
+static cc_bool mixer_stopping;
+static cc_result mixer_error;
+
+/* Adds samples from the given voice to the output, returning false once the voice has finished */
+static cc_bool Mixer_MixVoice(struct MixerVoice* v, cc_int32* dst, int frames) {
+	const cc_int16* data = v->data;
+	cc_uint32 index = v->index, frac = v->frac, next;
+	int i, t, left, right, nextL, nextR;
+
+	/* Fast path for sounds already at output sample rate (e.g. pre-resampled sounds) */
+	if (v->step == (1 << MIXER_FRAC_BITS) && !frac) {
+		frames = min(frames, (int)(v->frames - index));
+		data  += index * v->channels;
+
+		if (v->channels == 1) {
+			for (i = 0; i < frames; i++, dst += 2) 
+			{
+				left   = (data[i] * v->gain) >> 8;
+				dst[0] += left; dst[1] += left;
+			}
+		} else {
+			for (i = 0; i < frames * 2; i++) 
+			{
+				dst[i] += (data[i] * v->gain) >> 8;
+			}
+		}
+
+		v->index = index + frames;
+		return v->index < v->frames;
+	}
+
+	for (i = 0; i < frames; i++, dst += 2) 
+	{
+		if (index >= v->frames) return false;
+		next = index + 1 < v->frames ? index + 1 : index;
+
+		if (v->channels == 1) {
+			left  = data[index]; nextL = data[next];
+			right = left;        nextR = nextL;
+		} else {
+			left  = data[index * 2]; nextL = data[next * 2];
+			right = data[index * 2 + 1]; nextR = data[next * 2 + 1];
+		}
+
+		/* Linearly interpolate between this frame and the next */
+		t = frac >> 2;
+		left  += ((nextL - left)  * t) >> (MIXER_FRAC_BITS - 2);
+		right += ((nextR - right) * t) >> (MIXER_FRAC_BITS - 2);
+
+		dst[0] += (left  * v->gain) >> 8;
+		dst[1] += (right * v->gain) >> 8;
+
+		frac  += v->step;
+		index += frac >> MIXER_FRAC_BITS;
+		frac  &= (1 << MIXER_FRAC_BITS) - 1;
+	}
+
+	v->index = index; v->frac = frac;
+	return index < v->frames;
+}
+
+/* Mixes a copy of the voices, so the main thread isn't blocked from adding voices while mixing */
+static cc_result Mixer_Render(cc_int16* dst) {
+	cc_int32 mixed[MIXER_CHUNK_FRAMES * 2] = { 0 };
+	cc_bool playing[MIXER_MAX_MIXED];
+	struct MixerVoice* voices;
+	int i, j, count, capacity;
+	cc_result res = 0;
+
+	Mutex_Lock(mixer_mutex);
+	{
+		count = min(mixer_voicesCount, MIXER_MAX_MIXED);
+
+		if (count > mixer_activeCapacity) {
+			capacity = max(16, count);
+			voices   = (struct MixerVoice*)Mem_TryRealloc(mixer_active, capacity, sizeof(struct MixerVoice));
+
+			if (voices) {
+				mixer_active         = voices;
+				mixer_activeCapacity = capacity;
+			} else { res = ERR_OUT_OF_MEMORY; }
+		}
+		if (!res) Mem_Copy(mixer_active, mixer_voices, count * sizeof(struct MixerVoice));
+	}
+	Mutex_Unlock(mixer_mutex);
+	if (res) return res;
+
+	for (i = 0; i < count; i++) 
+	{
+		playing[i] = Mixer_MixVoice(&mixer_active[i], mixed, MIXER_CHUNK_FRAMES);
+	}
+
+	Mutex_Lock(mixer_mutex);
+	{
+		/* Voices may have been added while mixing, which were appended after the mixed ones */
+		for (i = 0, j = 0; i < mixer_voicesCount; i++) 
+		{
+			if (i >= count) {
+				mixer_voices[j++] = mixer_voices[i];
+			} else if (playing[i]) {
+				mixer_voices[j++] = mixer_active[i];
+			}
+		}
+		mixer_voicesCount = j;
+	}
+	Mutex_Unlock(mixer_mutex);
+
+	for (i = 0; i < MIXER_CHUNK_FRAMES * 2; i++) 
+	{
+		dst[i] = (cc_int16)max(-32768, min(mixed[i], 32767));
+	}
+	return 0;
+}
+
+static void MixerLoop(void) {
+	cc_result res = 0;
+	int next = 0, inUse, voices;
+	cc_bool stopping;
+	Profiler_NameThread("Audio mixer");
+
+	for (;;) {
+		Mutex_Lock(mixer_mutex);
+		{
+			stopping = mixer_stopping;
+			voices   = mixer_voicesCount;
+		}
+		Mutex_Unlock(mixer_mutex);
+		if (stopping) break;
+
+		if ((res = Audio_Poll(&mixer_ctx, &inUse))) break;
+
+		/* Nothing to play, so sleep until a sound is played */
+		if (!voices && !inUse) { Waitable_Wait(mixer_waitable); continue; }
+
+		/* Keep all buffers filled while there are sounds to play */
+		if (voices && inUse < AUDIO_MAX_BUFFERS) {
+			for (; inUse < AUDIO_MAX_BUFFERS; inUse++) 
+			{
+				Profiler_BeginZone("Mixer_Render");
+				res = Mixer_Render((cc_int16*)mixer_chunks[next].data);
+				Profiler_EndZone();
+
+				if (res) break;
+				if ((res = Audio_QueueChunk(&mixer_ctx, &mixer_chunks[next]))) break;
+				next = (next + 1) % AUDIO_MAX_BUFFERS;
+			}
+			if (res) break;
+		}
+
+		/* Underlying audio stops whenever the queue runs dry (e.g. mixer thread was */
+		/*  not scheduled in time), so restart it if it has stopped with buffers queued */
+		if (inUse && (res = Audio_Play(&mixer_ctx))) break;
+		Waitable_WaitFor(mixer_waitable, 4);
+	}
+
+	/* Report error back to main thread on next sound played */
+	Mutex_Lock(mixer_mutex);
+	{
+		if (res) mixer_error = res;
+		mixer_voicesCount = 0;
+	}
+	Mutex_Unlock(mixer_mutex);
+	Profiler_EndThread();
+}
+
+static cc_result Mixer_Init(void) {
+	cc_result res;
+	if ((res = Audio_Init(&mixer_ctx, AUDIO_MAX_BUFFERS)))                  return res;
+	if ((res = Audio_SetFormat(&mixer_ctx, 2, MIXER_SAMPLE_RATE, 100)))     return res;
+	if ((res = Audio_AllocChunks(MIXER_CHUNK_SIZE, mixer_chunks, AUDIO_MAX_BUFFERS))) return res;
+	Audio_SetVolume(&mixer_ctx, 100);
+
+	mixer_mutex    = Mutex_Create("Audio mixer voices");
+	mixer_waitable = Waitable_Create("Audio mixer wakeup");
+	mixer_stopping = false;
+	mixer_error    = 0;
+	Thread_Run(&mixer_thread, MixerLoop, 64 * 1024, "Audio mixer");
+	return 0;
+}
+
+static cc_result Mixer_AddVoice(struct AudioData* data) {
+	struct MixerVoice* voices;
+	struct MixerVoice* v;
+	cc_uint64 sampleRate;
+	cc_result res;
+	int capacity;
+
+	if (data->channels != 1 && data->channels != 2) return ERR_INVALID_ARGUMENT;
+	sampleRate = Audio_AdjustSampleRate(data->sampleRate, data->rate);
+
+	Mutex_Lock(mixer_mutex);
+	res = mixer_error;
+
+	if (!res && mixer_voicesCount == mixer_voicesCapacity) {
+		capacity = max(16, mixer_voicesCapacity * 2);
+		voices   = (struct MixerVoice*)Mem_TryRealloc(mixer_voices, capacity, sizeof(struct MixerVoice));
+
+		if (voices) {
+			mixer_voices         = voices;
+			mixer_voicesCapacity = capacity;
+		} else { res = ERR_OUT_OF_MEMORY; }
+	}
+
+	if (!res) {
+		v = &mixer_voices[mixer_voicesCount++];
+		v->data     = (const cc_int16*)data->chunk.data;
+		v->frames   = data->chunk.size / (data->channels * sizeof(cc_int16));
+		v->index    = 0;
+		v->frac     = 0;
+		v->step     = (cc_uint32)((sampleRate << MIXER_FRAC_BITS) / MIXER_SAMPLE_RATE);
+		v->channels = data->channels;
+		v->gain     = data->volume * 256 / 100;
+	}
+	Mutex_Unlock(mixer_mutex);
+
+	if (!res) Waitable_Signal(mixer_waitable);
+	return res;
+}
+
+cc_result AudioPool_Play(struct AudioData* data) {
+	cc_result res;
+	if (mixer_thread) return Mixer_AddVoice(data);
+
+	if ((res = Mixer_Init())) { AudioPool_Close(); return res; }
+	return Mixer_AddVoice(data);
+}
+
+void AudioPool_Close(void) {
+	if (mixer_thread) {
+		Mutex_Lock(mixer_mutex);
+		mixer_stopping = true;
+		Mutex_Unlock(mixer_mutex);
+
+		Waitable_Signal(mixer_waitable);
+		Thread_Join(mixer_thread);
+		mixer_thread = NULL;
+
+		Mutex_Free(mixer_mutex);
+		Waitable_Free(mixer_waitable);
+	}
+
+	if (mixer_ctx.count) Audio_Close(&mixer_ctx);
+	if (mixer_chunks[0].data) {
+		Audio_FreeChunks(mixer_chunks, AUDIO_MAX_BUFFERS);
+		mixer_chunks[0].data = NULL;
+	}
+
+	Mem_Free(mixer_voices);
+	mixer_voices         = NULL;
+	mixer_voicesCount    = 0;
+	mixer_voicesCapacity = 0;
+
+	Mem_Free(mixer_active);
+	mixer_active         = NULL;
+	mixer_activeCapacity = 0;
+}
+#else
 #define POOL_MAX_CONTEXTS 8
 static struct AudioContext context_pool[POOL_MAX_CONTEXTS];
 
-#ifndef CC_BUILD_NOSOUNDS
 static cc_result PlayAudio(struct AudioContext* ctx, struct AudioData* data) {
     cc_result res;
     Audio_SetVolume(ctx, data->volume);
@@ -1875,3 +2373,4 @@ void AudioPool_Close(void) {
 	}
 }
 #endif
+#endif
@@ -1,4 +1,7 @@
 #include "Bitmap.h"
+#ifdef CC_BUILD_SSE2
+#include <emmintrin.h>
+#endif
 #include "Platform.h"
 #include "ExtMath.h"
 #include "Deflate.h"
@@ -89,15 +92,146 @@ cc_bool Png_Detect(const cc_uint8* data, cc_uint32 len) {
 
 /* 9 Filtering */
 /* 13.9 Filtering */
+#ifdef CC_BUILD_SSE2
+/* Only 3 and 4 byte pixels (i.e. 8 bit RGB and RGBA) have vectorised unfilters */
+#define PNG_SSE_PIXEL(bpp) ((bpp) == 3 || (bpp) == 4)
+
+static CC_INLINE __m128i Png_SSE_LoadPixel(const cc_uint8* src, int bpp) {
+	cc_uint32 v = src[0] | (src[1] << 8) | ((cc_uint32)src[2] << 16);
+	if (bpp == 4) v |= (cc_uint32)src[3] << 24;
+	return _mm_cvtsi32_si128((int)v);
+}
+
+static CC_INLINE void Png_SSE_StorePixel(cc_uint8* dst, __m128i value, int bpp) {
+	cc_uint32 v = (cc_uint32)_mm_cvtsi128_si32(value);
+	dst[0] = (cc_uint8)v; dst[1] = (cc_uint8)(v >> 8); dst[2] = (cc_uint8)(v >> 16);
+	if (bpp == 4) dst[3] = (cc_uint8)(v >> 24);
+}
+
+static CC_INLINE __m128i Png_SSE_Select(__m128i cond, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(cond, a), _mm_andnot_si128(cond, b));
+}
+
+static CC_INLINE __m128i Png_SSE_AbsI16(__m128i v) {
+	return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+}
+
+/* Returns the number of bytes at the start of the line that were reconstructed */
+static cc_uint32 Png_SSE_Sub(cc_uint8 bpp, cc_uint8* line, cc_uint32 lineLen) {
+	__m128i prev = _mm_setzero_si128();
+	__m128i rgbMask, lowMask, x, src;
+	cc_uint32 i = 0;
+
+	if (bpp == 4) {
+		/* Prefix sum of the 4 pixels in each block, plus last pixel of previous block */
+		for (; i + 16 <= lineLen; i += 16) {
+			x = _mm_loadu_si128((const __m128i*)(line + i));
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+			x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+			x = _mm_add_epi8(x, prev);
+
+			_mm_storeu_si128((__m128i*)(line + i), x);
+			prev = _mm_shuffle_epi32(x, 0xFF);
+		}
+	} else if (bpp == 3) {
+		/* Same as above, but only the lower 12 bytes of each 16 byte load are reconstructed */
+		rgbMask = _mm_setr_epi32(0x00FFFFFF, 0, 0, 0);
+		lowMask = _mm_setr_epi32(-1, -1, -1, 0);
+
+		for (; i + 16 <= lineLen; i += 12) {
+			src = _mm_loadu_si128((const __m128i*)(line + i));
+			x   = _mm_add_epi8(src, _mm_slli_si128(src, 3));
+			x   = _mm_add_epi8(x,   _mm_slli_si128(x,   6));
+			x   = _mm_add_epi8(x,   prev);
+
+			_mm_storeu_si128((__m128i*)(line + i), Png_SSE_Select(lowMask, x, src));
+			prev = _mm_and_si128(_mm_srli_si128(x, 9), rgbMask);
+			prev = _mm_or_si128(prev, _mm_slli_si128(prev, 3));
+			prev = _mm_or_si128(prev, _mm_slli_si128(prev, 6));
+		}
+	}
+	return i;
+}
+
+static cc_uint32 Png_SSE_Up(cc_uint8* line, const cc_uint8* prior, cc_uint32 lineLen) {
+	__m128i a, b;
+	cc_uint32 i;
+
+	for (i = 0; i + 16 <= lineLen; i += 16) {
+		a = _mm_loadu_si128((const __m128i*)(line  + i));
+		b = _mm_loadu_si128((const __m128i*)(prior + i));
+		_mm_storeu_si128((__m128i*)(line + i), _mm_add_epi8(a, b));
+	}
+	return i;
+}
+
+static void Png_SSE_Average(cc_uint8 bpp, cc_uint8* line, const cc_uint8* prior, cc_uint32 lineLen) {
+	__m128i one = _mm_set1_epi8(1);
+	__m128i a   = _mm_setzero_si128();
+	__m128i b, avg;
+	cc_uint32 i;
+
+	for (i = 0; i < lineLen; i += bpp) {
+		b = Png_SSE_LoadPixel(prior + i, bpp);
+		/* _mm_avg_epu8 rounds up, whereas PNG average rounds down */
+		avg = _mm_avg_epu8(a, b);
+		avg = _mm_sub_epi8(avg, _mm_and_si128(_mm_xor_si128(a, b), one));
+
+		a = _mm_add_epi8(Png_SSE_LoadPixel(line + i, bpp), avg);
+		Png_SSE_StorePixel(line + i, a, bpp);
+	}
+}
+
+static void Png_SSE_Paeth(cc_uint8 bpp, cc_uint8* line, const cc_uint8* prior, cc_uint32 lineLen) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i mask = _mm_set1_epi16(0xFF);
+	__m128i a = zero, c = zero;
+	__m128i b, pa, pb, pc, smallest, nearest;
+	cc_uint32 i;
+
+	/* Components are widened to 16 bits, so that a + b - c can't overflow */
+	for (i = 0; i < lineLen; i += bpp) {
+		b  = _mm_unpacklo_epi8(Png_SSE_LoadPixel(prior + i, bpp), zero);
+
+		pa = _mm_sub_epi16(b, c);   /* p - a */
+		pb = _mm_sub_epi16(a, c);   /* p - b */
+		pc = _mm_add_epi16(pa, pb); /* p - c */
+		pa = Png_SSE_AbsI16(pa);
+		pb = Png_SSE_AbsI16(pb);
+		pc = Png_SSE_AbsI16(pc);
+
+		/* Ties are broken in the order a, b, c */
+		smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+		nearest  = Png_SSE_Select(_mm_cmpeq_epi16(smallest, pb), b, c);
+		nearest  = Png_SSE_Select(_mm_cmpeq_epi16(smallest, pa), a, nearest);
+
+		a = _mm_unpacklo_epi8(Png_SSE_LoadPixel(line + i, bpp), zero);
+		a = _mm_and_si128(_mm_add_epi16(a, nearest), mask);
+		Png_SSE_StorePixel(line + i, _mm_packus_epi16(a, a), bpp);
+		c = b;
+	}
+}
+#endif
+
+static void Png_ReconstructSub(cc_uint8 bytesPerPixel, cc_uint8* line, cc_uint32 lineLen) {
+	cc_uint32 i = bytesPerPixel, j;
+#ifdef CC_BUILD_SSE2
+	j = Png_SSE_Sub(bytesPerPixel, line, lineLen);
+	i = max(i, j);
+#endif
+
+	for (j = i - bytesPerPixel; i < lineLen; i++, j++) {
+		line[i] += line[j];
+	}
+}
+
 static void Png_ReconstructFirst(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8* line, cc_uint32 lineLen) {
 	/* First scanline is a special case, where all values in prior array are 0 */
 	cc_uint32 i, j;
 
 	switch (type) {
 	case PNG_FILTER_SUB:
-		for (i = bytesPerPixel, j = 0; i < lineLen; i++, j++) {
-			line[i] += line[j];
-		}
+		Png_ReconstructSub(bytesPerPixel, line, lineLen);
 		return;
 
 	case PNG_FILTER_AVERAGE:
@@ -107,9 +241,8 @@ static void Png_ReconstructFirst(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8
 		return;
 
 	case PNG_FILTER_PAETH:
-		for (i = bytesPerPixel, j = 0; i < lineLen; i++, j++) {
-			line[i] += line[j];
-		}
+		/* With a prior of 0, Paeth always predicts the left pixel */
+		Png_ReconstructSub(bytesPerPixel, line, lineLen);
 		return;
 	}
 }
@@ -119,18 +252,25 @@ static void Png_Reconstruct(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8* lin
 
 	switch (type) {
 	case PNG_FILTER_SUB:
-		for (i = bytesPerPixel, j = 0; i < lineLen; i++, j++) {
-			line[i] += line[j];
-		}
+		Png_ReconstructSub(bytesPerPixel, line, lineLen);
 		return;
 
 	case PNG_FILTER_UP:
-		for (i = 0; i < lineLen; i++) {
+		i = 0;
+#ifdef CC_BUILD_SSE2
+		i = Png_SSE_Up(line, prior, lineLen);
+#endif
+		for (; i < lineLen; i++) {
 			line[i] += prior[i];
 		}
 		return;
 
 	case PNG_FILTER_AVERAGE:
+#ifdef CC_BUILD_SSE2
+		if (PNG_SSE_PIXEL(bytesPerPixel)) {
+			Png_SSE_Average(bytesPerPixel, line, prior, lineLen); return;
+		}
+#endif
 		for (i = 0; i < bytesPerPixel; i++) {
 			line[i] += (prior[i] >> 1);
 		}
@@ -140,7 +280,11 @@ static void Png_Reconstruct(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8* lin
 		return;
 
 	case PNG_FILTER_PAETH:
-		/* TODO: verify this is right */
+#ifdef CC_BUILD_SSE2
+		if (PNG_SSE_PIXEL(bytesPerPixel)) {
+			Png_SSE_Paeth(bytesPerPixel, line, prior, lineLen); return;
+		}
+#endif
 		for (i = 0; i < bytesPerPixel; i++) {
 			line[i] += prior[i];
 		}
@@ -169,6 +313,23 @@ static void Png_Reconstruct(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8* lin
 #define PNG_Do_RGB_A__8()         Bitmap_Set(*dst, src[0], src[1], src[2], src[3]); dst++; src += 4;
 #define PNG_Do_Palette__8()       *dst-- = palette[*src--];
 
+#ifdef CC_BUILD_SSE2
+/* Converts 4 pixels stored as R,G,B,A bytes into BitmapCols */
+#if BITMAPCOLOR_R_SHIFT == 0 && BITMAPCOLOR_G_SHIFT == 8 && BITMAPCOLOR_B_SHIFT == 16 && BITMAPCOLOR_A_SHIFT == 24
+	#define PNG_SSE_EXPAND
+	#define Png_SSE_ToBitmapCol(v) (v)
+#elif BITMAPCOLOR_R_SHIFT == 16 && BITMAPCOLOR_G_SHIFT == 8 && BITMAPCOLOR_B_SHIFT == 0 && BITMAPCOLOR_A_SHIFT == 24
+	#define PNG_SSE_EXPAND
+	static CC_INLINE __m128i Png_SSE_ToBitmapCol(__m128i v) {
+		__m128i ga = _mm_and_si128(v, _mm_set1_epi32((int)0xFF00FF00U));
+		__m128i rb = _mm_and_si128(v, _mm_set1_epi32(0x00FF00FF));
+		/* Swap R and B by rotating within each 32 bit pixel */
+		rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+		return _mm_or_si128(ga, rb);
+	}
+#endif
+#endif
+
 #define PNG_Mask_1(i) (7  - (i & 7))
 #define PNG_Mask_2(i) ((3 - (i & 3)) * 2)
 #define PNG_Mask_4(i) ((1 - (i & 1)) * 4)
@@ -193,7 +354,23 @@ static void Png_Expand_GRAYSCALE_4(int width, BitmapCol* palette, cc_uint8* src,
 
 static void Png_Expand_GRAYSCALE_8(int width, BitmapCol* palette, cc_uint8* src, BitmapCol* dst) {
 	cc_uint8 rgb;
-	src += (width - 1) * 2;
+#ifdef PNG_SSE_EXPAND
+	__m128i alpha = _mm_set1_epi32((int)BITMAPCOLOR_A_MASK);
+	__m128i v, lo, hi;
+	/* Blocks of 16 pixels are still processed backwards from the end of the row */
+	for (; width >= 16; width -= 16) {
+		v  = _mm_loadu_si128((const __m128i*)&src[width - 16]);
+		lo = _mm_unpacklo_epi8(v, v);
+		hi = _mm_unpackhi_epi8(v, v);
+
+		_mm_storeu_si128((__m128i*)&dst[width - 16], _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+		_mm_storeu_si128((__m128i*)&dst[width - 12], _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+		_mm_storeu_si128((__m128i*)&dst[width -  8], _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+		_mm_storeu_si128((__m128i*)&dst[width -  4], _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+	}
+	if (!width) return;
+#endif
+	src += (width - 1);
 	dst += (width - 1);
 
 	for (; width >= 4; width -= 4) {
@@ -203,7 +380,29 @@ static void Png_Expand_GRAYSCALE_8(int width, BitmapCol* palette, cc_uint8* src,
 	for (; width > 0; width--) { PNG_Do_Grayscale_8(); }
 }
 
+#ifdef PNG_SSE_EXPAND
+static CC_INLINE __m128i Png_SSE_ExpandRGB(const cc_uint8* src) {
+	/* Two overlapping loads, so that no bytes past the 4 pixels are read */
+	__m128i lo  = _mm_loadl_epi64((const __m128i*)src);
+	__m128i hi  = _mm_loadl_epi64((const __m128i*)(src + 4));
+	__m128i p01 = _mm_unpacklo_epi32(lo, _mm_srli_si128(lo, 3));
+	__m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(hi, 2), _mm_srli_si128(hi, 5));
+	__m128i v   = _mm_unpacklo_epi64(p01, p23);
+
+	v = _mm_and_si128(v, _mm_set1_epi32(0x00FFFFFF));
+	v = _mm_or_si128(v,  _mm_set1_epi32((int)0xFF000000U));
+	return Png_SSE_ToBitmapCol(v);
+}
+#endif
+
 static void Png_Expand_RGB_8(int width, BitmapCol* palette, cc_uint8* src, BitmapCol* dst) {
+#ifdef PNG_SSE_EXPAND
+	/* Blocks of 4 pixels are still processed backwards from the end of the row */
+	for (; width >= 4; width -= 4) {
+		_mm_storeu_si128((__m128i*)&dst[width - 4], Png_SSE_ExpandRGB(&src[(width - 4) * 3]));
+	}
+	if (!width) return;
+#endif
 	src += (width - 1) * 3;
 	dst += (width - 1);
 
@@ -242,6 +441,20 @@ static void Png_Expand_INDEXED_8(int width, BitmapCol* palette, cc_uint8* src, B
 
 static void Png_Expand_GRAYSCALE_A_8(int width, BitmapCol* palette, cc_uint8* src, BitmapCol* dst) {
 	cc_uint8 rgb;
+#ifdef PNG_SSE_EXPAND
+	__m128i mask = _mm_set1_epi16(0xFF);
+	__m128i v, gg;
+	/* Each 16 bit G,A pair becomes the upper half of a pixel, with G,G as the lower half */
+	for (; width >= 8; width -= 8) {
+		v  = _mm_loadu_si128((const __m128i*)&src[(width - 8) * 2]);
+		gg = _mm_and_si128(v, mask);
+		gg = _mm_or_si128(gg, _mm_slli_epi16(gg, 8));
+
+		_mm_storeu_si128((__m128i*)&dst[width - 8], _mm_unpacklo_epi16(gg, v));
+		_mm_storeu_si128((__m128i*)&dst[width - 4], _mm_unpackhi_epi16(gg, v));
+	}
+	if (!width) return;
+#endif
 	src += (width - 1) * 2;
 	dst += (width - 1);
 
@@ -254,6 +467,12 @@ static void Png_Expand_GRAYSCALE_A_8(int width, BitmapCol* palette, cc_uint8* sr
 
 static void Png_Expand_RGB_A_8(int width, BitmapCol* palette, cc_uint8* src, BitmapCol* dst) {
 	/* Processed in forward order */
+#ifdef PNG_SSE_EXPAND
+	for (; width >= 4; width -= 4, src += 16, dst += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i*)src);
+		_mm_storeu_si128((__m128i*)dst, Png_SSE_ToBitmapCol(v));
+	}
+#endif
 
 	for (; width >= 4; width -= 4) {
 		PNG_Do_RGB_A__8(); PNG_Do_RGB_A__8();
@@ -329,7 +548,23 @@ static BitmapCol ExpandRGB(cc_uint8 bitsPerSample, int r, int g, int b) {
 	return BitmapCol_Make(r, g, b, 0);
 }
 
-cc_result Png_Decode(struct Bitmap* bmp, struct Stream* stream) {
+static struct Stream* decodedStream;
+static struct Bitmap decodedBmp;
+static cc_result decodedRes;
+
+void Png_SetDecoded(struct Stream* stream, const struct Bitmap* bmp, cc_result res) {
+	decodedStream = stream;
+	decodedBmp    = *bmp;
+	decodedRes    = res;
+}
+
+cc_bool Png_ClearDecoded(void) {
+	cc_bool unused = decodedStream != NULL;
+	decodedStream  = NULL;
+	return unused;
+}
+
+cc_result Png_DecodeData(struct Bitmap* bmp, struct Stream* stream) {
 	cc_uint8 tmp[64];
 	cc_uint32 dataSize, fourCC;
 	cc_result res;
@@ -547,6 +782,15 @@ cc_result Png_Decode(struct Bitmap* bmp, struct Stream* stream) {
 	}
 }
 
+cc_result Png_Decode(struct Bitmap* bmp, struct Stream* stream) {
+	if (stream == decodedStream) {
+		decodedStream = NULL;
+		*bmp = decodedBmp;
+		return decodedRes;
+	}
+	return Png_DecodeData(bmp, stream);
+}
+
 
 /*########################################################################################################################*
 *------------------------------------------------------PNG encoder--------------------------------------------------------*
@@ -618,13 +862,21 @@ static void Png_MakeRow(const BitmapCol* src, cc_uint8* dst, int lineLen, cc_boo
 	}
 }
 
-static void Png_EncodeRow(const cc_uint8* cur, const cc_uint8* prior, cc_uint8* best, int lineLen, cc_bool alpha) {
+/* Filter used for every row in PNG_ENCODE_FAST mode */
+#define PNG_FAST_FILTER PNG_FILTER_SUB
+
+static void Png_EncodeRow(const cc_uint8* cur, const cc_uint8* prior, cc_uint8* best, int lineLen, cc_bool alpha, int mode) {
 	cc_uint8* dst;
 	int bestFilter   = PNG_FILTER_SUB;
 	int bestEstimate = Int32_MaxValue;
 	int x, filter, estimate;
 
 	dst = best + 1;
+	if (mode == PNG_ENCODE_FAST) {
+		Png_Filter(PNG_FAST_FILTER, cur, prior, dst, lineLen, alpha ? 4 : 3);
+		best[0] = PNG_FAST_FILTER; return;
+	}
+
 	/* NOTE: Waste of time trying the PNG_NONE filter */
 	for (filter = PNG_FILTER_SUB; filter <= PNG_FILTER_PAETH; filter++) {
 		Png_Filter(filter, cur, prior, dst, lineLen, alpha ? 4 : 3);
@@ -653,7 +905,7 @@ static void Png_EncodeRow(const cc_uint8* cur, const cc_uint8* prior, cc_uint8*
 
 static BitmapCol* DefaultGetRow(struct Bitmap* bmp, int y, void* ctx) { return Bitmap_GetRow(bmp, y); }
 static cc_result Png_EncodeCore(struct Bitmap* bmp, struct Stream* stream, cc_uint8* buffer,
-					Png_RowGetter getRow, cc_bool alpha, void* ctx) {
+					Png_RowGetter getRow, cc_bool alpha, void* ctx, int mode) {
 	cc_uint8 tmp[32];
 	cc_uint8* prevLine = buffer;
 	cc_uint8*  curLine = buffer + (bmp->width * 4) * 1;
@@ -661,7 +913,7 @@ static cc_result Png_EncodeCore(struct Bitmap* bmp, struct Stream* stream, cc_ui
 
 	struct ZLibState zlState;
 	struct Stream chunk, zlStream;
-	cc_uint32 stream_end, stream_beg;
+	cc_uint64 stream_end, stream_beg;
 	int y, lineSize;
 	cc_result res;
 
@@ -693,6 +945,12 @@ static cc_result Png_EncodeCore(struct Bitmap* bmp, struct Stream* stream, cc_ui
 	if ((res = Stream_Write(&chunk, tmp, 4))) return res;
 
 	ZLib_MakeStream(&zlStream, &zlState, &chunk); 
+	if (mode == PNG_ENCODE_FAST) {
+		zlState.Base.SearchDepth  = 1;
+		zlState.Base.LazyMatching = false;
+	} else if (mode == PNG_ENCODE_SMALL) {
+		zlState.Base.SearchDepth  = 64;
+	}
 	lineSize = bmp->width * (alpha ? 4 : 3);
 	Mem_Set(prevLine, 0, lineSize);
 
@@ -702,7 +960,7 @@ static cc_result Png_EncodeCore(struct Bitmap* bmp, struct Stream* stream, cc_ui
 		cc_uint8* cur  = (y & 1) == 0 ? curLine  : prevLine;
 
 		Png_MakeRow(src, cur, lineSize, alpha);
-		Png_EncodeRow(cur, prev, bestLine, lineSize, alpha);
+		Png_EncodeRow(cur, prev, bestLine, lineSize, alpha, mode);
 
 		/* +1 for filter byte */
 		if ((res = Stream_Write(&zlStream, bestLine, lineSize + 1))) return res;
@@ -720,27 +978,61 @@ static cc_result Png_EncodeCore(struct Bitmap* bmp, struct Stream* stream, cc_ui
 	if ((res = stream->Position(stream, &stream_end))) return res;
 	if ((res = stream->Seek(stream, stream_beg + 33))) return res;
 
-	Stream_SetU32_BE(&tmp[0], (stream_end - stream_beg) - 57);
+	Stream_SetU32_BE(&tmp[0], (cc_uint32)(stream_end - stream_beg) - 57);
 	if ((res = Stream_Write(stream, tmp, 4))) return res;
 	return stream->Seek(stream, stream_end);
 }
 
-cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
-					Png_RowGetter getRow, cc_bool alpha, void* ctx) {
+static struct Bitmap* pngCapture;
+void Png_SetCapture(struct Bitmap* dst) { pngCapture = dst; }
+
+static cc_result Png_Capture(struct Bitmap* bmp, Png_RowGetter getRow, void* ctx) {
+	struct Bitmap* dst = pngCapture;
+	int y;
+
+	pngCapture = NULL;
+	if (!getRow) getRow = DefaultGetRow;
+	Bitmap_TryAllocate(dst, bmp->width, bmp->height);
+	if (!dst->scan0) return ERR_OUT_OF_MEMORY;
+
+	for (y = 0; y < bmp->height; y++) {
+		Mem_Copy(Bitmap_GetRow(dst, y), getRow(bmp, y, ctx), bmp->width * BITMAPCOLOR_SIZE);
+	}
+	return 0;
+}
+
+cc_result Png_Encode2(struct Bitmap* bmp, struct Stream* stream, 
+					Png_RowGetter getRow, cc_bool alpha, void* ctx, int mode) {
 	cc_result res;
+	cc_uint8* buffer;
+
 	/* Add 1 for scanline filter type byter */
-	cc_uint8* buffer = (cc_uint8*)Mem_TryAlloc(3, bmp->width * 4 + 1);
+	buffer = (cc_uint8*)Mem_TryAlloc(3, bmp->width * 4 + 1);
 	if (!buffer) return ERR_NOT_SUPPORTED;
 
-	res = Png_EncodeCore(bmp, stream, buffer, getRow, alpha, ctx);
+	res = Png_EncodeCore(bmp, stream, buffer, getRow, alpha, ctx, mode);
 	Mem_Free(buffer);
 	return res;
 }
+
+cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
+					Png_RowGetter getRow, cc_bool alpha, void* ctx) {
+	/* NOTE: Only checked here, as Png_Encode2 may be called from the screenshot thread */
+	if (pngCapture) return Png_Capture(bmp, getRow, ctx);
+	return Png_Encode2(bmp, stream, getRow, alpha, ctx, PNG_ENCODE_NORMAL);
+}
 #else
 /* No point including encoding code when can't save screenshots anyways */
+cc_result Png_Encode2(struct Bitmap* bmp, struct Stream* stream, 
+					Png_RowGetter getRow, cc_bool alpha, void* ctx, int mode) {
+	return ERR_NOT_SUPPORTED;
+}
+
 cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
 					Png_RowGetter getRow, cc_bool alpha, void* ctx) {
 	return ERR_NOT_SUPPORTED;
 }
+
+void Png_SetCapture(struct Bitmap* dst) { }
 #endif
 
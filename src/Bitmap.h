@@ -137,11 +137,34 @@ typedef BitmapCol* (*Png_RowGetter)(struct Bitmap* bmp, int row, void* ctx);
      https://github.com/nothings/stb/blob/master/stb_image.h
 */
 CC_API cc_result Png_Decode(struct Bitmap* bmp, struct Stream* stream);
+/* Same as Png_Decode, but always decodes the stream's data (i.e. ignores Png_SetDecoded) */
+/* NOTE: Threads other than the main thread must use this instead of Png_Decode */
+cc_result Png_DecodeData(struct Bitmap* bmp, struct Stream* stream);
+/* Makes the next Png_Decode call for the given stream return the given already decoded bitmap, */
+/*  instead of decoding the stream's data again. (e.g. when decoded on a background thread) */
+/* NOTE: Must only be called from the main thread */
+void Png_SetDecoded(struct Stream* stream, const struct Bitmap* bmp, cc_result res);
+/* Cancels Png_SetDecoded. Returns whether the bitmap was never returned by Png_Decode. */
+cc_bool Png_ClearDecoded(void);
 /* Encodes a bitmap in PNG format. */
 /* getRow is optional. Can be used to modify how rows are encoded. (e.g. flip image) */
 /* if alpha is non-zero, RGBA channels are saved, otherwise only RGB channels are. */
 cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
 						Png_RowGetter getRow, cc_bool alpha, void* ctx);
 
+enum PngEncodeMode {
+	PNG_ENCODE_NORMAL, /* Balances encoding speed and file size */
+	PNG_ENCODE_FAST,   /* Uses one filter for every row, and only looks for short distance matches */
+	PNG_ENCODE_SMALL   /* Looks much further back for matches, which is slower but produces smaller files */
+};
+/* Encodes a bitmap in PNG format, using the given PngEncodeMode. */
+/* NOTE: Unlike Png_Encode, never captures the bitmap (so can safely be called from other threads) */
+cc_result Png_Encode2(struct Bitmap* bmp, struct Stream* stream, 
+						Png_RowGetter getRow, cc_bool alpha, void* ctx, int mode);
+/* Makes the next Png_Encode call copy the bitmap's rows into the given bitmap, instead of */
+/*  encoding them. (e.g. so that a screenshot can then be encoded on a background thread) */
+/* NOTE: Must only be used on the main thread */
+void Png_SetCapture(struct Bitmap* dst);
+
 CC_END_HEADER
 #endif
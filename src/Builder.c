@@ -359,6 +359,89 @@ static void OutputChunkPartsMeta(int x, int y, int z, struct ChunkInfo* info) {
 	}
 }
 
+#ifdef CC_BUILD_COMPACTCHUNKS
+/*########################################################################################################################*
+*----------------------------------------------------Compact vertices-----------------------------------------------------*
+*#########################################################################################################################*/
+cc_bool Builder_CompactVertices;
+/* Chunks are still built using normal vertices, which are then packed into compact vertices */
+static struct VertexTextured* compactVertices;
+static int compactCapacity;
+
+static int PackChunkValue(float value, int min, int max) {
+	int i = (int)(value + (value >= 0.0f ? 0.5f : -0.5f));
+	return i < min ? min : (i > max ? max : i);
+}
+
+/* Converts normal vertices into VERTEX_FORMAT_CHUNK vertices, relative to the given chunk origin */
+static void PackChunkVertices(struct VertexChunk* dst, const struct VertexTextured* src, int count,
+							  float x, float y, float z) {
+	PackedCol col;
+	int i;
+
+	for (i = 0; i < count; i++, src++, dst++)
+	{
+		dst->x = (cc_int16)PackChunkValue((src->x - x) * VERTEXCHUNK_POS_SCALE, -32768, 32767);
+		dst->y = (cc_int16)PackChunkValue((src->y - y) * VERTEXCHUNK_POS_SCALE, -32768, 32767);
+		dst->z = (cc_int16)PackChunkValue((src->z - z) * VERTEXCHUNK_POS_SCALE, -32768, 32767);
+
+		col      = src->Col;
+		dst->col = (cc_uint16)(((PackedCol_R(col) >> 3) << 11) | ((PackedCol_G(col) >> 2) << 5) | (PackedCol_B(col) >> 3));
+		dst->u   = (cc_uint16)PackChunkValue(src->U * VERTEXCHUNK_U_SCALE, 0, 65535);
+		dst->v   = (cc_uint16)PackChunkValue(src->V * VERTEXCHUNK_V_SCALE, 0, 65535);
+	}
+}
+#endif
+
+#ifdef CC_BUILD_SORTTRANSLUCENT
+#define Builder_SaveTranslucent(info, data) if (info->translucentParts) MapRenderer_SaveTranslucent(info, Builder_Vertices, data);
+#else
+#define Builder_SaveTranslucent(info, data)
+#endif
+
+#ifndef CC_BUILD_GL11
+static struct VertexTextured* Builder_LockVertices(struct ChunkInfo* info, int count) {
+#ifdef CC_BUILD_CHUNKARENA
+	struct VertexTextured* ptr;
+#endif
+#ifdef CC_BUILD_COMPACTCHUNKS
+	if (Builder_CompactVertices) {
+		if (count > compactCapacity) {
+			compactCapacity = count;
+			compactVertices = (struct VertexTextured*)Mem_Realloc(compactVertices, count, 
+													sizeof(struct VertexTextured), "compact vertices");
+		}
+		/* extra element isn't written to by the builder */
+		Mem_Set(&compactVertices[count - 1], 0, sizeof(struct VertexTextured));
+		return compactVertices;
+	}
+#endif
+#ifdef CC_BUILD_CHUNKARENA
+	if ((ptr = MapRenderer_AllocChunkVertices(info, count))) return ptr;
+#endif
+	return (struct VertexTextured*)Gfx_RecreateAndLockVb(&info->vb, VERTEX_FORMAT_TEXTURED, count);
+}
+
+static void Builder_UnlockVertices(struct ChunkInfo* info, int count) {
+#ifdef CC_BUILD_COMPACTCHUNKS
+	struct VertexChunk* dst;
+	if (Builder_CompactVertices) {
+		dst = (struct VertexChunk*)Gfx_RecreateAndLockVb(&info->vb, VERTEX_FORMAT_CHUNK, count);
+		PackChunkVertices(dst, compactVertices, count, info->centreX - HALF_CHUNK_SIZE,
+							info->centreY - HALF_CHUNK_SIZE, info->centreZ - HALF_CHUNK_SIZE);
+		Builder_SaveTranslucent(info, dst);
+		Gfx_UnlockVb(info->vb);
+		return;
+	}
+#endif
+	Builder_SaveTranslucent(info, Builder_Vertices);
+#ifdef CC_BUILD_CHUNKARENA
+	if (info->arenaPage >= 0) { MapRenderer_UploadChunkVertices(info, count); return; }
+#endif
+	Gfx_UnlockVb(info->vb);
+}
+#endif
+
 void Builder_MakeChunk(struct ChunkInfo* info) {
 #ifdef CC_BUILD_TINYSTACK
 	/* The Saturn build only has 16 kb stack, not large enough */
@@ -417,8 +500,7 @@ void Builder_MakeChunk(struct ChunkInfo* info) {
 
 #ifndef CC_BUILD_GL11
 	/* add an extra element to fix crashing on some GPUs */
-	Builder_Vertices = (struct VertexTextured*)Gfx_RecreateAndLockVb(&info->vb,
-													VERTEX_FORMAT_TEXTURED, totalVerts + 1);
+	Builder_Vertices = Builder_LockVertices(info, totalVerts + 1);
 #else
 	/* NOTE: Relies on assumption vb is ignored by GL11 Gfx_LockVb implementation */
 	Builder_Vertices = (struct VertexTextured*)Gfx_LockVb(0, 
@@ -452,7 +534,7 @@ void Builder_MakeChunk(struct ChunkInfo* info) {
 		BuildPartVbs(&MapRenderer_PartsTranslucent[curIdx]);
 	}
 #else
-	Gfx_UnlockVb(info->vb);
+	Builder_UnlockVertices(info, totalVerts + 1);
 #endif
 }
 
@@ -1646,6 +1728,17 @@ static void OnInit(void) {
 
 	if (!Game_ClassicMode) Builder_SmoothLighting = Options_GetBool(OPT_SMOOTH_LIGHTING, false);
 	Builder_ApplyActive();
+#ifdef CC_BUILD_COMPACTCHUNKS
+	Builder_CompactVertices = Options_GetBool(OPT_COMPACT_CHUNKS, false);
+#endif
+}
+
+static void OnFree(void) {
+#ifdef CC_BUILD_COMPACTCHUNKS
+	Mem_Free(compactVertices);
+	compactVertices = NULL;
+	compactCapacity = 0;
+#endif
 }
 
 static void OnNewMapLoaded(void) {
@@ -1655,7 +1748,7 @@ static void OnNewMapLoaded(void) {
 
 struct IGameComponent Builder_Component = {
 	OnInit, /* Init */
-	NULL, /* Free */
+	OnFree, /* Free */
 	NULL, /* Reset */
 	NULL, /* OnNewMap */
 	OnNewMapLoaded /* OnNewMapLoaded */
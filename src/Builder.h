@@ -19,6 +19,14 @@ extern int Builder_SidesLevel, Builder_EdgeLevel;
 /* Whether smooth/advanced lighting mesh builder is used. */
 extern cc_bool Builder_SmoothLighting;
 
+#ifdef CC_BUILD_COMPACTCHUNKS
+/* Whether chunk meshes use the compact VERTEX_FORMAT_CHUNK vertex format. */
+extern cc_bool Builder_CompactVertices;
+#define Builder_VertexFormat (Builder_CompactVertices ? VERTEX_FORMAT_CHUNK : VERTEX_FORMAT_TEXTURED)
+#else
+#define Builder_VertexFormat VERTEX_FORMAT_TEXTURED
+#endif
+
 /* Builds the mesh of vertices for the given chunk. */
 void Builder_MakeChunk(struct ChunkInfo* info);
 
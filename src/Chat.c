@@ -51,6 +51,133 @@ static cc_string logPath = String_FromArray(logPathBuffer);
 
 static struct Stream logStream;
 static int lastLogDay, lastLogMonth, lastLogYear;
+/* Stream that chat log lines are written to (see ChatLog_Write) */
+static struct Stream logWriter;
+/* Size of the current chat log file, including data not yet actually written to it */
+static cc_uint64 logSize;
+/* Size at which logging moves onto the next chat log file (0 means no limit) */
+static cc_uint64 logMaxSize;
+#define CHATLOG_MAX_FILES 100
+
+#ifdef CC_BUILD_ASYNCCHATLOG
+/* Chat log lines are appended to a ring buffer, which is then written to the log file from a */
+/*  background thread. (avoids frame stalls from lots of tiny writes when chat gets spammed) */
+#define CHATLOG_BUFFER_SIZE    (64 * 1024) /* NOTE: Must be a power of two */
+#define CHATLOG_FLUSH_SIZE     (16 * 1024)
+#define CHATLOG_FLUSH_INTERVAL 1000
+
+static cc_uint8 logBuffer[CHATLOG_BUFFER_SIZE];
+/* Total number of bytes ever added to/removed from the ring buffer */
+static cc_uint32 logHead, logTail;
+static cc_result logWriteResult;
+static void* logMutex;     /* Protects logHead, logTail and logWriteResult */
+static void* logFileMutex; /* Held while writing buffered data to the log file */
+static void* logWaitable;
+static void* logThread;
+static volatile cc_bool logStopping;
+
+/* Writes all currently buffered data to the log file */
+static void ChatLog_WriteBuffered(void) {
+	cc_uint32 beg, len, part;
+	cc_result res = 0;
+
+	Mutex_Lock(logFileMutex);
+	{
+		Mutex_Lock(logMutex);
+		beg = logTail % CHATLOG_BUFFER_SIZE;
+		len = logHead - logTail;
+		res = logWriteResult;
+		Mutex_Unlock(logMutex);
+
+		/* After an error, data is just discarded until the log file is closed */
+		if (len && !res) {
+			part = min(len, CHATLOG_BUFFER_SIZE - beg);
+			res  = Stream_Write(&logStream, logBuffer + beg, part);
+			if (!res && part < len) res = Stream_Write(&logStream, logBuffer, len - part);
+		}
+
+		Mutex_Lock(logMutex);
+		logTail       += len;
+		logWriteResult = res;
+		Mutex_Unlock(logMutex);
+	}
+	Mutex_Unlock(logFileMutex);
+}
+
+/* Returns and then resets the result of writing buffered data to the log file */
+static cc_result ChatLog_TakeResult(void) {
+	cc_result res;
+	Mutex_Lock(logMutex);
+	res = logWriteResult; logWriteResult = 0;
+	Mutex_Unlock(logMutex);
+	return res;
+}
+
+static cc_result ChatLog_Write(struct Stream* s, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	cc_uint32 beg, part, pending;
+	cc_result res;
+	if ((res = ChatLog_TakeResult())) return res;
+
+	Mutex_Lock(logMutex);
+	pending = logHead - logTail;
+	Mutex_Unlock(logMutex);
+	/* Buffer is full, so have to wait for it to be written out */
+	if (pending + count > CHATLOG_BUFFER_SIZE) ChatLog_WriteBuffered();
+
+	Mutex_Lock(logMutex);
+	{
+		count = min(count, CHATLOG_BUFFER_SIZE - (logHead - logTail));
+		beg   = logHead % CHATLOG_BUFFER_SIZE;
+		part  = min(count, CHATLOG_BUFFER_SIZE - beg);
+
+		Mem_Copy(logBuffer + beg, data, part);
+		Mem_Copy(logBuffer, data + part, count - part);
+		logHead += count;
+		pending  = logHead - logTail;
+	}
+	Mutex_Unlock(logMutex);
+
+	if (pending >= CHATLOG_FLUSH_SIZE) Waitable_Signal(logWaitable);
+	*modified = count;
+	logSize  += count;
+	return 0;
+}
+
+/* Writes any remaining buffered data to the log file */
+static cc_result ChatLog_Flush(void) {
+	ChatLog_WriteBuffered();
+	return ChatLog_TakeResult();
+}
+
+static void ChatLog_WorkerLoop(void) {
+	while (!logStopping) {
+		Waitable_WaitFor(logWaitable, CHATLOG_FLUSH_INTERVAL);
+		ChatLog_WriteBuffered();
+	}
+}
+
+static void ChatLog_StartWorker(void) {
+	if (logThread) return;
+	Thread_Run(&logThread, ChatLog_WorkerLoop, 64 * 1024, "Chat log");
+}
+
+static void ChatLog_StopWorker(void) {
+	logStopping = true;
+	Waitable_Signal(logWaitable);
+
+	if (logThread) Thread_Join(logThread);
+	logThread = NULL;
+}
+#else
+static cc_result ChatLog_Write(struct Stream* s, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	cc_result res = logStream.Write(&logStream, data, count, modified);
+	if (!res) logSize += *modified;
+	return res;
+}
+
+static cc_result ChatLog_Flush(void) { return 0; }
+static void ChatLog_StartWorker(void) { }
+#endif
 
 /* Resets log name to empty and resets last log date */
 static void ResetLogFile(void) {
@@ -60,11 +187,18 @@ static void ResetLogFile(void) {
 
 /* Closes handle to the chat log file */
 static void CloseLogFile(void) {
-	cc_result res;
+	cc_result res, writeRes;
 	if (!logStream.meta.file) return;
 
-	res = logStream.Close(&logStream);
-	if (res) { Logger_SysWarn2(res, "closing", &logPath); }
+	writeRes = ChatLog_Flush();
+	res      = logStream.Close(&logStream);
+
+	if (writeRes) {
+		Chat_DisableLogging();
+		Logger_SysWarn2(writeRes, "writing to", &logPath);
+	} else if (res) { 
+		Logger_SysWarn2(res, "closing", &logPath); 
+	}
 }
 
 /* Whether the given character is an allowed in a log filename */
@@ -127,7 +261,7 @@ static void OpenChatLog(struct cc_datetime* now) {
 	if (Platform_ReadonlyFilesystem || !CreateLogsDirectory()) return;
 
 	/* Ensure multiple instances do not end up overwriting each other's log entries. */
-	for (i = 0; i < 20; i++) {
+	for (i = 0; i < CHATLOG_MAX_FILES; i++) {
 		logPath.length = 0;
 		String_Format3(&logPath, "logs/%p4-%p2-%p2 ", &now->year, &now->month, &now->day);
 
@@ -145,6 +279,12 @@ static void OpenChatLog(struct cc_datetime* now) {
 		}
 
 		if (res == ReturnCode_FileShareViolation) continue;
+
+		/* Move onto the next log file once this one has gotten too large */
+		if (logStream.Length(&logStream, &logSize)) logSize = 0;
+		if (logMaxSize && logSize >= logMaxSize) { (void)logStream.Close(&logStream); continue; }
+
+		ChatLog_StartWorker();
 		return;
 	}
 
@@ -173,8 +313,13 @@ static void AppendChatLog(const cc_string* text) {
 	String_Format3(&str, "[%p2:%p2:%p2] ", &now.hour, &now.minute, &now.second);
 	Drawer2D_WithoutColors(&str, text);
 
-	res = Stream_WriteLine(&logStream, &str);
-	if (!res) return;
+	res = Stream_WriteLine(&logWriter, &str);
+	if (!res) {
+		if (!logMaxSize || logSize < logMaxSize) return;
+		CloseLogFile();
+		OpenChatLog(&now);
+		return;
+	}
 	Chat_DisableLogging();
 	Logger_SysWarn2(res, "writing to", &logPath);
 }
@@ -277,6 +422,15 @@ static void OnInit(void) {
 	Chat_Logging = Options_GetBool(OPT_CHAT_LOGGING, false);
 #else
 	Chat_Logging = Options_GetBool(OPT_CHAT_LOGGING, true);
+#endif
+	logMaxSize = (cc_uint64)Options_GetInt(OPT_CHAT_LOG_MAX_SIZE, 0, 4096, 64) * 1024 * 1024;
+
+	Stream_Init(&logWriter);
+	logWriter.Write = ChatLog_Write;
+#ifdef CC_BUILD_ASYNCCHATLOG
+	logMutex     = Mutex_Create("Chat log buffer");
+	logFileMutex = Mutex_Create("Chat log file");
+	logWaitable  = Waitable_Create("Chat log wakeup");
 #endif
 }
 
@@ -299,7 +453,17 @@ static void OnReset(void) {
 }
 
 static void OnFree(void) {
+#ifdef CC_BUILD_ASYNCCHATLOG
+	/* Worker thread must be stopped first, so that the rest of the data can be written and then the file closed */
+	ChatLog_StopWorker();
 	CloseLogFile();
+
+	Mutex_Free(logMutex);
+	Mutex_Free(logFileMutex);
+	Waitable_Free(logWaitable);
+#else
+	CloseLogFile();
+#endif
 	ClearCPEMessages();
 
 	ClearChatLogs();
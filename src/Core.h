@@ -151,6 +151,7 @@ typedef cc_uint8  cc_bool;
 #define CC_AUD_BACKEND_OPENAL   1
 #define CC_AUD_BACKEND_WINMM    2
 #define CC_AUD_BACKEND_OPENSLES 3
+#define CC_AUD_BACKEND_WAVFILE  4
 
 #define CC_GFX_BACKEND_IS_GL() (CC_GFX_BACKEND == CC_GFX_BACKEND_GL1 || CC_GFX_BACKEND == CC_GFX_BACKEND_GL2)
 
@@ -538,6 +539,48 @@ typedef cc_uint8  cc_bool;
 	#define CC_AUD_BACKEND DEFAULT_AUD_BACKEND
 #endif
 
+/* Sub-allocate chunk meshes from large shared vertex buffers (see MapRenderer.c) */
+#if CC_GFX_BACKEND_IS_GL() && !defined CC_BUILD_GL11 && !defined CC_BUILD_LOWMEM
+	#define CC_BUILD_CHUNKARENA
+#endif
+/* Sort translucent faces of nearby chunks back to front (see MapRenderer.c) */
+#ifdef CC_BUILD_CHUNKARENA
+	#define CC_BUILD_SORTTRANSLUCENT
+#endif
+/* Allow 1D terrain atlases as tall as the GPU supports (see TexturePack.c) */
+#if CC_GFX_BACKEND == CC_GFX_BACKEND_GL2 || CC_GFX_BACKEND == CC_GFX_BACKEND_D3D11
+	#define CC_BUILD_TALLATLAS
+#endif
+/* Extract and decode texture packs on background threads (see TexturePack.c) */
+#if !defined CC_BUILD_COOPTHREADED && !defined CC_BUILD_LOWMEM && !defined CC_BUILD_WEB
+	#define CC_BUILD_ASYNCTEXPACK
+#endif
+/* Encode and save screenshots on a background thread (see Game.c) */
+#if defined CC_BUILD_FILESYSTEM && !defined CC_BUILD_COOPTHREADED && !defined CC_BUILD_LOWMEM && !defined CC_BUILD_WEB
+	#define CC_BUILD_ASYNCSCREENSHOT
+#endif
+/* Support the compact quantized chunk vertex format (see Builder.c) */
+#if CC_GFX_BACKEND == CC_GFX_BACKEND_GL2 || CC_GFX_BACKEND == CC_GFX_BACKEND_SOFTGPU
+	#define CC_BUILD_COMPACTCHUNKS
+#endif
+/* Write chat logs to disc on a background thread (see Chat.c) */
+#if defined CC_BUILD_FILESYSTEM && !defined CC_BUILD_COOPTHREADED && !defined CC_BUILD_LOWMEM && !defined CC_BUILD_WEB
+	#define CC_BUILD_ASYNCCHATLOG
+#endif
+/* Mix all sounds into a single audio stream on a background thread (see AudioBackend.c) */
+#if (CC_AUD_BACKEND == CC_AUD_BACKEND_OPENAL || CC_AUD_BACKEND == CC_AUD_BACKEND_WINMM || CC_AUD_BACKEND == CC_AUD_BACKEND_WAVFILE) && !defined CC_BUILD_COOPTHREADED
+	#define CC_BUILD_AUDIOMIXER
+#endif
+/* Record how long zones of code take, for dumping to Chrome trace files (see Profiler.c) */
+/* NOTE: Not enabled by default, define CC_BUILD_PROFILER when compiling to enable it */
+#if defined CC_BUILD_PROFILER && (defined CC_BUILD_COOPTHREADED || defined CC_BUILD_CONSOLE)
+	#undef CC_BUILD_PROFILER
+#endif
+/* Use SSE2 intrinsics in hot decoding loops (see Bitmap.c) */
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+	#define CC_BUILD_SSE2
+#endif
+
 #ifdef CC_BUILD_CONSOLE
 #undef CC_BUILD_FREETYPE
 #undef CC_BUILD_PLUGINS
@@ -897,10 +897,10 @@ static cc_result Deflate_FlushBlock(struct DeflateState* state, int len) {
 		bestPos = 0;
 
 		/* Find longest match starting at this byte */
-		/* Only explore up to 5 previous matches, to avoid slow performance */
+		/* Only explore a few previous matches, to avoid slow performance */
 		/* (i.e prefer quickly saving maps/screenshots to completely optimal filesize) */
 		pos = state->Head[hash];
-		for (depth = 0; pos != 0 && depth < 5; depth++) {
+		for (depth = 0; pos != 0 && depth < state->SearchDepth; depth++) {
 			matchLen = Deflate_MatchLen(&input[pos], cur, maxLen);
 			if (matchLen > bestLen) { bestLen = matchLen; bestPos = pos; }
 			pos = state->Prev[pos];
@@ -914,12 +914,12 @@ static cc_result Deflate_FlushBlock(struct DeflateState* state, int len) {
 
 		/* Lazy evaluation: Find longest match starting at next byte */
 		/* If that's longer than the longest match at current byte, throwaway this match */
-		if (bestPos) {
+		if (bestPos && state->LazyMatching) {
 			nextHash = Deflate_Hash(cur + 1);
 			nextPos  = state->Head[nextHash];
 			maxLen   = min(len - 1, MAX_MATCH_LEN);
 
-			for (depth = 0; nextPos != 0 && depth < 5; depth++) {
+			for (depth = 0; nextPos != 0 && depth < state->SearchDepth; depth++) {
 				matchLen = Deflate_MatchLen(&input[nextPos], cur + 1, maxLen);
 				if (matchLen > bestLen) { bestPos = 0; break; }
 				nextPos = state->Prev[nextPos];
@@ -1043,6 +1043,9 @@ void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struc
 	state->Dest     = underlying;
 	state->WroteHeader = false;
 
+	state->LazyMatching = true;
+	state->SearchDepth  = DEFLATE_DEFAULT_DEPTH;
+
 	Mem_Set(state->Head, 0, sizeof(state->Head));
 	Mem_Set(state->Prev, 0, sizeof(state->Prev));
 	Deflate_BuildTable(fixed_lits, INFLATE_MAX_LITS, state->LitsCodewords, state->LitsLens);
@@ -1162,14 +1165,21 @@ struct ZipState {
 	/* Total number of entries in the archive */
 	int totalEntries;
 	/* Offset to central directory entries */
-	cc_uint32 centralDirBeg;
+	cc_uint64 centralDirBeg;
 };
+#define Zip_GetU64_LE(data) (Stream_GetU32_LE(data) | ((cc_uint64)Stream_GetU32_LE((data) + 4) << 32))
+
+#ifdef CC_BUILD_SMALLSTACK
+#define ZIP_BUFFER_SIZE 512
+#else
+#define ZIP_BUFFER_SIZE 4096
+#endif
 
 static cc_result Zip_ReadLocalFileHeader(struct ZipState* state, struct ZipEntry* entry) {
 	struct Stream* stream = state->source;
 	cc_uint8 header[26];
 	cc_string path; char pathBuffer[ZIP_MAXNAMELEN];
-	cc_uint32 compressedSize, uncompressedSize;
+	cc_uint64 compressedSize, uncompressedSize;
 	int method, pathLen, extraLen;
 	struct Stream portion, compStream;
 #ifdef CC_BUILD_SMALLSTACK
@@ -1197,8 +1207,9 @@ static cc_result Zip_ReadLocalFileHeader(struct ZipState* state, struct ZipEntry
 	uncompressedSize = Stream_GetU32_LE(&header[18]);
 
 	/* Some .zip files don't set these in local file header */
-	if (!compressedSize)   compressedSize   = entry->CompressedSize;
-	if (!uncompressedSize) uncompressedSize = entry->UncompressedSize;
+	/*  (and ZIP64 entries store the actual sizes in the extra data instead) */
+	if (!compressedSize   || compressedSize   == 0xFFFFFFFFUL) compressedSize   = entry->CompressedSize;
+	if (!uncompressedSize || uncompressedSize == 0xFFFFFFFFUL) uncompressedSize = entry->UncompressedSize;
 
 	if (method == 0) {
 		Stream_ReadonlyPortion(&portion, stream, uncompressedSize);
@@ -1225,6 +1236,47 @@ static cc_result Zip_ReadLocalFileHeader(struct ZipState* state, struct ZipEntry
 	return res;
 }
 
+/* Reads a 64 bit value from ZIP64 extra data, if the 32 bit value in the header was saturated */
+static cc_result Zip_ReadZip64Value(struct Stream* stream, int* dataLeft, cc_uint64* value) {
+	cc_uint8 tmp[8];
+	cc_result res;
+	if (*value != 0xFFFFFFFFUL) return 0;
+
+	if (*dataLeft < 8) return ZIP_ERR_INVALID_CENTRAL_DIR;
+	if ((res = Stream_Read(stream, tmp, 8))) return res;
+
+	*value     = Zip_GetU64_LE(tmp);
+	*dataLeft -= 8;
+	return 0;
+}
+
+/* Reads the extra data following a central directory entry header */
+/* NOTE: Only ZIP64 extended information (ID 0x0001) is actually used, all other data is skipped */
+static cc_result Zip_ReadExtraData(struct Stream* stream, struct ZipEntry* entry, int extraLen) {
+	cc_uint8 header[4];
+	int id, dataLen;
+	cc_result res;
+
+	while (extraLen >= 4) {
+		if ((res = Stream_Read(stream, header, 4))) return res;
+		id       = Stream_GetU16_LE(&header[0]);
+		dataLen  = Stream_GetU16_LE(&header[2]);
+		extraLen -= 4;
+
+		if (dataLen > extraLen) return ZIP_ERR_INVALID_CENTRAL_DIR;
+		extraLen -= dataLen;
+
+		/* Values are only present when saturated in the header, and always in this order */
+		if (id == 0x0001) {
+			if ((res = Zip_ReadZip64Value(stream, &dataLen, &entry->UncompressedSize)))  return res;
+			if ((res = Zip_ReadZip64Value(stream, &dataLen, &entry->CompressedSize)))    return res;
+			if ((res = Zip_ReadZip64Value(stream, &dataLen, &entry->LocalHeaderOffset))) return res;
+		}
+		if ((res = stream->Skip(stream, dataLen))) return res;
+	}
+	return stream->Skip(stream, extraLen);
+}
+
 static cc_result Zip_ReadCentralDirectory(struct ZipState* state) {
 	struct Stream* stream = state->source;
 	struct ZipEntry* entry;
@@ -1242,19 +1294,20 @@ static cc_result Zip_ReadCentralDirectory(struct ZipState* state) {
 	path = String_Init(pathBuffer, pathLen, pathLen);
 	if ((res = Stream_Read(stream, (cc_uint8*)pathBuffer, pathLen))) return res;
 
-	/* skip data following central directory entry header */
 	extraLen   = Stream_GetU16_LE(&header[26]);
 	commentLen = Stream_GetU16_LE(&header[28]);
-	if ((res = stream->Skip(stream, extraLen + commentLen))) return res;
 
-	if (!state->SelectEntry(&path)) return 0;
+	/* skip data following central directory entry header */
+	if (!state->SelectEntry(&path)) return stream->Skip(stream, extraLen + commentLen);
 	if (state->usedEntries >= state->maxEntries) return ZIP_ERR_TOO_MANY_ENTRIES;
 	entry = &state->entries[state->usedEntries++];
 
 	entry->CompressedSize    = Stream_GetU32_LE(&header[16]);
 	entry->UncompressedSize  = Stream_GetU32_LE(&header[20]);
 	entry->LocalHeaderOffset = Stream_GetU32_LE(&header[38]);
-	return 0;
+
+	if ((res = Zip_ReadExtraData(stream, entry, extraLen))) return res;
+	return stream->Skip(stream, commentLen);
 }
 
 static cc_result Zip_ReadEndOfCentralDirectory(struct ZipState* state) {
@@ -1272,23 +1325,62 @@ static cc_result Zip_ReadEndOfCentralDirectory(struct ZipState* state) {
 enum ZipSig {
 	ZIP_SIG_ENDOFCENTRALDIR = 0x06054b50,
 	ZIP_SIG_CENTRALDIR      = 0x02014b50,
-	ZIP_SIG_LOCALFILEHEADER = 0x04034b50
+	ZIP_SIG_LOCALFILEHEADER = 0x04034b50,
+	ZIP_SIG_ZIP64_ENDOFCENTRALDIR = 0x06064b50,
+	ZIP_SIG_ZIP64_LOCATOR         = 0x07064b50
 };
 
+static cc_result Zip_ReadZip64EndOfCentralDirectory(struct ZipState* state, cc_uint64 endOfCentralDirBeg) {
+	struct Stream* stream = state->source;
+	cc_uint8 header[52];
+	cc_uint64 totalEntries;
+	cc_uint32 sig;
+	cc_result res;
+
+	/* ZIP64 end of central directory locator is immediately before the end of central directory */
+	if (endOfCentralDirBeg < 20) return 0;
+	res = stream->Seek(stream, endOfCentralDirBeg - 20);
+	if (res) return ZIP_ERR_SEEK_END_OF_CENTRAL_DIR;
+
+	/* No locator means this is a normal archive, which just happens to have e.g. 65535 entries */
+	if ((res = Stream_ReadU32_LE(stream, &sig))) return res;
+	if (sig != ZIP_SIG_ZIP64_LOCATOR) return 0;
+	if ((res = Stream_Read(stream, header, 16))) return res;
+
+	res = stream->Seek(stream, Zip_GetU64_LE(&header[4]));
+	if (res) return ZIP_ERR_SEEK_END_OF_CENTRAL_DIR;
+
+	if ((res = Stream_ReadU32_LE(stream, &sig))) return res;
+	if (sig != ZIP_SIG_ZIP64_ENDOFCENTRALDIR) return ZIP_ERR_NO_END_OF_CENTRAL_DIR;
+	if ((res = Stream_Read(stream, header, sizeof(header)))) return res;
+
+	totalEntries         = Zip_GetU64_LE(&header[28]);
+	state->totalEntries  = (int)min(totalEntries, 0x7FFFFFFF);
+	state->centralDirBeg = Zip_GetU64_LE(&header[44]);
+	return 0;
+}
+
 cc_result Zip_Extract(struct Stream* source, Zip_SelectEntry selector, Zip_ProcessEntry processor, 
 						struct ZipEntry* entries, int maxEntries) {
 	struct ZipState state;
-	cc_uint32 stream_len;
+	struct Stream buffered;
+	cc_uint8 buffer[ZIP_BUFFER_SIZE];
+	cc_uint64 stream_len, endOfCentralDirBeg = 0;
 	cc_uint32 sig = 0;
 	int i, count;
 
 	cc_result res;
 	if ((res = source->Length(source, &stream_len))) return res;
 
+	/* Reading .zip headers involves many small reads, so avoid making a file read call for each */
+	Stream_ReadonlyBuffered(&buffered, source, buffer, sizeof(buffer));
+	source = &buffered;
+
 	/* At -22 for nearly all zips, but try a bit further back in case of comment */
-	count = min(257, stream_len);
+	count = (int)min(257, stream_len);
 	for (i = 22; i < count; i++) {
-		res = source->Seek(source, stream_len - i);
+		endOfCentralDirBeg = stream_len - i;
+		res = source->Seek(source, endOfCentralDirBeg);
 		if (res) return ZIP_ERR_SEEK_END_OF_CENTRAL_DIR;
 
 		if ((res = Stream_ReadU32_LE(source, &sig))) return res;
@@ -1305,6 +1397,13 @@ cc_result Zip_Extract(struct Stream* source, Zip_SelectEntry selector, Zip_Proce
 	res = Zip_ReadEndOfCentralDirectory(&state);
 	if (res) return res;
 
+	/* ZIP64 archives saturate these, and store the actual values in a ZIP64 end of central directory instead */
+	/*  (if there isn't one though, the values from the normal end of central directory are kept) */
+	if (state.totalEntries == 0xFFFF || state.centralDirBeg == 0xFFFFFFFFUL) {
+		res = Zip_ReadZip64EndOfCentralDirectory(&state, endOfCentralDirBeg);
+		if (res) return res;
+	}
+
 	res = source->Seek(source, state.centralDirBeg);
 	if (res) return ZIP_ERR_SEEK_CENTRAL_DIR;
 	state.usedEntries = 0;
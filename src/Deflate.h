@@ -108,7 +108,11 @@ struct DeflateState {
 	/* NOTE: The largest possible value that can get */
 	/*  stored in Head/Prev is <= DEFLATE_BUFFER_SIZE */
 	cc_bool WroteHeader;
+	/* NOTE: These fit into what was previously padding, so the struct's layout is unchanged */
+	cc_bool LazyMatching; /* Whether to also look for a longer match starting at the next byte */
+	cc_uint8 SearchDepth; /* Max number of earlier matches compared against when finding a match */
 };
+#define DEFLATE_DEFAULT_DEPTH 5
 /* Compresses input data using DEFLATE, then writes compressed output to another stream. Write only stream. */
 /* DEFLATE compression is pure compressed data, there is no header or footer. */
 CC_API void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying);
@@ -126,7 +130,7 @@ CC_API  void ZLib_MakeStream(      struct Stream* stream, struct ZLibState* stat
 typedef void (*FP_ZLib_MakeStream)(struct Stream* stream, struct ZLibState* state, struct Stream* underlying);
 
 /* Minimal data needed to describe an entry in a .zip archive */
-struct ZipEntry { cc_uint32 CompressedSize, UncompressedSize, LocalHeaderOffset; };
+struct ZipEntry { cc_uint64 CompressedSize, UncompressedSize, LocalHeaderOffset; };
 /* Callback function to process the data in a .zip archive entry */
 /* Return non-zero to indicate an error and stop further processing */
 /* NOTE: data stream MAY NOT be seekable (i.e. entry data might be compressed) */
@@ -125,6 +125,21 @@ cc_bool Font_SetBitmapAtlas(struct Bitmap* bmp) {
 	return true;
 }
 
+struct Bitmap* Font_GetBitmapAtlas(void) {
+	return fontBitmap.scan0 ? &fontBitmap : NULL;
+}
+
+int Font_GetBitmapGlyph(char c, int point, TextureRec* rec) {
+	float scale = 1.0f / fontBitmap.width;
+	cc_uint8 i  = (cc_uint8)c;
+
+	rec->u1 = ((i & 0x0F) * tileSize) * scale;
+	rec->v1 = ((i >> 4)   * tileSize) * scale;
+	rec->u2 = rec->u1 + tileWidths[i] * scale;
+	rec->v2 = rec->v1 + tileSize      * scale;
+	return Math_CeilDiv(tileWidths[i] * point, tileSize);
+}
+
 void Font_SetPadding(struct FontDesc* desc, int amount) {
 	if (!Font_IsBitmap(desc)) return;
 	desc->height = desc->size + Display_ScaleY(amount) * 2;
@@ -400,7 +415,6 @@ cc_bool Drawer2D_IsWhiteColor(char c) { return c == '\0' || c == 'f' || c == 'F'
 
 /* TODO: Needs to account for DPI */
 #define Drawer2D_ShadowOffset(point) (point / 8)
-#define Drawer2D_XPadding(point) (Math_CeilDiv(point, 8))
 static int Drawer2D_Width(int point, char c) {
 	return Math_CeilDiv(tileWidths[(cc_uint8)c] * point, tileSize);
 }
@@ -124,6 +124,13 @@ void Drawer2D_Fill(struct Bitmap* bmp, int x, int y, int width, int height, Bitm
 /* Sets the bitmap used for drawing bitmapped fonts. (i.e. default.png) */
 /* The bitmap must be square and consist of a 16x16 tile layout */
 cc_bool Font_SetBitmapAtlas(struct Bitmap* bmp);
+/* Returns the bitmap used for drawing bitmapped fonts, or NULL if not loaded */
+struct Bitmap* Font_GetBitmapAtlas(void);
+/* Calculates the region of the given character within the bitmapped font atlas, */
+/*  and returns how wide the character would be when drawn at the given point size */
+int Font_GetBitmapGlyph(char c, int point, TextureRec* rec);
+/* Horizontal padding between characters when drawn at the given point size */
+#define Drawer2D_XPadding(point) (Math_CeilDiv(point, 8))
 /* Sets padding for a bitmapped font */
 void Font_SetPadding(struct FontDesc* desc, int amount);
 /* Initialises the given font for drawing bitmapped text using default.png */
@@ -202,6 +202,163 @@ cc_bool Entity_TouchesAnyWater(struct Entity* e) {
 }
 
 
+/*########################################################################################################################*
+*-------------------------------------------------------Skin atlas--------------------------------------------------------*
+*#########################################################################################################################*/
+/* Standard 64x64 and 64x32 skins are packed into a few shared atlas pages, instead of each */
+/*  skin having its own texture. Skins no longer used by any entity stay cached in the atlas */
+/*  until their slot is needed again, at which point the least recently used slot is evicted */
+#ifdef CC_BUILD_LOWMEM
+#define SKINATLAS_MAX_PAGES 1
+#else
+#define SKINATLAS_MAX_PAGES 4
+#endif
+#define SKINATLAS_PAGE_SIZE  512
+#define SKINATLAS_SLOT_SIZE  64
+#define SKINATLAS_ROW_SLOTS  (SKINATLAS_PAGE_SIZE / SKINATLAS_SLOT_SIZE)
+#define SKINATLAS_PAGE_SLOTS (SKINATLAS_ROW_SLOTS * SKINATLAS_ROW_SLOTS)
+#define SKINATLAS_MAX_SLOTS  (SKINATLAS_MAX_PAGES * SKINATLAS_PAGE_SLOTS)
+
+static struct SkinAtlasSlot {
+	char name[STRING_SIZE]; /* Name of the skin in this slot, empty if unused */
+	cc_uint32 lastUsed;     /* Value of skinAtlas_clock when last assigned to an entity */
+	cc_uint8 skinType;
+	cc_uint8 height;
+} skinAtlas_slots[SKINATLAS_MAX_SLOTS];
+
+static GfxResourceID skinAtlas_pages[SKINATLAS_MAX_PAGES];
+static int skinAtlas_numPages;
+static cc_uint32 skinAtlas_clock;
+
+static void SkinAtlas_Clear(void) {
+	int i;
+	for (i = 0; i < skinAtlas_numPages; i++)
+	{
+		Gfx_DeleteTexture(&skinAtlas_pages[i]);
+	}
+
+	Mem_Set(skinAtlas_slots, 0, sizeof(skinAtlas_slots));
+	skinAtlas_numPages = 0;
+	skinAtlas_clock    = 0;
+}
+
+static int SkinAtlas_SlotOf(struct Entity* e) {
+	int page, x, y;
+	if (!(e->Flags & ENTITY_FLAG_SKIN_ATLAS)) return -1;
+
+	for (page = 0; page < skinAtlas_numPages; page++)
+	{
+		if (skinAtlas_pages[page] != e->TextureId) continue;
+
+		x = (int)(e->uOffset * SKINATLAS_ROW_SLOTS + 0.5f);
+		y = (int)(e->vOffset * SKINATLAS_ROW_SLOTS + 0.5f);
+		return page * SKINATLAS_PAGE_SLOTS + y * SKINATLAS_ROW_SLOTS + x;
+	}
+	return -1;
+}
+
+static int SkinAtlas_Find(const cc_string* skin) {
+	cc_string name;
+	int i;
+
+	for (i = 0; i < skinAtlas_numPages * SKINATLAS_PAGE_SLOTS; i++)
+	{
+		name = String_FromRawArray(skinAtlas_slots[i].name);
+		if (String_Equals(&name, skin)) return i;
+	}
+	return -1;
+}
+
+static cc_bool SkinAtlas_AddPage(void) {
+	struct Bitmap bmp;
+	if (skinAtlas_numPages == SKINATLAS_MAX_PAGES) return false;
+	if (!Gfx_CheckTextureSize(SKINATLAS_PAGE_SIZE, SKINATLAS_PAGE_SIZE, 0)) return false;
+
+	bmp.width  = SKINATLAS_PAGE_SIZE;
+	bmp.height = SKINATLAS_PAGE_SIZE;
+	bmp.scan0  = (BitmapCol*)Mem_TryAllocCleared(SKINATLAS_PAGE_SIZE * SKINATLAS_PAGE_SIZE, BITMAPCOLOR_SIZE);
+	if (!bmp.scan0) return false;
+
+	skinAtlas_pages[skinAtlas_numPages] = Gfx_CreateTexture(&bmp, TEXTURE_FLAG_MANAGED | TEXTURE_FLAG_DYNAMIC, false);
+	Mem_Free(bmp.scan0);
+
+	if (!skinAtlas_pages[skinAtlas_numPages]) return false;
+	skinAtlas_numPages++;
+	return true;
+}
+
+/* Returns an empty slot, or evicts the least recently used slot no entity is using */
+static int SkinAtlas_AllocSlot(void) {
+	cc_bool inUse[SKINATLAS_MAX_SLOTS] = { 0 };
+	int i, slot, count = skinAtlas_numPages * SKINATLAS_PAGE_SLOTS;
+
+	for (i = 0; i < count; i++)
+	{
+		if (!skinAtlas_slots[i].name[0]) return i;
+	}
+	if (SkinAtlas_AddPage()) return count;
+
+	for (i = 0; i < ENTITIES_MAX_COUNT; i++)
+	{
+		if (!Entities.List[i]) continue;
+		slot = SkinAtlas_SlotOf(Entities.List[i]);
+		if (slot >= 0) inUse[slot] = true;
+	}
+
+	slot = -1;
+	for (i = 0; i < count; i++)
+	{
+		if (inUse[i]) continue;
+		if (slot == -1 || skinAtlas_slots[i].lastUsed < skinAtlas_slots[slot].lastUsed) slot = i;
+	}
+	return slot;
+}
+
+/* Makes the given entity use the skin stored in the given atlas slot */
+static void SkinAtlas_Apply(struct Entity* e, int slot) {
+	struct SkinAtlasSlot* s = &skinAtlas_slots[slot];
+	int idx = slot % SKINATLAS_PAGE_SLOTS;
+
+	e->TextureId = skinAtlas_pages[slot / SKINATLAS_PAGE_SLOTS];
+	e->SkinType  = s->skinType;
+	e->Flags    |= ENTITY_FLAG_SKIN_ATLAS;
+
+	e->uScale  = (float)SKINATLAS_SLOT_SIZE / SKINATLAS_PAGE_SIZE;
+	e->vScale  = (float)s->height           / SKINATLAS_PAGE_SIZE;
+	e->uOffset = (float)(idx % SKINATLAS_ROW_SLOTS) / SKINATLAS_ROW_SLOTS;
+	e->vOffset = (float)(idx / SKINATLAS_ROW_SLOTS) / SKINATLAS_ROW_SLOTS;
+	s->lastUsed = ++skinAtlas_clock;
+}
+
+/* Attempts to store the given skin in the atlas, returning false if not possible */
+static cc_bool SkinAtlas_TryAdd(struct Entity* e, struct Bitmap* bmp, const cc_string* skin) {
+	struct SkinAtlasSlot* s;
+	int slot, idx, x, y;
+
+	/* Only standard sized skins are stored in the atlas */
+	if (bmp->width != SKINATLAS_SLOT_SIZE) return false;
+	if (bmp->height != SKINATLAS_SLOT_SIZE && bmp->height != SKINATLAS_SLOT_SIZE / 2) return false;
+	if (e->uScale != 1.0f || e->vScale != 1.0f) return false;
+
+	slot = SkinAtlas_Find(skin);
+	if (slot == -1) slot = SkinAtlas_AllocSlot();
+	if (slot == -1) return false;
+
+	idx = slot % SKINATLAS_PAGE_SLOTS;
+	x   = (idx % SKINATLAS_ROW_SLOTS) * SKINATLAS_SLOT_SIZE;
+	y   = (idx / SKINATLAS_ROW_SLOTS) * SKINATLAS_SLOT_SIZE;
+	Gfx_UpdateTexturePart(skinAtlas_pages[slot / SKINATLAS_PAGE_SLOTS], x, y, bmp, false);
+
+	s = &skinAtlas_slots[slot];
+	String_CopyToRawArray(s->name, skin);
+	s->skinType = e->SkinType;
+	s->height   = bmp->height;
+
+	SkinAtlas_Apply(e, slot);
+	return true;
+}
+
+
 /*########################################################################################################################*
 *------------------------------------------------------Entity skins-------------------------------------------------------*
 *#########################################################################################################################*/
@@ -228,6 +385,10 @@ static void Entity_CopySkin(struct Entity* dst, struct Entity* src) {
 	dst->uScale       = src->uScale;
 	dst->vScale       = src->vScale;
 	dst->MobTextureId = src->MobTextureId;
+
+	dst->Flags   = (dst->Flags & ~ENTITY_FLAG_SKIN_ATLAS) | (src->Flags & ENTITY_FLAG_SKIN_ATLAS);
+	dst->uOffset = src->uOffset;
+	dst->vOffset = src->vOffset;
 }
 
 /* Resets skin data for the given entity */
@@ -236,6 +397,7 @@ static void Entity_ResetSkin(struct Entity* e) {
 	e->MobTextureId = 0;
 	e->TextureId    = 0;
 	e->SkinType     = SKIN_64x32;
+	e->Flags       &= ~ENTITY_FLAG_SKIN_ATLAS;
 }
 
 /* Copies or resets skin data for all entity with same skin */
@@ -322,7 +484,7 @@ static cc_result ApplySkin(struct Entity* e, struct Bitmap* bmp, struct Stream*
 	cc_result res;
 	if ((res = Png_Decode(bmp, src))) return res;
 
-	Gfx_DeleteTexture(&e->TextureId);
+	if (!(e->Flags & ENTITY_FLAG_SKIN_ATLAS)) Gfx_DeleteTexture(&e->TextureId);
 	Entity_SetSkinAll(e, true);
 	if ((res = EnsurePow2Skin(e, bmp))) return res;
 	e->SkinType = Utils_CalcSkinType(bmp);
@@ -333,7 +495,8 @@ static cc_result ApplySkin(struct Entity* e, struct Bitmap* bmp, struct Stream*
 		if (e->Model->flags & MODEL_FLAG_CLEAR_HAT)
 			Entity_ClearHat(bmp, e->SkinType);
 
-		e->TextureId = Gfx_CreateTexture(bmp, TEXTURE_FLAG_MANAGED, false);
+		if (!SkinAtlas_TryAdd(e, bmp, skin))
+			e->TextureId = Gfx_CreateTexture(bmp, TEXTURE_FLAG_MANAGED, false);
 		Entity_SetSkinAll(e, false);
 	}
 	return 0;
@@ -360,6 +523,7 @@ static void Entity_CheckSkin(struct Entity* e) {
 	cc_string skin;
 	cc_uint8 flags;
 	cc_result res;
+	int slot;
 
 	/* Don't check skin if don't have to */
 	if (!e->Model->usesSkin) return;
@@ -370,6 +534,13 @@ static void Entity_CheckSkin(struct Entity* e) {
 		first = Entity_FirstOtherWithSameSkinAndFetchedSkin(e);
 		flags = e == &LocalPlayer_Instances[0].Base ? HTTP_FLAG_NOCACHE : 0;
 
+		/* Reuse skin still cached in the atlas from an entity that has since been removed */
+		if (!first && !flags && (slot = SkinAtlas_Find(&skin)) >= 0) {
+			SkinAtlas_Apply(e, slot);
+			Entity_SetSkinAll(e, false);
+			return;
+		}
+
 		if (!first) {
 			e->_skinReqID     = Http_AsyncGetSkin(&skin, flags);
 			e->SkinFetchState = SKIN_FETCH_DOWNLOADING;
@@ -399,6 +570,8 @@ static void Entity_CheckSkin(struct Entity* e) {
 static cc_bool CanDeleteTexture(struct Entity* except) {
 	int i;
 	if (!except->TextureId) return false;
+	/* Atlas pages are shared by many skins, and are only freed in SkinAtlas_Clear */
+	if (except->Flags & ENTITY_FLAG_SKIN_ATLAS) return false;
 
 	for (i = 0; i < ENTITIES_MAX_COUNT; i++)
 	{
@@ -481,6 +654,7 @@ static void Entities_ContextLost(void* obj) {
 		if (!Gfx.ManagedTextures)
 			DeleteSkin(entity);
 	}
+	if (!Gfx.ManagedTextures) SkinAtlas_Clear();
 }
 /* No OnContextCreated, skin textures remade when needed */
 
@@ -1149,6 +1323,7 @@ static void Entities_Free(void) {
 	{
 		Entities_Remove(i);
 	}
+	SkinAtlas_Clear();
 	sources_head = NULL;
 }
 
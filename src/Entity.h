@@ -101,6 +101,9 @@ struct EntityVTABLE {
 /* Whether in classic mode, to slightly adjust this entity downwards when rendering it */
 /*  to replicate the behaviour of the original vanilla classic client */
 #define ENTITY_FLAG_CLASSIC_ADJUST 0x04
+/* Whether this entity's skin is stored in a shared skin atlas page */
+/*  (i.e. TextureId refers to the atlas page, and uOffset/vOffset are valid) */
+#define ENTITY_FLAG_SKIN_ATLAS 0x08
 
 /* Contains a model, along with position, velocity, and rotation. May also contain other fields and properties. */
 struct Entity {
@@ -133,6 +136,8 @@ struct Entity {
 	/*  Current state is linearly interpolated between prev and next */
 	struct EntityLocation prev, next;
 	GfxResourceID ModelVB;
+	/* Offset of skin within TextureId (only valid when ENTITY_FLAG_SKIN_ATLAS is set) */
+	float uOffset, vOffset;
 };
 typedef cc_bool (*Entity_TouchesCondition)(BlockID block);
 
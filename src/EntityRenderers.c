@@ -280,7 +280,145 @@ void EntityShadows_Render(void) {
 *#########################################################################################################################*/
 static GfxResourceID names_VB;
 #define NAME_IS_EMPTY -30000
+#define NAME_IS_GLYPHS -30001 /* name is drawn using glyphs from names_fontTex */
 #define NAME_OFFSET 3 /* offset of back layer of name above an entity */
+#define NAME_SIZE 24  /* size of the font names are drawn with */
+
+/* Names are normally drawn using glyphs from a single shared default.png texture, */
+/*  with the name tags of all visible entities batched together into one draw call */
+static GfxResourceID names_fontTex;
+static cc_bool names_fontTexFailed;
+#ifdef CC_BUILD_LOWMEM
+#define NAMES_MAX_VERTICES 1024
+#else
+#define NAMES_MAX_VERTICES 4096
+#endif
+static struct VertexTextured names_vertices[NAMES_MAX_VERTICES];
+static int names_count;
+
+/* Returns whether names can be drawn using glyphs from the default.png texture */
+static cc_bool CheckNamesFontTexture(void) {
+	struct Bitmap* bmp;
+	if (names_fontTex)       return true;
+	if (names_fontTexFailed) return false;
+
+	bmp = Font_GetBitmapAtlas();
+	if (bmp && Gfx_CheckTextureSize(bmp->width, bmp->height, 0)) {
+		names_fontTex = Gfx_CreateTexture(bmp, TEXTURE_FLAG_MANAGED, false);
+	}
+
+	names_fontTexFailed = !names_fontTex;
+	return !names_fontTexFailed;
+}
+
+static void FreeNamesFontTexture(void) {
+	Gfx_DeleteTexture(&names_fontTex);
+	names_fontTexFailed = false;
+}
+
+static void FlushNames(void) {
+	if (!names_count) return;
+	if (!names_VB)
+		names_VB = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, NAMES_MAX_VERTICES);
+
+	Gfx_BindTexture(names_fontTex);
+	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
+	Gfx_SetDynamicVbData(names_VB, names_vertices, names_count);
+	Gfx_DrawVb_IndexedTris(names_count);
+	names_count = 0;
+}
+
+static void CalcNameSize(struct Entity* e) {
+	struct DrawTextArgs args;
+	struct FontDesc font;
+	cc_string name;
+	int width;
+
+	/* Names are always drawn using default.png font */
+	Font_MakeBitmapped(&font, NAME_SIZE, FONT_FLAGS_NONE);
+	/* Don't want DPI scaling or padding */
+	font.size = NAME_SIZE; font.height = NAME_SIZE;
+
+	name = String_FromRawArray(e->NameRaw);
+	DrawTextArgs_Make(&args, &name, &font, false);
+	width = Drawer2D_TextWidth(&args);
+
+	e->NameTex.ID = 0;
+	if (!width) {
+		e->NameTex.x = NAME_IS_EMPTY;
+	} else {
+		e->NameTex.x      = NAME_IS_GLYPHS;
+		e->NameTex.width  = width + NAME_OFFSET;
+		e->NameTex.height = NAME_SIZE + NAME_OFFSET;
+	}
+}
+
+/* Adds a quad for each character in the given name to names_vertices */
+/*  origin is top left of name tag, right/up are size of one pixel in world space */
+static void AddNameGlyphs(const cc_string* name, Vec3 origin, const Vec3* right, const Vec3* up, 
+						BitmapCol color, cc_bool shadow) {
+	struct VertexTextured* v = &names_vertices[names_count];
+	int xPadding = Drawer2D_XPadding(NAME_SIZE);
+	TextureRec rec;
+	PackedCol col;
+	Vec3 a, b;
+	int i, width, x = 0;
+	char c;
+
+	col = PackedCol_Make(BitmapCol_R(color), BitmapCol_G(color), BitmapCol_B(color), 255);
+	/* Bottom of glyph quads */
+	b.x = origin.x - up->x * NAME_SIZE; b.y = origin.y - up->y * NAME_SIZE; b.z = origin.z - up->z * NAME_SIZE;
+
+	for (i = 0; i < name->length; i++) 
+	{
+		c = name->buffer[i];
+		if (c == '&' && Drawer2D_ValidColorCodeAt(name, i + 1)) {
+			if (!shadow) color = Drawer2D_GetColor(name->buffer[i + 1]);
+			col = PackedCol_Make(BitmapCol_R(color), BitmapCol_G(color), BitmapCol_B(color), 255);
+			i++; continue; /* skip over the color code */
+		}
+
+		width = Font_GetBitmapGlyph(c, NAME_SIZE, &rec);
+		a.x = right->x * x;           a.y = right->y * x;           a.z = right->z * x;
+		x  += width;
+		v->x = b.x + a.x;      v->y = b.y + a.y;      v->z = b.z + a.z;      v->Col = col; v->U = rec.u1; v->V = rec.v2; v++;
+		v->x = origin.x + a.x; v->y = origin.y + a.y; v->z = origin.z + a.z; v->Col = col; v->U = rec.u1; v->V = rec.v1; v++;
+
+		a.x = right->x * x;           a.y = right->y * x;           a.z = right->z * x;
+		x  += xPadding;
+		v->x = origin.x + a.x; v->y = origin.y + a.y; v->z = origin.z + a.z; v->Col = col; v->U = rec.u2; v->V = rec.v1; v++;
+		v->x = b.x + a.x;      v->y = b.y + a.y;      v->z = b.z + a.z;      v->Col = col; v->U = rec.u2; v->V = rec.v2; v++;
+	}
+	names_count = (int)(v - names_vertices);
+}
+
+static void AddName(struct Entity* e, const Vec3* pos, const Vec2* size) {
+	struct Matrix* view = &Gfx.View;
+	BitmapCol shadowColor = BitmapCol_Make(80, 80, 80, 255);
+	Vec3 right, up, origin, shadowOrigin;
+	float scale;
+	cc_string name;
+
+	name = String_FromRawArray(e->NameRaw);
+	/* Each character needs 4 vertices in both the shadow and main layers */
+	if (names_count + name.length * 8 > NAMES_MAX_VERTICES) FlushNames();
+
+	scale   = size->x / e->NameTex.width;
+	right.x = view->row1.x * scale; right.y = view->row2.x * scale; right.z = view->row3.x * scale;
+	up.x    = view->row1.y * scale; up.y    = view->row2.y * scale; up.z    = view->row3.y * scale;
+
+	origin.x = pos->x - right.x * e->NameTex.width * 0.5f + up.x * e->NameTex.height;
+	origin.y = pos->y - right.y * e->NameTex.width * 0.5f + up.y * e->NameTex.height;
+	origin.z = pos->z - right.z * e->NameTex.width * 0.5f + up.z * e->NameTex.height;
+
+	/* Push shadow layer very slightly backwards, so it is always behind the main layer */
+	shadowOrigin.x = origin.x + (right.x - up.x) * NAME_OFFSET - view->row1.z * 0.001f;
+	shadowOrigin.y = origin.y + (right.y - up.y) * NAME_OFFSET - view->row2.z * 0.001f;
+	shadowOrigin.z = origin.z + (right.z - up.z) * NAME_OFFSET - view->row3.z * 0.001f;
+
+	AddNameGlyphs(&name, shadowOrigin, &right, &up, shadowColor, true);
+	AddNameGlyphs(&name, origin,       &right, &up, Drawer2D.Colors['f'], false);
+}
 
 static void MakeNameTexture(struct Entity* e) {
 	cc_string colorlessName; char colorlessBuffer[STRING_SIZE];
@@ -294,9 +432,9 @@ static void MakeNameTexture(struct Entity* e) {
 	cc_string name;
 
 	/* Names are always drawn using default.png font */
-	Font_MakeBitmapped(&font, 24, FONT_FLAGS_NONE);
+	Font_MakeBitmapped(&font, NAME_SIZE, FONT_FLAGS_NONE);
 	/* Don't want DPI scaling or padding */
-	font.size = 24; font.height = 24;
+	font.size = NAME_SIZE; font.height = NAME_SIZE;
 
 	name = String_FromRawArray(e->NameRaw);
 	DrawTextArgs_Make(&args, &name, &font, false);
@@ -332,17 +470,24 @@ static void DrawName(struct Entity* e) {
 	struct VertexTextured* vertices;
 	struct Model* model;
 	struct Matrix mat, transform;
+	cc_bool glyphs;
 	Vec3 pos;
 	float scale;
 	Vec2 size;
 
 	if (!e->VTABLE->ShouldRenderName(e)) return;
 	if (e->NameTex.x == NAME_IS_EMPTY)   return;
-	if (!e->NameTex.ID) MakeNameTexture(e);
-	Gfx_BindTexture(e->NameTex.ID);
+	glyphs = CheckNamesFontTexture();
 
-	if (!names_VB)
-		names_VB = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, 4);
+	/* Name may have been measured/made using the other method */
+	if (glyphs != (e->NameTex.x == NAME_IS_GLYPHS)) EntityNames_Delete(e);
+
+	if (glyphs) {
+		if (!e->NameTex.x) CalcNameSize(e);
+	} else {
+		if (!e->NameTex.ID) MakeNameTexture(e);
+	}
+	if (e->NameTex.x == NAME_IS_EMPTY) return;
 
 	model = e->Model;
 	Model_GetEntityTransform(model, e, &transform);
@@ -359,6 +504,11 @@ static void DrawName(struct Entity* e) {
 		size.x *= scale * 0.2f; size.y *= scale * 0.2f;
 	}
 
+	if (glyphs) { AddName(e, &pos, &size); return; }
+	Gfx_BindTexture(e->NameTex.ID);
+
+	if (!names_VB)
+		names_VB = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, NAMES_MAX_VERTICES);
 	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
 
 	vertices = (struct VertexTextured*)Gfx_LockDynamicVb(names_VB, VERTEX_FORMAT_TEXTURED, 4);
@@ -397,6 +547,7 @@ void EntityNames_Render(void) {
 		if (!Entities.List[i]) continue;
 		if (i != closestEntityId) DrawName(Entities.List[i]);
 	}
+	FlushNames();
 
 	Gfx_SetAlphaTest(false);
 	if (hadFog) Gfx_SetFog(true);
@@ -433,6 +584,7 @@ void EntityNames_RenderHovered(void) {
 	}
 
 	if (!setupState) return;
+	FlushNames();
 	Gfx_SetAlphaTest(false);
 	Gfx_SetDepthTest(true);
 	Gfx_SetDepthWrite(true);
@@ -449,6 +601,7 @@ static void DeleteAllNameTextures(void) {
 }
 
 static void EntityNames_ChatFontChanged(void* obj) {
+	FreeNamesFontTexture();
 	DeleteAllNameTextures();
 }
 
@@ -461,6 +614,7 @@ static void EntityRenderers_ContextLost(void* obj) {
 	Gfx_DeleteDynamicVb(&shadows_VB);
 	
 	Gfx_DeleteDynamicVb(&names_VB);
+	FreeNamesFontTexture();
 	DeleteAllNameTextures();
 }
 
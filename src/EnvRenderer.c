@@ -402,6 +402,16 @@ static float GetRainHeight(int x, int z) {
 	return y == -1 ? 0 : y + Blocks.MaxBB[World_GetBlock(x, y, z)].y;
 }
 
+int Weather_GetColumnHeight(int x, int z) {
+	int hIndex, height;
+	if (!Weather_Heightmap) 
+		InitWeatherHeightmap();
+
+	hIndex = Weather_Pack(x, z);
+	height = Weather_Heightmap[hIndex];
+	return height == Int16_MaxValue ? CalcRainHeightAt(x, World.MaxY, z, hIndex) : height;
+}
+
 void EnvRenderer_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock) {
 	cc_bool didBlock = !(Blocks.Draw[oldBlock] == DRAW_GAS || Blocks.Draw[oldBlock] == DRAW_SPRITE);
 	cc_bool nowBlock = !(Blocks.Draw[newBlock] == DRAW_GAS || Blocks.Draw[newBlock] == DRAW_SPRITE);
@@ -30,6 +30,9 @@ void EnvRenderer_RenderSkybox(void);
 cc_bool EnvRenderer_ShouldRenderSkybox(void);
 
 extern cc_int16* Weather_Heightmap;
+/* Returns y of the highest block in the given column that rain cannot fall through, or -1 if none. */
+/* NOTE: x and z must be inside the world. */
+int Weather_GetColumnHeight(int x, int z);
 /* Called when a block is changed to update internal weather state. */
 void EnvRenderer_OnBlockChanged(int x, int y, int z, BlockID oldBlock, BlockID newBlock);
 /* Renders rainfall/snowfall weather. */
@@ -138,5 +138,6 @@ enum CC_ERRORS {
 	SSL_ERR_CONTEXT_DEAD = 0xCCDED070UL, /* Server shutdown the SSL context and it must be recreated */
 	PNG_ERR_16BITSAMPLES = 0xCCDED071UL, /* Image uses 16 bit samples, which is unimplemented */
 	ERR_NO_NETWORKING    = 0xCCDED072UL, /* No working network connection */
+	ZIP_ERR_FILE_TOO_LARGE = 0xCCDED073UL, /* ZIP entry is too large to be extracted into memory */
 };
 #endif
@@ -12,6 +12,7 @@
 #include "ExtMath.h"
 #include "Options.h"
 #include "Queue.h"
+#include "Profiler.h"
 
 struct LightNode {
 	IVec3 coords; /* 12 bytes */
@@ -226,6 +227,7 @@ static void FlushLightQueue(cc_bool isLamp, cc_bool refreshChunk) {
 	struct LightNode ln;
 	cc_uint8 brightnessHere;
 	BlockID thisBlock;
+	Profiler_BeginZone("FlushLightQueue");
 
 	while (lightQueue.count > 0) {
 		ln = *(struct LightNode*)(Queue_Dequeue(&lightQueue));
@@ -259,6 +261,7 @@ static void FlushLightQueue(cc_bool isLamp, cc_bool refreshChunk) {
 		ln.coords.z += 2;
 		Light_TrySpreadInto(z, Z, < , World.MaxZ, isLamp, MIN, MAX)
 	}
+	Profiler_EndZone();
 }
 
 cc_uint8 GetBlockBrightness(BlockID curBlock, cc_bool isLamp) {
@@ -41,6 +41,9 @@
 #include "SystemFonts.h"
 #include "Formats.h"
 #include "EntityRenderers.h"
+#include "Bitmap.h"
+#include "Errors.h"
+#include "Profiler.h"
 
 struct _GameData Game;
 static cc_uint64 frameStart;
@@ -426,6 +429,9 @@ static void Game_Load(void) {
 	Event_Register_(&WindowEvents.Closing,         NULL, Game_PendingClose);
 	Event_Register_(&WindowEvents.InactiveChanged, NULL, HandleInactiveChanged);
 
+#ifdef CC_BUILD_PROFILER
+	Game_AddComponent(&Profiler_Component);
+#endif
 	Game_AddComponent(&World_Component);
 	Game_AddComponent(&Textures_Component);
 	Game_AddComponent(&Input_Component);
@@ -518,15 +524,23 @@ static void Render3DFrame(float delta, float t) {
 
 	if (EnvRenderer_ShouldRenderSkybox()) EnvRenderer_RenderSkybox();
 	AxisLinesRenderer_Render();
+	Profiler_BeginZone("Entities");
 	Entities_RenderModels(delta, t);
 	EntityNames_Render();
+	Profiler_EndZone();
 
+	Profiler_BeginZone("Particles and sky");
 	Particles_Render(t);
 	EnvRenderer_RenderSky();
 	EnvRenderer_RenderClouds();
+	Profiler_EndZone();
 
+	Profiler_BeginZone("MapRenderer_Update");
 	MapRenderer_Update(delta);
+	Profiler_EndZone();
+	Profiler_BeginZone("MapRenderer_RenderNormal");
 	MapRenderer_RenderNormal(delta);
+	Profiler_EndZone();
 	EnvRenderer_RenderMapSides();
 
 	EntityShadows_Render();
@@ -536,6 +550,7 @@ static void Render3DFrame(float delta, float t) {
 
 	/* Render water over translucent blocks when under the water outside the map for proper alpha blending */
 	pos = Camera.CurrentPos;
+	Profiler_BeginZone("MapRenderer_RenderTranslucent");
 	if (pos.y < Env.EdgeHeight && (pos.x < 0 || pos.z < 0 || pos.x > World.Width || pos.z > World.Length)) {
 		MapRenderer_RenderTranslucent(delta);
 		EnvRenderer_RenderMapEdges();
@@ -543,6 +558,7 @@ static void Render3DFrame(float delta, float t) {
 		EnvRenderer_RenderMapEdges();
 		MapRenderer_RenderTranslucent(delta);
 	}
+	Profiler_EndZone();
 
 	/* Need to render again over top of translucent block, as the selection outline */
 	/* is drawn without writing to the depth buffer */
@@ -572,6 +588,7 @@ static void PerformScheduledTasks(double time) {
 	struct ScheduledTask* task;
 	int i;
 
+	Profiler_BeginZone("PerformScheduledTasks");
 	for (i = 0; i < tasksCount; i++) {
 		task = &tasks[i];
 		task->accumulator += time;
@@ -581,12 +598,196 @@ static void PerformScheduledTasks(double time) {
 			task->accumulator -= task->interval;
 		}
 	}
+	Profiler_EndZone();
+}
+
+static void MakeScreenshotName(cc_string* filename) {
+	struct cc_datetime now;
+	DateTime_CurrentLocal(&now);
+
+	String_Format3(filename, "screenshot_%p4-%p2-%p2", &now.year, &now.month, &now.day);
+	String_Format3(filename, "-%p2-%p2-%p2.png", &now.hour, &now.minute, &now.second);
+}
+
+#ifdef CC_BUILD_ASYNCSCREENSHOT
+/* The frame is only copied out on the main thread (see Png_SetCapture), and is then compressed */
+/*  and saved by a background thread. This avoids a noticeable hitch when taking large screenshots. */
+static const char* const screenshotModes[] = { "normal", "fast", "small" };
+
+struct ScreenshotJob {
+	struct ScreenshotJob* next;
+	struct Bitmap bmp;   /* Copy of the frame */
+	int mode;            /* PngEncodeMode to compress with */
+	cc_bool saving, saved;
+	cc_result res;
+	const char* action;  /* What was being done when saving failed */
+	cc_string path;     char pathBuffer[FILENAME_SIZE];
+	cc_string filename; char filenameBuffer[STRING_SIZE];
+};
+
+static void* shotMutex;
+static void* shotWaitable;
+static void* shotThread;
+static cc_bool shotsStopping;
+/* Jobs are reported in chat by the main thread in the order they were queued in */
+static struct ScreenshotJob* shotsHead;
+static struct ScreenshotJob* shotsTail;
+
+static void SaveScreenshot(struct ScreenshotJob* job) {
+	struct Stream stream;
+	cc_result res;
+
+	res = Stream_CreateFile(&stream, &job->path);
+	if (res) { job->res = res; job->action = "creating"; return; }
+
+	res = Png_Encode2(&job->bmp, &stream, NULL, false, NULL, job->mode);
+	if (res) {
+		job->res = res; job->action = "saving to"; stream.Close(&stream); return;
+	}
+
+	res = stream.Close(&stream);
+	if (res) { job->res = res; job->action = "closing"; }
+}
+
+static void ScreenshotWorkerLoop(void) {
+	struct ScreenshotJob* job;
+	cc_bool stopping;
+	Profiler_NameThread("Screenshots");
+
+	for (;;)
+	{
+		Mutex_Lock(shotMutex);
+		{
+			for (job = shotsHead; job && job->saving; job = job->next) { }
+			if (job) job->saving = true;
+			stopping = shotsStopping;
+		}
+		Mutex_Unlock(shotMutex);
+
+		if (!job) {
+			if (stopping) break;
+			/* Block until the main thread queues another screenshot */
+			Waitable_Wait(shotWaitable); continue;
+		}
+
+		Profiler_BeginZone("SaveScreenshot");
+		SaveScreenshot(job);
+		Profiler_EndZone();
+		Mem_Free(job->bmp.scan0);
+		job->bmp.scan0 = NULL;
+
+		Mutex_Lock(shotMutex);
+		{
+			job->saved = true;
+		}
+		Mutex_Unlock(shotMutex);
+	}
+	Profiler_EndThread();
+}
+
+static void ReportScreenshots(struct ScheduledTask* task) {
+	struct ScreenshotJob* job;
+
+	for (;;)
+	{
+		Mutex_Lock(shotMutex);
+		{
+			job = shotsHead;
+			if (job && job->saved) { shotsHead = job->next; } 
+			else { job = NULL; }
+		}
+		Mutex_Unlock(shotMutex);
+		if (!job) return;
+
+		if (job->res) {
+			Logger_SysWarn2(job->res, job->action, &job->path);
+		} else {
+			Chat_Add1("&eTaken screenshot as: %s", &job->filename);
+#ifdef CC_BUILD_MOBILE
+			Platform_ShareScreenshot(&job->filename);
+#endif
+		}
+		Mem_Free(job);
+	}
+}
+
+static void InitScreenshotWorker(void) {
+	if (shotThread) return;
+	shotMutex    = Mutex_Create("Screenshot jobs");
+	shotWaitable = Waitable_Create("Screenshot wakeup");
+
+	Thread_Run(&shotThread, ScreenshotWorkerLoop, 256 * 1024, "Screenshots");
+	ScheduledTask_Add(GAME_DEF_TICKS, ReportScreenshots);
+}
+
+/* Waits for any queued screenshots to finish being saved */
+static void FreeScreenshotWorker(void) {
+	struct ScreenshotJob* job;
+	if (!shotThread) return;
+
+	Mutex_Lock(shotMutex);
+	{
+		shotsStopping = true;
+	}
+	Mutex_Unlock(shotMutex);
+
+	Waitable_Signal(shotWaitable);
+	Thread_Join(shotThread);
+
+	while ((job = shotsHead)) {
+		shotsHead = job->next;
+		Mem_Free(job);
+	}
+	shotsTail = NULL;
+	Mutex_Free(shotMutex);
+	Waitable_Free(shotWaitable);
+
+	shotThread    = NULL;
+	shotsStopping = false;
 }
 
+void Game_TakeScreenshot(void) {
+	struct ScreenshotJob* job;
+	struct Stream stream;
+	cc_result res;
+
+	Game_ScreenshotRequested = false;
+	if (!Utils_EnsureDirectory("screenshots")) return;
+
+	job = (struct ScreenshotJob*)Mem_TryAllocCleared(1, sizeof(struct ScreenshotJob));
+	if (!job) { Logger_SysWarn(ERR_OUT_OF_MEMORY, "taking screenshot"); return; }
+
+	String_InitArray(job->filename, job->filenameBuffer);
+	MakeScreenshotName(&job->filename);
+	String_InitArray(job->path, job->pathBuffer);
+	String_Format1(&job->path, "screenshots/%s", &job->filename);
+	job->mode = Options_GetEnum(OPT_SCREENSHOT_MODE, PNG_ENCODE_NORMAL, 
+								screenshotModes, Array_Elems(screenshotModes));
+
+	/* Backend only copies the frame into job->bmp, so stream is never written to */
+	Stream_Init(&stream);
+	Png_SetCapture(&job->bmp);
+	res = Gfx_TakeScreenshot(&stream);
+	Png_SetCapture(NULL);
+
+	if (!res && !job->bmp.scan0) res = ERR_NOT_SUPPORTED;
+	if (res) {
+		Logger_SysWarn2(res, "saving to", &job->path);
+		Mem_Free(job->bmp.scan0); Mem_Free(job); return;
+	}
+
+	InitScreenshotWorker();
+	Mutex_Lock(shotMutex);
+	{
+		LinkedList_Append(job, shotsHead, shotsTail);
+	}
+	Mutex_Unlock(shotMutex);
+	Waitable_Signal(shotWaitable);
+}
+#else
 void Game_TakeScreenshot(void) {
 	cc_string filename; char fileBuffer[STRING_SIZE];
 	cc_string path;     char pathBuffer[FILENAME_SIZE];
-	struct cc_datetime now;
 	cc_result res;
 #ifdef CC_BUILD_WEB
 	cc_filepath str;
@@ -594,11 +795,8 @@ void Game_TakeScreenshot(void) {
 	struct Stream stream;
 #endif
 	Game_ScreenshotRequested = false;
-	DateTime_CurrentLocal(&now);
-
 	String_InitArray(filename, fileBuffer);
-	String_Format3(&filename, "screenshot_%p4-%p2-%p2", &now.year, &now.month, &now.day);
-	String_Format3(&filename, "-%p2-%p2-%p2.png", &now.hour, &now.minute, &now.second);
+	MakeScreenshotName(&filename);
 
 #ifdef CC_BUILD_WEB
 	extern void interop_TakeScreenshot(const char* path);
@@ -626,6 +824,7 @@ void Game_TakeScreenshot(void) {
 #endif
 #endif
 }
+#endif
 
 
 #ifdef CC_BUILD_WEB
@@ -688,6 +887,7 @@ static CC_INLINE void Game_DrawFrame(float delta, float t) {
 		RayTracer_SetInvalid(&Game_SelectedPos);
 	}
 
+	Profiler_BeginZone("Gui_RenderGui");
 	Gfx_Begin2D(Game.Width, Game.Height);
 	Gui_RenderGui(delta);
 	for (i = 0; i < Array_Elems(Game.Draw2DHooks); i++)
@@ -704,6 +904,7 @@ static CC_INLINE void Game_DrawFrame(float delta, float t) {
 	}
 #endif
 	Gfx_End2D();
+	Profiler_EndZone();
 }
 
 #ifdef CC_BUILD_SPLITSCREEN
@@ -760,6 +961,7 @@ static CC_INLINE void Game_RenderFrame(void) {
 		}
 	}
 
+	Profiler_BeginZone("Frame");
 	Gfx_BeginFrame();
 	Gfx_BindIb(Gfx.DefaultIb);
 	Game.Time += deltaD;
@@ -797,7 +999,7 @@ static CC_INLINE void Game_RenderFrame(void) {
 	AudioBackend_Tick();
 
 	/* TODO: Not calling Gfx_EndFrame doesn't work with Direct3D9 */
-	if (Window_Main.Inactive) return;
+	if (Window_Main.Inactive) { Profiler_EndZone(); return; }
 	Gfx_ClearBuffers(GFX_BUFFER_COLOR | GFX_BUFFER_DEPTH);
 	
 #ifdef CC_BUILD_SPLITSCREEN
@@ -825,7 +1027,10 @@ static CC_INLINE void Game_RenderFrame(void) {
 #endif
 
 	if (Game_ScreenshotRequested) Game_TakeScreenshot();
+	Profiler_BeginZone("Gfx_EndFrame");
 	Gfx_EndFrame();
+	Profiler_EndZone();
+	Profiler_EndZone();
 	if (gfx_minFrameMs) LimitFPS();
 }
 
@@ -837,6 +1042,9 @@ static void Game_Free(void) {
 	Gfx.ManagedTextures = false;
 	Event_UnregisterAll();
 	tasksCount = 0;
+#ifdef CC_BUILD_ASYNCSCREENSHOT
+	FreeScreenshotWorker();
+#endif
 
 	for (comp = comps_head; comp; comp = comp->next)
 	{
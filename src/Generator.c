@@ -7,6 +7,7 @@
 #include "Utils.h"
 #include "Game.h"
 #include "Window.h"
+#include "Profiler.h"
 
 const struct MapGenerator* Gen_Active;
 BlockRaw* Gen_Blocks;
@@ -65,7 +66,11 @@ cc_bool Gen_IsDone(void) {
 #define GEN_COOP_END
 
 static void Gen_DoGen(void) {
+	Profiler_NameThread("Map gen");
+	Profiler_BeginZone("Generate");
 	Gen_Active->Generate();
+	Profiler_EndZone();
+	Profiler_EndThread();
 }
 
 static void Gen_Run(void) {
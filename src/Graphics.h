@@ -28,11 +28,12 @@ struct MenuOptionsScreen;
 extern struct IGameComponent Gfx_Component;
 
 typedef enum VertexFormat_ {
-	VERTEX_FORMAT_COLOURED, VERTEX_FORMAT_TEXTURED
+	VERTEX_FORMAT_COLOURED, VERTEX_FORMAT_TEXTURED, VERTEX_FORMAT_CHUNK
 } VertexFormat;
 
 #define SIZEOF_VERTEX_COLOURED 16
 #define SIZEOF_VERTEX_TEXTURED 24
+#define SIZEOF_VERTEX_CHUNK    12
 
 #if defined CC_BUILD_PSP
 /* 3 floats for position (XYZ), 4 bytes for colour */
@@ -46,6 +47,14 @@ struct VertexColoured { float x, y, z; PackedCol Col; };
 struct VertexTextured { float x, y, z; PackedCol Col; float U, V; };
 #endif
 
+/* Compact vertex format only used for chunk meshes, when CC_BUILD_COMPACTCHUNKS is defined */
+/* Position is in 1/256 block units, relative to origin set by Gfx_SetChunkOrigin */
+/* U is in 1/2048 units, V is in 1/65536 units, colour is packed as RGB565 */
+struct VertexChunk { cc_int16 x, y, z; cc_uint16 col; cc_uint16 u, v; };
+#define VERTEXCHUNK_POS_SCALE 256.0f
+#define VERTEXCHUNK_U_SCALE   2048.0f
+#define VERTEXCHUNK_V_SCALE   65536.0f
+
 void Gfx_Create(void);
 void Gfx_Free(void);
 
@@ -323,6 +332,10 @@ CC_API void  Gfx_UnlockDynamicVb(GfxResourceID vb);
 
 /* Updates the data of a dynamic vertex buffer */
 CC_API void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount);
+#ifdef CC_BUILD_CHUNKARENA
+/* Updates only the given range of vertices in a dynamic vertex buffer */
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount);
+#endif
 
 
 /*########################################################################################################################*
@@ -349,6 +362,15 @@ CC_API void Gfx_DrawVb_IndexedTris_Range(int verticesCount, int startVertex);
 CC_API void Gfx_DrawVb_IndexedTris(int verticesCount);
 /* Special case Gfx_DrawVb_IndexedTris_Range for map renderer */
 void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex);
+#ifdef CC_BUILD_COMPACTCHUNKS
+/* Sets the world position that the positions of VERTEX_FORMAT_CHUNK vertices are relative to */
+void Gfx_SetChunkOrigin(float x, float y, float z);
+#endif
+#ifdef CC_BUILD_CHUNKARENA
+/* Special case Gfx_DrawIndexedTris_T2fC4b that draws multiple ranges in one batch */
+/* NOTE: startVertex + verticesCount of every range must be <= GFX_MAX_VERTICES */
+void Gfx_DrawIndexedTris_T2fC4b_Multi(const int* verticesCounts, const int* startVertices, int rangesCount);
+#endif
 
 
 /*########################################################################################################################*
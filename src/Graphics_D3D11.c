@@ -248,8 +248,10 @@ static void Gfx_RestoreState(void) {
 *---------------------------------------------------------Textures--------------------------------------------------------*
 *#########################################################################################################################*/
 static void D3D11_DoMipmaps(ID3D11Resource* texture, int x, int y, struct Bitmap* bmp, int rowWidth) {
+	BitmapCol buffer[MIPMAPS_FAST_SIZE];
+	BitmapCol* data = AllocMipmaps(bmp, buffer);
 	BitmapCol* prev = bmp->scan0;
-	BitmapCol* cur;
+	BitmapCol* cur  = data;
 
 	int lvls = CalcMipmapsLevels(bmp->width, bmp->height);
 	int lvl, width = bmp->width, height = bmp->height;
@@ -260,7 +262,6 @@ static void D3D11_DoMipmaps(ID3D11Resource* texture, int x, int y, struct Bitmap
 		if (width > 1)  width  /= 2;
 		if (height > 1) height /= 2;
 
-		cur = (BitmapCol*)Mem_Alloc(width * height, BITMAPCOLOR_SIZE, "mipmaps");
 		GenMipmaps(width, height, cur, prev, rowWidth);
 
 		D3D11_BOX box;
@@ -276,11 +277,11 @@ static void D3D11_DoMipmaps(ID3D11Resource* texture, int x, int y, struct Bitmap
 		int stride = width * 4;
 		ID3D11DeviceContext_UpdateSubresource(context, texture, lvl, &box, cur, stride, stride * height);
 
-		if (prev != bmp->scan0) Mem_Free(prev);
 		prev     = cur;
+		cur     += width * height;
 		rowWidth = width;
 	}
-	if (prev != bmp->scan0) Mem_Free(prev);
+	FreeMipmaps(data, buffer);
 }
 
 GfxResourceID Gfx_AllocTexture(struct Bitmap* bmp, int rowWidth, cc_uint8 flags, cc_bool mipmaps) {
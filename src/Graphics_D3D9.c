@@ -276,8 +276,10 @@ static void D3D9_SetTexturePartData(IDirect3DTexture9* texture, int x, int y, co
 }
 
 static void D3D9_DoMipmaps(IDirect3DTexture9* texture, int x, int y, struct Bitmap* bmp, int rowWidth, cc_bool partial) {
+	BitmapCol buffer[MIPMAPS_FAST_SIZE];
+	BitmapCol* data = AllocMipmaps(bmp, buffer);
 	BitmapCol* prev = bmp->scan0;
-	BitmapCol* cur;
+	BitmapCol* cur  = data;
 	struct Bitmap mipmap;
 
 	int lvls = CalcMipmapsLevels(bmp->width, bmp->height);
@@ -288,7 +290,6 @@ static void D3D9_DoMipmaps(IDirect3DTexture9* texture, int x, int y, struct Bitm
 		if (width > 1)  width /= 2;
 		if (height > 1) height /= 2;
 
-		cur = (BitmapCol*)Mem_Alloc(width * height, BITMAPCOLOR_SIZE, "mipmaps");
 		GenMipmaps(width, height, cur, prev, rowWidth);
 
 		Bitmap_Init(mipmap, width, height, cur);
@@ -298,11 +299,11 @@ static void D3D9_DoMipmaps(IDirect3DTexture9* texture, int x, int y, struct Bitm
 			D3D9_SetTextureData(texture, &mipmap, width, lvl);
 		}
 
-		if (prev != bmp->scan0) Mem_Free(prev);
 		prev     = cur;
+		cur     += width * height;
 		rowWidth = width;
 	}
-	if (prev != bmp->scan0) Mem_Free(prev);
+	FreeMipmaps(data, buffer);
 }
 
 static cc_bool D3D9_CheckResult(cc_result res, const char* func) {
@@ -251,6 +251,15 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 	_glBindBuffer(GL_ARRAY_BUFFER, vb);
 	_glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices);
 }
+
+#ifdef CC_BUILD_CHUNKARENA
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	cc_uint32 offset = startVertex * strideSizes[fmt];
+	cc_uint32 size   = vCount      * strideSizes[fmt];
+	_glBindBuffer(GL_ARRAY_BUFFER, vb);
+	_glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices);
+}
+#endif
 #else
 static GfxResourceID Gfx_AllocDynamicVb(VertexFormat fmt, int maxVertices) {
 	return (GfxResourceID)Mem_TryAlloc(maxVertices, strideSizes[fmt]);
@@ -365,6 +374,18 @@ void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex) {
 	_glTexCoordPointer(2, GL_FLOAT,      SIZEOF_VERTEX_TEXTURED, VB_PTR + offset + 16);
 	_glDrawElements(GL_TRIANGLES,        ICOUNT(verticesCount),  GL_UNSIGNED_SHORT, IB_PTR);
 }
+
+#ifdef CC_BUILD_CHUNKARENA
+/* Vertex pointers have to be changed for each range anyways, since the fallback */
+/*  OpenGL 1.0 implementation of glDrawElements ignores the indices offset */
+void Gfx_DrawIndexedTris_T2fC4b_Multi(const int* verticesCounts, const int* startVertices, int rangesCount) {
+	int i;
+	for (i = 0; i < rangesCount; i++)
+	{
+		Gfx_DrawIndexedTris_T2fC4b(verticesCounts[i], startVertices[i]);
+	}
+}
+#endif
 #endif /* !CC_BUILD_GL11 */
 
 
@@ -559,7 +580,7 @@ static void APIENTRY legacy_bufferData(GLenum target, cc_uintptr size, const GLv
 
 static void APIENTRY legacy_bufferSubData(GLenum target, cc_uintptr offset, cc_uintptr size, const GLvoid* data) {
 	legacy_buffer* buffer = *legacy_GetBuffer(target);
-	Mem_Copy(buffer->data, data, size);
+	Mem_Copy((cc_uint8*)buffer->data + offset, data, size);
 }
 
 
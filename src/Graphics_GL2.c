@@ -52,6 +52,13 @@ static int postProcess;
 enum PostProcess { POSTPROCESS_NONE, POSTPROCESS_GRAYSCALE };
 static const char* const postProcess_Names[2] = { "NONE", "GRAYSCALE" };
 
+#ifdef CC_BUILD_CHUNKARENA
+/* Core since OpenGL 1.4, but not supported by OpenGL ES 2.0 or WebGL */
+typedef void (APIENTRY *FP_glMultiDrawElements)(GLenum mode, const GLsizei* count, GLenum type, 
+												const void* const* indices, GLsizei drawcount);
+static FP_glMultiDrawElements _glMultiDrawElements;
+#endif
+
 
 /*########################################################################################################################*
 *-------------------------------------------------------Index buffers-----------------------------------------------------*
@@ -148,6 +155,15 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 	glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices);
 }
 
+#ifdef CC_BUILD_CHUNKARENA
+void Gfx_SetDynamicVbRange(GfxResourceID vb, VertexFormat fmt, void* vertices, int startVertex, int vCount) {
+	cc_uint32 offset = startVertex * strideSizes[fmt];
+	cc_uint32 size   = vCount      * strideSizes[fmt];
+	glBindBuffer(GL_ARRAY_BUFFER, ptr_to_uint(vb));
+	glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices);
+}
+#endif
+
 
 /*########################################################################################################################*
 *------------------------------------------------------OpenGL modern------------------------------------------------------*
@@ -158,6 +174,7 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 #define FTR_LINEAR_FOG (1 << 3)
 #define FTR_DENSIT_FOG (1 << 4)
 #define FTR_HASANY_FOG (FTR_LINEAR_FOG | FTR_DENSIT_FOG)
+#define FTR_CHUNK_VERT (1 << 5)
 #define FTR_FS_MEDIUMP (1 << 7)
 
 #define UNI_MVP_MATRIX (1 << 0)
@@ -165,7 +182,8 @@ void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, int vCount) {
 #define UNI_FOG_COL    (1 << 2)
 #define UNI_FOG_END    (1 << 3)
 #define UNI_FOG_DENS   (1 << 4)
-#define UNI_MASK_ALL   0x1F
+#define UNI_CHUNK_POS  (1 << 5)
+#define UNI_MASK_ALL   0x3F
 
 /* cached uniforms (cached for multiple programs */
 static struct Matrix _view, _proj, _mvp;
@@ -174,14 +192,15 @@ static float _texX, _texY;
 static PackedCol gfx_fogColor;
 static float gfx_fogEnd = -1.0f, gfx_fogDensity = -1.0f;
 static int gfx_fogMode = -1;
+static float _chunkX, _chunkY, _chunkZ;
 
 /* shader programs (emulate fixed function) */
 static struct GLShader {
 	int features;     /* what features are enabled for this shader */
 	int uniforms;     /* which associated uniforms need to be resent to GPU */
 	GLuint program;   /* OpenGL program ID (0 if not yet compiled) */
-	int locations[5]; /* location of uniforms (not constant) */
-} shaders[6 * 3] = {
+	int locations[6]; /* location of uniforms (not constant) */
+} shaders[6 * 3 + 2 * 3] = {
 	/* no fog */
 	{ 0              },
 	{ 0              | FTR_ALPHA_TEST },
@@ -203,6 +222,13 @@ static struct GLShader {
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_ALPHA_TEST },
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_TEX_OFFSET },
 	{ FTR_DENSIT_FOG | FTR_TEXTURE_UV | FTR_TEX_OFFSET | FTR_ALPHA_TEST },
+	/* compact chunk vertices */
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_ALPHA_TEST },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_LINEAR_FOG },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_LINEAR_FOG | FTR_ALPHA_TEST },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_DENSIT_FOG },
+	{ FTR_CHUNK_VERT | FTR_TEXTURE_UV | FTR_DENSIT_FOG | FTR_ALPHA_TEST },
 };
 static struct GLShader* gfx_activeShader;
 
@@ -211,6 +237,25 @@ static void GenVertexShader(const struct GLShader* shader, cc_string* dst) {
 	int uv = shader->features & FTR_TEXTURE_UV;
 	int tm = shader->features & FTR_TEX_OFFSET;
 
+	/* See VertexChunk in Graphics.h for how the compact chunk vertex is packed */
+	if (shader->features & FTR_CHUNK_VERT) {
+		String_AppendConst(dst, "attribute vec3 in_pos;\n");
+		String_AppendConst(dst, "attribute float in_col;\n");
+		String_AppendConst(dst, "attribute vec2 in_uv;\n");
+		String_AppendConst(dst, "varying vec4 out_col;\n");
+		String_AppendConst(dst, "varying vec2 out_uv;\n");
+		String_AppendConst(dst, "uniform mat4 mvp;\n");
+		String_AppendConst(dst, "uniform vec3 chunkPos;\n");
+
+		String_AppendConst(dst, "void main() {\n");
+		String_AppendConst(dst, "  gl_Position = mvp * vec4(in_pos * (1.0 / 256.0) + chunkPos, 1.0);\n");
+		String_AppendConst(dst, "  out_col = vec4(floor(in_col / 2048.0) / 31.0, mod(floor(in_col / 32.0), 64.0) / 63.0,\n");
+		String_AppendConst(dst, "                 mod(in_col, 32.0) / 31.0, 1.0);\n");
+		String_AppendConst(dst, "  out_uv  = in_uv * vec2(1.0 / 2048.0, 1.0 / 65536.0);\n");
+		String_AppendConst(dst, "}");
+		return;
+	}
+
 	String_AppendConst(dst,         "attribute vec3 in_pos;\n");
 	String_AppendConst(dst,         "attribute vec4 in_col;\n");
 	if (uv) String_AppendConst(dst, "attribute vec2 in_uv;\n");
@@ -358,6 +403,7 @@ static void CompileProgram(struct GLShader* shader) {
 		shader->locations[2] = glGetUniformLocation(program, "fogCol");
 		shader->locations[3] = glGetUniformLocation(program, "fogEnd");
 		shader->locations[4] = glGetUniformLocation(program, "fogDensity");
+		shader->locations[5] = glGetUniformLocation(program, "chunkPos");
 		return;
 	}
 	temp = 0;
@@ -407,6 +453,10 @@ static void ReloadUniforms(void) {
 		glUniform1f(s->locations[4], -gfx_fogDensity);
 		s->uniforms &= ~UNI_FOG_DENS;
 	}
+	if ((s->uniforms & UNI_CHUNK_POS) && (s->features & FTR_CHUNK_VERT)) {
+		glUniform3f(s->locations[5], _chunkX, _chunkY, _chunkZ);
+		s->uniforms &= ~UNI_CHUNK_POS;
+	}
 }
 
 /* Switches program to one that duplicates current fixed function state */
@@ -420,8 +470,13 @@ static void SwitchProgram(void) {
 		if (gfx_fogMode >= 1) index += 6; /* exp fog */
 	}
 
-	if (gfx_format == VERTEX_FORMAT_TEXTURED) index += 2;
-	if (gfx_texTransform) index += 2;
+	if (gfx_format == VERTEX_FORMAT_CHUNK) {
+		/* compact chunk shaders are after all the fixed function emulation shaders */
+		index = 6 * 3 + index / 3;
+	} else {
+		if (gfx_format == VERTEX_FORMAT_TEXTURED) index += 2;
+		if (gfx_texTransform) index += 2;
+	}
 	if (gfx_alphaTest)    index += 1;
 
 	shader = &shaders[index];
@@ -517,6 +572,15 @@ void Gfx_DisableTextureOffset(void) {
 	SwitchProgram();
 }
 
+#ifdef CC_BUILD_COMPACTCHUNKS
+void Gfx_SetChunkOrigin(float x, float y, float z) {
+	if (x == _chunkX && y == _chunkY && z == _chunkZ) return;
+	_chunkX = x; _chunkY = y; _chunkZ = z;
+	DirtyUniform(UNI_CHUNK_POS);
+	ReloadUniforms();
+}
+#endif
+
 
 /*########################################################################################################################*
 *-------------------------------------------------------State setup-------------------------------------------------------*
@@ -551,6 +615,9 @@ static void GLBackend_Init(void) {
     customMipmapsLevels = true;
     const GLubyte* ver  = glGetString(GL_VERSION);
     int major = ver[0] - '0', minor = ver[2] - '0';
+#ifdef CC_BUILD_CHUNKARENA
+    if (major >= 2) _glMultiDrawElements = (FP_glMultiDrawElements)GLContext_GetAddress("glMultiDrawElements");
+#endif
     if (major >= 2) return;
 
     // OpenGL 1.x.. will likely either not work or perform poorly
@@ -660,6 +727,14 @@ static void GL_SetupVbTextured_Range(int startVertex) {
 	glVertexAttribPointer(2, 2, GL_FLOAT,         false, SIZEOF_VERTEX_TEXTURED, uint_to_ptr(offset + 16));
 }
 
+static void GL_SetupVbChunk_Range(int startVertex) {
+	cc_uint32 offset = startVertex * SIZEOF_VERTEX_CHUNK;
+	glVertexAttribPointer(0, 3, GL_SHORT,          false, SIZEOF_VERTEX_CHUNK, uint_to_ptr(offset    ));
+	glVertexAttribPointer(1, 1, GL_UNSIGNED_SHORT, false, SIZEOF_VERTEX_CHUNK, uint_to_ptr(offset + 6));
+	glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, false, SIZEOF_VERTEX_CHUNK, uint_to_ptr(offset + 8));
+}
+static void GL_SetupVbChunk(void) { GL_SetupVbChunk_Range(0); }
+
 void Gfx_SetVertexFormat(VertexFormat fmt) {
 	if (fmt == gfx_format) return;
 	gfx_format = fmt;
@@ -669,6 +744,10 @@ void Gfx_SetVertexFormat(VertexFormat fmt) {
 		glEnableVertexAttribArray(2);
 		gfx_setupVBFunc      = GL_SetupVbTextured;
 		gfx_setupVBRangeFunc = GL_SetupVbTextured_Range;
+	} else if (fmt == VERTEX_FORMAT_CHUNK) {
+		glEnableVertexAttribArray(2);
+		gfx_setupVBFunc      = GL_SetupVbChunk;
+		gfx_setupVBRangeFunc = GL_SetupVbChunk_Range;
 	} else {
 		glDisableVertexAttribArray(2);
 		gfx_setupVBFunc      = GL_SetupVbColoured;
@@ -692,19 +771,49 @@ void Gfx_DrawVb_IndexedTris(int verticesCount) {
 	glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, NULL);
 }
 
+/* NOTE: Chunk meshes may also use VERTEX_FORMAT_CHUNK, so use current format's setup functions */
 void Gfx_BindVb_Textured(GfxResourceID vb) {
 	Gfx_BindVb(vb);
-	GL_SetupVbTextured();
+	gfx_setupVBFunc();
 }
 
 void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex) {
 	if (startVertex + verticesCount > GFX_MAX_VERTICES) {
-		GL_SetupVbTextured_Range(startVertex);
+		gfx_setupVBRangeFunc(startVertex);
 		glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, NULL);
-		GL_SetupVbTextured();
+		gfx_setupVBFunc();
 	} else {
 		/* ICOUNT(startVertex) * 2 = startVertex * 3  */
 		glDrawElements(GL_TRIANGLES, ICOUNT(verticesCount), GL_UNSIGNED_SHORT, uint_to_ptr(startVertex * 3));
 	}
 }
+
+#ifdef CC_BUILD_CHUNKARENA
+#define MULTIDRAW_BATCH 256
+void Gfx_DrawIndexedTris_T2fC4b_Multi(const int* verticesCounts, const int* startVertices, int rangesCount) {
+	GLsizei counts[MULTIDRAW_BATCH];
+	const void* offsets[MULTIDRAW_BATCH];
+	int i, j, count;
+
+	if (!_glMultiDrawElements) {
+		for (i = 0; i < rangesCount; i++)
+		{
+			glDrawElements(GL_TRIANGLES, ICOUNT(verticesCounts[i]), GL_UNSIGNED_SHORT, 
+							uint_to_ptr(startVertices[i] * 3));
+		}
+		return;
+	}
+
+	for (i = 0; i < rangesCount; i += count)
+	{
+		count = min(rangesCount - i, MULTIDRAW_BATCH);
+		for (j = 0; j < count; j++)
+		{
+			counts[j]  = ICOUNT(verticesCounts[i + j]);
+			offsets[j] = uint_to_ptr(startVertices[i + j] * 3);
+		}
+		_glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_SHORT, offsets, count);
+	}
+}
+#endif
 #endif
@@ -340,22 +340,49 @@ static void TransformVertex2D(int index, Vertex* vertex) {
 	}
 }
 
+#ifdef CC_BUILD_COMPACTCHUNKS
+static float chunkX, chunkY, chunkZ;
+void Gfx_SetChunkOrigin(float x, float y, float z) {
+	chunkX = x; chunkY = y; chunkZ = z;
+}
+
+/* See VertexChunk in Graphics.h for how the compact chunk vertex is packed */
+static void DecodeChunkVertex(struct VertexChunk* v, Vector3* pos, Vertex* vertex) {
+	int r = (v->col >> 11), g = (v->col >> 5) & 0x3F, b = v->col & 0x1F;
+
+	pos->x = v->x * (1.0f / VERTEXCHUNK_POS_SCALE) + chunkX;
+	pos->y = v->y * (1.0f / VERTEXCHUNK_POS_SCALE) + chunkY;
+	pos->z = v->z * (1.0f / VERTEXCHUNK_POS_SCALE) + chunkZ;
+
+	vertex->u = v->u * (1.0f / VERTEXCHUNK_U_SCALE);
+	vertex->v = v->v * (1.0f / VERTEXCHUNK_V_SCALE);
+	vertex->c = PackedCol_Make((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255);
+}
+#endif
+
 static int TransformVertex3D(int index, Vertex* vertex) {
 	// TODO: avoid the multiply, just add down in DrawTriangles
 	char* ptr = (char*)gfx_vertices + index * gfx_stride;
 	Vector3* pos = (Vector3*)ptr;
+#ifdef CC_BUILD_COMPACTCHUNKS
+	Vector3 chunkPos;
+	if (gfx_format == VERTEX_FORMAT_CHUNK) {
+		DecodeChunkVertex((struct VertexChunk*)ptr, &chunkPos, vertex);
+		pos = &chunkPos;
+	}
+#endif
 
 	vertex->x = pos->x * _mvp.row1.x + pos->y * _mvp.row2.x + pos->z * _mvp.row3.x + _mvp.row4.x;
 	vertex->y = pos->x * _mvp.row1.y + pos->y * _mvp.row2.y + pos->z * _mvp.row3.y + _mvp.row4.y;
 	vertex->z = pos->x * _mvp.row1.z + pos->y * _mvp.row2.z + pos->z * _mvp.row3.z + _mvp.row4.z;
 	vertex->w = pos->x * _mvp.row1.w + pos->y * _mvp.row2.w + pos->z * _mvp.row3.w + _mvp.row4.w;
 
-	if (gfx_format != VERTEX_FORMAT_TEXTURED) {
+	if (gfx_format == VERTEX_FORMAT_COLOURED) {
 		struct VertexColoured* v = (struct VertexColoured*)ptr;
 		vertex->u = 0.0f;
 		vertex->v = 0.0f;
 		vertex->c = v->Col;
-	} else {
+	} else if (gfx_format == VERTEX_FORMAT_TEXTURED) {
 		struct VertexTextured* v = (struct VertexTextured*)ptr;
 		vertex->u = (v->U + texOffsetX);
 		vertex->v = (v->V + texOffsetY);
@@ -550,7 +577,7 @@ static void DrawTriangle3D(Vertex* V0, Vertex* V1, Vertex* V2) {
 #endif
 
 			int R, G, B, A;
-			if (gfx_format == VERTEX_FORMAT_TEXTURED) {
+			if (gfx_format != VERTEX_FORMAT_COLOURED) {
 				float u = (ic0 * u0 + ic1 * u1 + ic2 * u2) * w;
 				float v = (ic0 * v0 + ic1 * v1 + ic2 * v2) * w;
 				int texX = ((int)(Math_AbsF(u - FastFloor(u)) * curTexWidth )) & texWidthMask;
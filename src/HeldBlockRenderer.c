@@ -91,6 +91,9 @@ static void ResetHeldState(void) {
 	held_entity.MobTextureId = p->MobTextureId;
 	held_entity.uScale       = p->uScale;
 	held_entity.vScale       = p->vScale;
+	held_entity.uOffset      = p->uOffset;
+	held_entity.vOffset      = p->vOffset;
+	held_entity.Flags        = (held_entity.Flags & ~ENTITY_FLAG_SKIN_ATLAS) | (p->Flags & ENTITY_FLAG_SKIN_ATLAS);
 }
 
 static void SetBaseOffset(void) {
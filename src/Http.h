@@ -87,6 +87,9 @@ cc_bool Http_GetCurrent(int* reqID, int* progress);
 int Http_CheckProgress(int reqID);
 /* Clears the list of pending requests. */
 void Http_ClearPending(void);
+/* Retrieves how many requests have been completed using each currently open connection. */
+/* Returns number of open connections. (always 0 if the backend doesn't manage connections) */
+int Http_GetConnectionStats(int* requests, int maxConnections);
 
 void Http_LogError(const char* action, const struct HttpRequest* item);
 
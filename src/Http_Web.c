@@ -44,6 +44,9 @@ void Http_TryCancel(int reqID) {
 	RequestList_TryFree(&processedReqs, reqID);
 }
 
+/* Connections are managed by the browser */
+int Http_GetConnectionStats(int* requests, int maxConnections) { return 0; }
+
 
 /*########################################################################################################################*
 *----------------------------------------------------Emscripten backend---------------------------------------------------*
@@ -1,6 +1,7 @@
 #include "Core.h"
 #ifndef CC_BUILD_WEB
 #include "_HttpBase.h"
+#include "Profiler.h"
 
 /* Ensures data buffer has enough space left to append amount bytes */
 static cc_bool Http_BufferExpand(struct HttpRequest* req, cc_uint32 amount) {
@@ -114,15 +115,10 @@ static void Http_SetRequestHeaders(struct HttpRequest* req) {
 	Http_AddHeader(req, "Cookie", &cookies);
 }
 
-/* TODO: Rewrite to use a local variable instead */
-static cc_string* Http_GetUserAgent_UNSAFE(void) {
-	static char userAgentBuffer[STRING_SIZE];
-	static cc_string userAgent;
-
-	String_InitArray(userAgent, userAgentBuffer);
-	String_AppendConst(&userAgent, GAME_APP_NAME);
-	String_AppendConst(&userAgent, Platform_AppNameSuffix);
-	return &userAgent;
+/* NOTE: userAgent must have at least STRING_SIZE capacity */
+static void Http_GetUserAgent(cc_string* userAgent) {
+	String_AppendConst(userAgent, GAME_APP_NAME);
+	String_AppendConst(userAgent, Platform_AppNameSuffix);
 }
 
 
@@ -440,10 +436,18 @@ static cc_result HttpUrl_ResolveRedirect(struct HttpUrl* parts, const cc_string*
 /*########################################################################################################################*
 *------------------------------------------------------HttpConnection-----------------------------------------------------*
 *#########################################################################################################################*/
+/* How long a connection is kept for reuse when the server doesn't say how long it keeps it open */
+#define HTTP_DEF_IDLE_TIMEOUT (10 * 1000)
+
 struct HttpConnection {
 	cc_socket socket;
 	void* sslCtx;
 	cc_bool valid;
+	cc_uint8* unread;    /* Data received but not processed yet (e.g. start of next pipelined response) */
+	cc_uint32 unreadLen;
+	cc_uint64 lastUsed;  /* Time a request using this connection last finished */
+	int idleTimeout;     /* Max milliseconds since lastUsed for this connection to still be reused */
+	int requests;        /* Number of requests completed using this connection */
 };
 
 static void HttpConnection_Close(struct HttpConnection* conn) {
@@ -456,7 +460,11 @@ static void HttpConnection_Close(struct HttpConnection* conn) {
 		Socket_Close(conn->socket);
 		conn->socket = -1;
 	}
-	conn->valid = false;
+
+	Mem_Free(conn->unread);
+	conn->unread    = NULL;
+	conn->unreadLen = 0;
+	conn->valid     = false;
 }
 
 static void ExtractHostPort(const struct HttpUrl* url, cc_string* host, cc_string* port) {
@@ -488,6 +496,10 @@ static cc_result HttpConnection_Open(struct HttpConnection* conn, const struct H
 
 	conn->socket = -1;
 	conn->sslCtx = NULL;
+	conn->unread = NULL;
+	conn->unreadLen   = 0;
+	conn->idleTimeout = HTTP_DEF_IDLE_TIMEOUT;
+	conn->requests    = 0;
 
 	if ((res = Socket_ParseAddress(&host, portNum, addrs, &numValidAddrs))) return res;
 	res = ERR_INVALID_ARGUMENT; /* in case 0 valid addresses */
@@ -511,6 +523,16 @@ static cc_result HttpConnection_Open(struct HttpConnection* conn, const struct H
 }
 
 static cc_result HttpConnection_Read(struct HttpConnection* conn, cc_uint8* data, cc_uint32 count, cc_uint32* read) {
+	if (conn->unreadLen) {
+		count = min(count, conn->unreadLen);
+		Mem_Copy(data, conn->unread, count);
+
+		conn->unreadLen -= count;
+		Mem_Move(conn->unread, conn->unread + count, conn->unreadLen);
+		*read = count;
+		return 0;
+	}
+
 	if (conn->sslCtx)
 		return SSL_Read(conn->sslCtx, data, count, read);
 
@@ -524,6 +546,20 @@ static cc_result HttpConnection_Write(struct HttpConnection* conn, const cc_uint
 	return Socket_WriteAll(conn->socket,  data, count);
 }
 
+/* Stores data that was received but not processed, so that the next read returns it */
+static cc_result HttpConnection_Unread(struct HttpConnection* conn, const cc_uint8* data, cc_uint32 count) {
+	cc_uint8* unread = (cc_uint8*)Mem_TryAlloc(conn->unreadLen + count, 1);
+	if (!unread) return ERR_OUT_OF_MEMORY;
+
+	Mem_Copy(unread, data, count);
+	Mem_Copy(unread + count, conn->unread, conn->unreadLen);
+	Mem_Free(conn->unread);
+
+	conn->unread     = unread;
+	conn->unreadLen += count;
+	return 0;
+}
+
 
 /*########################################################################################################################*
 *-----------------------------------------------------Connection Pool-----------------------------------------------------*
@@ -533,7 +569,9 @@ static struct ConnectionPoolEntry {
 	cc_string addr;
 	char addrBuffer[STRING_SIZE];
 	cc_bool https;
+	cc_bool inUse; /* Whether a worker is currently using this connection */
 } connection_pool[10];
+static void* poolMutex;
 
 static cc_result ConnectionPool_Insert(int i, struct HttpConnection** conn, const struct HttpUrl* url) {
 	struct ConnectionPoolEntry* e = &connection_pool[i];
@@ -545,31 +583,98 @@ static cc_result ConnectionPool_Insert(int i, struct HttpConnection** conn, cons
 	return HttpConnection_Open(&e->conn, url);
 }
 
-static cc_result ConnectionPool_Open(struct HttpConnection** conn, const struct HttpUrl* url) {
+/* Returns index of an open connection to the given URL's host that is not in use, or -1 if none */
+/* NOTE: Also closes any connections that have been idle for too long */
+static int ConnectionPool_Find(const struct HttpUrl* url) {
 	struct ConnectionPoolEntry* e;
-	int i;
+	cc_uint64 now = Stopwatch_Measure();
+	int i, match = -1;
 
 	for (i = 0; i < Array_Elems(connection_pool); i++)
 	{
 		e = &connection_pool[i];
-		if (e->conn.valid && e->https == url->https && String_Equals(&e->addr, &url->address)) {
-			*conn = &connection_pool[i].conn;
-			return 0;
+		if (e->inUse || !e->conn.valid) continue;
+
+		/* Server has likely closed the connection by now */
+		if (Stopwatch_ElapsedMS(e->conn.lastUsed, now) >= e->conn.idleTimeout) {
+			HttpConnection_Close(&e->conn); continue;
 		}
+		if (e->https == url->https && String_Equals(&e->addr, &url->address)) match = i;
 	}
+	return match;
+}
+
+/* Returns index of an entry that can be used for a new connection */
+/*  (closing the least recently used connection if there are no unused entries) */
+static int ConnectionPool_FindFree(void) {
+	struct ConnectionPoolEntry* e;
+	int i, lru = -1;
 
 	for (i = 0; i < Array_Elems(connection_pool); i++)
 	{
 		e = &connection_pool[i];
-		if (!e->conn.valid) return ConnectionPool_Insert(i, conn, url);
+		if (e->inUse) continue;
+		if (!e->conn.valid) return i;
+
+		if (lru == -1 || e->conn.lastUsed < connection_pool[lru].conn.lastUsed) lru = i;
 	}
 
-	/* TODO: Should we be consistent in which entry gets evicted? */
-	i = (cc_uint8)Stopwatch_Measure() % Array_Elems(connection_pool);
-	HttpConnection_Close(&connection_pool[i].conn);
+	/* Each worker only uses one connection at a time, so there's always an entry not in use */
+	HttpConnection_Close(&connection_pool[lru].conn);
+	return lru;
+}
+
+static cc_result ConnectionPool_Open(struct HttpConnection** conn, const struct HttpUrl* url) {
+	cc_bool reused;
+	int i;
+
+	Mutex_Lock(poolMutex);
+	{
+		i = ConnectionPool_Find(url);
+		reused = i >= 0;
+		if (!reused) i = ConnectionPool_FindFree();
+		connection_pool[i].inUse = true;
+	}
+	Mutex_Unlock(poolMutex);
+
+	*conn = &connection_pool[i].conn;
+	if (reused) return 0;
+	/* Opening the connection is done outside the lock, so other workers aren't blocked on it */
 	return ConnectionPool_Insert(i, conn, url);
 }
 
+/* Allows the given connection to be reused by other workers */
+static void ConnectionPool_Release(struct HttpConnection* conn, int requests) {
+	int i;
+	Mutex_Lock(poolMutex);
+	{
+		conn->lastUsed  = Stopwatch_Measure();
+		conn->requests += requests;
+
+		for (i = 0; i < Array_Elems(connection_pool); i++)
+		{
+			if (&connection_pool[i].conn == conn) connection_pool[i].inUse = false;
+		}
+	}
+	Mutex_Unlock(poolMutex);
+}
+
+int Http_GetConnectionStats(int* requests, int maxConnections) {
+	int i, count = 0;
+	if (!poolMutex) return 0;
+
+	Mutex_Lock(poolMutex);
+	{
+		for (i = 0; i < Array_Elems(connection_pool) && count < maxConnections; i++)
+		{
+			if (!connection_pool[i].conn.valid) continue;
+			requests[count++] = connection_pool[i].conn.requests;
+		}
+	}
+	Mutex_Unlock(poolMutex);
+	return count;
+}
+
 
 /*########################################################################################################################*
 *--------------------------------------------------------HttpClient-------------------------------------------------------*
@@ -594,6 +699,7 @@ struct HttpClientState {
 	cc_uint32 dataLeft; /* Number of bytes still to read from the current chunk or body */
 	int chunked;
 	cc_bool autoClose;
+	int keepAliveTimeout; /* Seconds server keeps connection open for while idle (0 if unknown) */
 	cc_string header, location;
 	struct HttpUrl url;
 	char _headerBuffer[HTTP_HEADER_MAX_LENGTH];
@@ -605,6 +711,7 @@ static void HttpClientState_Reset(struct HttpClientState* state) {
 	state->chunked     = 0;
 	state->dataLeft    = 0;
 	state->autoClose   = false;
+	state->keepAliveTimeout = 0;
 	String_InitArray(state->header,   state->_headerBuffer);
 	String_InitArray(state->location, state->_locationBuffer);
 }
@@ -619,13 +726,16 @@ static void HttpClient_Serialise(struct HttpClientState* state) {
 
 	struct HttpRequest* req = state->req;
 	cc_string* buffer = (cc_string*)req->meta;
+	cc_string userAgent; char userAgentBuffer[STRING_SIZE];
 	/* TODO move to other functions */
 	/* Write request message headers */
 	String_Format2(buffer, "%c %s HTTP/1.1\r\n",
 					verbs[req->requestType], &state->url.resource);
 
+	String_InitArray(userAgent, userAgentBuffer);
+	Http_GetUserAgent(&userAgent);
 	Http_AddHeader(req, "Host",       &state->url.address);
-	Http_AddHeader(req, "User-Agent", Http_GetUserAgent_UNSAFE());
+	Http_AddHeader(req, "User-Agent", &userAgent);
 	if (req->data) String_Format1(buffer, "Content-Length: %i\r\n", &req->size);
 
 	Http_SetRequestHeaders(req);
@@ -651,6 +761,21 @@ static cc_result HttpClient_SendRequest(struct HttpClientState* state) {
 }
 
 
+/* RFC 2068, section 19.7.1.1 - Keep-Alive header (e.g. "timeout=5, max=100") */
+static void HttpClient_ParseKeepAlive(struct HttpClientState* state, const cc_string* value) {
+	cc_string left = *value, part, name, arg;
+	int timeout;
+
+	while (left.length) 
+	{
+		String_UNSAFE_SplitBy(&left, ',', &part);
+		if (!String_UNSAFE_Separate(&part, '=', &name, &arg)) continue;
+		if (!String_CaselessEqualsConst(&name, "timeout")) continue;
+
+		if (Convert_ParseInt(&arg, &timeout) && timeout > 0) state->keepAliveTimeout = timeout;
+	}
+}
+
 static void HttpClient_ParseHeader(struct HttpClientState* state, const cc_string* line) {
 	static const cc_string HTTP_10_VERSION = String_FromConst("HTTP/1.0");
 	cc_string name, value;
@@ -667,6 +792,8 @@ static void HttpClient_ParseHeader(struct HttpClientState* state, const cc_strin
 	} else if (String_CaselessEqualsConst(&name, "Connection")) {
 		if (String_CaselessEqualsConst(&value, "keep-alive")) state->autoClose = false;
 		if (String_CaselessEqualsConst(&value, "close"))      state->autoClose = true;
+	} else if (String_CaselessEqualsConst(&name, "Keep-Alive")) {
+		HttpClient_ParseKeepAlive(state, &value);
 	}
 }
 
@@ -713,7 +840,8 @@ static int HttpClient_GetChunkLength(const cc_string* line) {
 }
 
 /* https://httpwg.org/specs/rfc7230.html */
-static cc_result HttpClient_Process(struct HttpClientState* state, char* buffer, int total) {
+/* NOTE: Stops once the end of the response is reached, setting processed to number of bytes used */
+static cc_result HttpClient_Process(struct HttpClientState* state, char* buffer, int total, int* processed) {
 	struct HttpRequest* req = state->req;
 	cc_uint32 left, avail, read;
 	int offset = 0, chunkLen, ok;
@@ -838,9 +966,11 @@ static cc_result HttpClient_Process(struct HttpClientState* state, char* buffer,
 		break;
 
 		default:
+			*processed = offset;
 			return 0;
 		}
 	}
+	*processed = offset;
 	return 0;
 }
 
@@ -851,6 +981,7 @@ static cc_result HttpClient_ParseResponse(struct HttpClientState* state) {
 	cc_uint8* dst;
 	cc_uint32 total;
 	cc_result res;
+	int processed;
 
 	for (;;) 
 	{
@@ -870,7 +1001,11 @@ static cc_result HttpClient_ParseResponse(struct HttpClientState* state) {
 			Http_BufferExpanded(req, total); 
 			state->dataLeft -= total;
 		} else {
-			res = HttpClient_Process(state, (char*)buffer, total);
+			res = HttpClient_Process(state, (char*)buffer, total, &processed);
+
+			/* Data after the end of this response belongs to the next response */
+			if (!res && processed < total)
+				res = HttpConnection_Unread(state->conn, buffer + processed, total - processed);
 		}
 
 		if (res) return res;
@@ -892,12 +1027,30 @@ static cc_result HttpClient_HandleRedirect(struct HttpClientState* state) {
 	return 0;
 }
 
+/* Updates connection state after a response has been completely received */
+static void HttpClient_EndResponse(struct HttpClientState* state) {
+	if (state->autoClose) {
+		HttpConnection_Close(state->conn);
+	} else if (state->keepAliveTimeout) {
+		/* Stop reusing the connection a bit before the server would close it */
+		state->conn->idleTimeout = (state->keepAliveTimeout - 1) * 1000;
+	}
+}
+
 
 /*########################################################################################################################*
 *-----------------------------------------------Http backend implementation-----------------------------------------------*
 *#########################################################################################################################*/
+/* Requests are processed independently, so multiple workers can be used */
+#define HTTP_MAX_WORKERS 8
+/* Max number of GET requests that are sent together over the same connection */
+#define HTTP_MAX_PIPELINED 4
+static cc_bool httpPipelining;
+
 static void HttpBackend_Init(void) {
 	SSLBackend_Init(httpsVerify);
+	poolMutex = Mutex_Create("HTTP pool");
+	httpPipelining = Options_GetBool(OPT_HTTP_PIPELINING, false);
 	//httpOnly = true; // TODO: insecure
 }
 
@@ -909,14 +1062,15 @@ static cc_result HttpBackend_PerformRequest(struct HttpClientState* state) {
 	cc_result res;
 
 	res = ConnectionPool_Open(&state->conn, &state->url);
-	if (res) { HttpConnection_Close(state->conn); return res; }
-
-	res = HttpClient_SendRequest(state);
-	if (res) { HttpConnection_Close(state->conn); return res; }
-
-	res = HttpClient_ParseResponse(state);
-	if (res) HttpConnection_Close(state->conn);
+	if (!res) res = HttpClient_SendRequest(state);
+	if (!res) res = HttpClient_ParseResponse(state);
 
+	if (res) {
+		HttpConnection_Close(state->conn);
+	} else {
+		HttpClient_EndResponse(state);
+	}
+	ConnectionPool_Release(state->conn, res ? 0 : 1);
 	return res;
 }
 
@@ -961,6 +1115,57 @@ static cc_result HttpBackend_Do(struct HttpRequest* req, cc_string* urlStr) {
 	return res;
 }
 
+/* Sends all the given GET requests over one connection, then reads the responses in order */
+/* NOTE: All the requests must be to the same host */
+static void HttpBackend_DoPipelined(struct HttpRequest** reqs, cc_string* urls, int count) {
+	struct HttpClientState state;
+	struct HttpRequest* req;
+	int i, done = 0;
+	cc_result res;
+
+	HttpClientState_Init(&state);
+	HttpUrl_Parse(&urls[0], &state.url);
+	res = ConnectionPool_Open(&state.conn, &state.url);
+
+	for (i = 0; i < count && !res; i++)
+	{
+		HttpUrl_Parse(&urls[i], &state.url);
+		state.req = reqs[i];
+		res = HttpClient_SendRequest(&state);
+	}
+
+	for (; done < count && !res; done++)
+	{
+		HttpClientState_Reset(&state);
+		state.req = reqs[done];
+		res = HttpClient_ParseResponse(&state);
+		if (res) break;
+
+		/* Server won't send any more responses after this one */
+		if (state.autoClose) { done++; break; }
+	}
+
+	if (res || done < count) {
+		HttpConnection_Close(state.conn);
+	} else {
+		HttpClient_EndResponse(&state);
+	}
+	ConnectionPool_Release(state.conn, done);
+
+	/* Redirects and requests without a response are performed again separately */
+	for (i = 0; i < count; i++)
+	{
+		req = reqs[i];
+		req->result = 0;
+		if (i < done && !HttpClient_IsRedirect(req)) continue;
+
+		HttpRequest_Free(req);
+		req->statusCode    = 0;
+		req->contentLength = 0;
+		req->result = HttpBackend_Do(req, &urls[i]);
+	}
+}
+
 static cc_bool HttpBackend_DescribeError(cc_result res, cc_string* dst) {
 	return SSLBackend_DescribeError(res, dst);
 }
@@ -1065,6 +1270,7 @@ static cc_result Http_SetData(JNIEnv* env, struct HttpRequest* req) {
 }
 
 static cc_result HttpBackend_Do(struct HttpRequest* req, cc_string* url) {
+	cc_string userAgent; char userAgentBuffer[STRING_SIZE];
 	JNIEnv* env;
 	jint res;
 
@@ -1072,8 +1278,10 @@ static cc_result HttpBackend_Do(struct HttpRequest* req, cc_string* url) {
 	if ((res = Http_InitReq(env, req, url))) return res;
 	java_req = req;
 
+	String_InitArray(userAgent, userAgentBuffer);
+	Http_GetUserAgent(&userAgent);
 	Http_SetRequestHeaders(req);
-	Http_AddHeader(req, "User-Agent", Http_GetUserAgent_UNSAFE());
+	Http_AddHeader(req, "User-Agent", &userAgent);
 	if (req->data && (res = Http_SetData(env, req))) return res;
 
 	req->_capacity = 0;
@@ -1140,6 +1348,7 @@ static cc_result ParseResponseHeaders(struct HttpRequest* req, CFReadStreamRef s
 
 static cc_result HttpBackend_Do(struct HttpRequest* req, cc_string* url) {
     static CFStringRef verbs[] = { CFSTR("GET"), CFSTR("HEAD"), CFSTR("POST") };
+    cc_string userAgent; char userAgentBuffer[STRING_SIZE];
     cc_bool gotHeaders = false;
     char tmp[NATIVE_STR_LEN];
     CFHTTPMessageRef request;
@@ -1156,8 +1365,10 @@ static cc_result HttpBackend_Do(struct HttpRequest* req, cc_string* url) {
     
     request = CFHTTPMessageCreateRequest(NULL, verbs[req->requestType], urlRef, kCFHTTPVersion1_1);
     req->meta = request;
+    String_InitArray(userAgent, userAgentBuffer);
+    Http_GetUserAgent(&userAgent);
     Http_SetRequestHeaders(req);
-    Http_AddHeader(req, "User-Agent", Http_GetUserAgent_UNSAFE());
+    Http_AddHeader(req, "User-Agent", &userAgent);
     CFRelease(urlRef);
     
     if (req->data && req->size) {
@@ -1220,15 +1431,29 @@ static cc_result HttpBackend_Do(struct HttpRequest* req, cc_string* url) {
 }
 #endif
 
+#ifndef HTTP_MAX_WORKERS
+/* Other backends share state between requests, so only one request can be processed at a time */
+#define HTTP_MAX_WORKERS   1
+#define HTTP_MAX_PIPELINED 1
+
+int Http_GetConnectionStats(int* requests, int maxConnections) { return 0; }
+#endif
+/* Max number of workers that can be processing requests to the same host at once */
+/*  (so that e.g. a texture pack download doesn't have to wait for dozens of skins) */
+#define HTTP_MAX_HOST_WORKERS 3
 
 static void* workerWaitable;
-static void* workerThread;
+static void* workerThreads[HTTP_MAX_WORKERS];
+static int workersCount, workersStarted;
 
 static void* pendingMutex;
 static struct RequestList pendingReqs;
+/* Origin of the request each worker is currently processing (protected by pendingMutex) */
+static cc_string workerOrigins[HTTP_MAX_WORKERS];
+static char workerOriginsBuffer[HTTP_MAX_WORKERS][STRING_SIZE];
 
 static void* curRequestMutex;
-static struct HttpRequest http_curRequest;
+static struct HttpRequest http_curRequests[HTTP_MAX_WORKERS];
 
 
 /*########################################################################################################################*
@@ -1247,20 +1472,37 @@ cc_bool Http_GetResult(int reqID, struct HttpRequest* item) {
 }
 
 cc_bool Http_GetCurrent(int* reqID, int* progress) {
+	int i;
+	*reqID    = 0;
+	*progress = HTTP_PROGRESS_NOT_WORKING_ON;
+
 	Mutex_Lock(curRequestMutex);
 	{
-		*reqID    = http_curRequest.id;
-		*progress = http_curRequest.progress;
+		for (i = 0; i < workersCount; i++)
+		{
+			if (!http_curRequests[i].id) continue;
+			*reqID    = http_curRequests[i].id;
+			*progress = http_curRequests[i].progress;
+			break;
+		}
 	}
 	Mutex_Unlock(curRequestMutex);
 	return *reqID != 0;
 }
 
 int Http_CheckProgress(int reqID) {
-	int curReqID, progress;
-	Http_GetCurrent(&curReqID, &progress);
+	int i, progress = HTTP_PROGRESS_NOT_WORKING_ON;
 
-	if (reqID != curReqID) progress = HTTP_PROGRESS_NOT_WORKING_ON;
+	Mutex_Lock(curRequestMutex);
+	{
+		for (i = 0; i < workersCount; i++)
+		{
+			if (http_curRequests[i].id != reqID) continue;
+			progress = http_curRequests[i].progress;
+			break;
+		}
+	}
+	Mutex_Unlock(curRequestMutex);
 	return progress;
 }
 
@@ -1291,7 +1533,7 @@ void Http_TryCancel(int reqID) {
 *-----------------------------------------------------Http worker---------------------------------------------------------*
 *#########################################################################################################################*/
 /* Sets up state to begin a http request */
-static void PrepareCurrentRequest(struct HttpRequest* req, cc_string* url) {
+static void PrepareCurrentRequest(struct HttpRequest* req, cc_string* url, int worker) {
 	static const char* verbs[] = { "GET", "HEAD", "POST" };
 	Http_GetUrl(req, url);
 	Platform_Log2("Fetching %s (%c)", url, verbs[req->requestType]);
@@ -1299,64 +1541,186 @@ static void PrepareCurrentRequest(struct HttpRequest* req, cc_string* url) {
 
 	Mutex_Lock(curRequestMutex);
 	{
-		HttpRequest_Copy(&http_curRequest, req);
-		http_curRequest.progress = HTTP_PROGRESS_MAKING_REQUEST;
+		HttpRequest_Copy(&http_curRequests[worker], req);
+		http_curRequests[worker].progress = HTTP_PROGRESS_MAKING_REQUEST;
 	}
 	Mutex_Unlock(curRequestMutex);
 }
 
-static void PerformRequest(struct HttpRequest* req, cc_string* url) {
-	cc_uint64 beg, end;
-	int elapsed;
-
-	beg = Stopwatch_Measure();
-	req->result = HttpBackend_Do(req, url);
-	end = Stopwatch_Measure();
-
-	elapsed = Stopwatch_ElapsedMS(beg, end);
+static void LogRequestResult(struct HttpRequest* req, cc_uint64 beg) {
+	int elapsed = Stopwatch_ElapsedMS(beg, Stopwatch_Measure());
 	Platform_Log4("HTTP: result %e (http %i) in %i ms (%i bytes)",
 		&req->result, &req->statusCode, &elapsed, &req->size);
+}
+
+static void PerformRequest(struct HttpRequest* req, cc_string* url) {
+	cc_uint64 beg = Stopwatch_Measure();
+	req->result   = HttpBackend_Do(req, url);
 
+	LogRequestResult(req, beg);
 	Http_FinishRequest(req);
 }
 
-static void ClearCurrentRequest(void) {
+static void ClearCurrentRequest(int worker) {
 	Mutex_Lock(curRequestMutex);
 	{
-		http_curRequest.id       = 0;
-		http_curRequest.progress = HTTP_PROGRESS_NOT_WORKING_ON;
+		http_curRequests[worker].id       = 0;
+		http_curRequests[worker].progress = HTTP_PROGRESS_NOT_WORKING_ON;
 	}
 	Mutex_Unlock(curRequestMutex);
 }
 
-static void DoRequest(struct HttpRequest* request) {
+static void DoRequest(struct HttpRequest* request, int worker) {
 	char urlBuffer[URL_MAX_SIZE]; cc_string url;
 
 	String_InitArray(url, urlBuffer);
-	PrepareCurrentRequest(request, &url);
-	PerformRequest(&http_curRequest, &url);
-	ClearCurrentRequest();
+	PrepareCurrentRequest(request, &url, worker);
+	PerformRequest(&http_curRequests[worker], &url);
+	ClearCurrentRequest(worker);
+}
+
+#if HTTP_MAX_PIPELINED > 1
+static void DoPipelinedRequests(struct HttpRequest* requests, int count, int worker) {
+	char urlBuffers[HTTP_MAX_PIPELINED][URL_MAX_SIZE];
+	cc_string urls[HTTP_MAX_PIPELINED];
+	struct HttpRequest* reqs[HTTP_MAX_PIPELINED];
+	cc_uint64 beg;
+	int i;
+
+	for (i = 0; i < count; i++) 
+	{
+		String_InitArray(urls[i], urlBuffers[i]);
+		reqs[i] = &requests[i];
+	}
+
+	/* Only first request is reported as being the current request */
+	PrepareCurrentRequest(&requests[0], &urls[0], worker);
+	reqs[0] = &http_curRequests[worker];
+
+	for (i = 1; i < count; i++) 
+	{
+		Http_GetUrl(reqs[i], &urls[i]);
+		Platform_Log1("Fetching %s (pipelined)", &urls[i]);
+	}
+
+	beg = Stopwatch_Measure();
+	HttpBackend_DoPipelined(reqs, urls, count);
+
+	for (i = 0; i < count; i++) 
+	{
+		LogRequestResult(reqs[i], beg);
+		Http_FinishRequest(reqs[i]);
+	}
+	ClearCurrentRequest(worker);
+}
+#endif
+
+/* Returns the scheme and host part of the request's URL (e.g. "http://a.com:8080" for "http://a.com:8080/b.png") */
+static cc_string GetRequestOrigin(struct HttpRequest* req) {
+	cc_string url = String_FromRawArray(req->url);
+	int beg, end;
+
+	beg = String_IndexOfConst(&url, "://");
+	beg = beg >= 0 ? beg + 3 : 0;
+
+	end = String_IndexOfAt(&url, beg, '/');
+	if (end >= 0) url.length = end;
+	return url;
+}
+
+/* Returns index of the first pending request whose origin isn't already */
+/*  being processed by too many workers, or -1 if there is no such request */
+/* NOTE: pendingMutex must be locked when calling this */
+static int FindNextRequest(void) {
+	cc_string origin;
+	int i, j, active;
+
+	for (i = 0; i < pendingReqs.count; i++)
+	{
+		origin = GetRequestOrigin(&pendingReqs.entries[i]);
+		active = 0;
+
+		for (j = 0; j < workersCount; j++)
+		{
+			if (!workerOrigins[j].length) continue;
+			if (String_CaselessEquals(&workerOrigins[j], &origin)) active++;
+		}
+		if (active < HTTP_MAX_HOST_WORKERS) return i;
+	}
+	return -1;
+}
+
+/* Removes pending GET requests with the same origin as the first request, */
+/*  so that they can be sent together with it over the same connection */
+/* NOTE: pendingMutex must be locked when calling this */
+static int TakePipelinedRequests(struct HttpRequest* requests) {
+	struct HttpRequest* req;
+	cc_string origin, reqOrigin;
+	int i, count = 1;
+#if HTTP_MAX_PIPELINED > 1
+	if (!httpPipelining) return count;
+#endif
+	if (requests[0].requestType != REQUEST_TYPE_GET) return count;
+	origin = GetRequestOrigin(&requests[0]);
+
+	for (i = 0; i < pendingReqs.count && count < HTTP_MAX_PIPELINED; )
+	{
+		req       = &pendingReqs.entries[i];
+		reqOrigin = GetRequestOrigin(req);
+
+		if (req->requestType == REQUEST_TYPE_GET && String_CaselessEquals(&origin, &reqOrigin)) {
+			HttpRequest_Copy(&requests[count++], req);
+			RequestList_RemoveAt(&pendingReqs, i);
+		} else {
+			i++;
+		}
+	}
+	return count;
 }
 
 static void WorkerLoop(void) {
-	struct HttpRequest request;
-	cc_bool hasRequest;
+	struct HttpRequest requests[HTTP_MAX_PIPELINED];
+	cc_string origin;
+	cc_bool hasMore;
+	int i, count, worker;
+	Profiler_NameThread("HTTP");
+
+	Mutex_Lock(pendingMutex);
+	{
+		worker = workersStarted++;
+	}
+	Mutex_Unlock(pendingMutex);
 
 	for (;;) {
-		hasRequest = false;
+		count   = 0;
+		hasMore = false;
 
 		Mutex_Lock(pendingMutex);
 		{
-			if (pendingReqs.count) {
-				HttpRequest_Copy(&request, &pendingReqs.entries[0]);
-				hasRequest = true;
-				RequestList_RemoveAt(&pendingReqs, 0);
+			workerOrigins[worker].length = 0;
+			i = FindNextRequest();
+
+			if (i >= 0) {
+				HttpRequest_Copy(&requests[0], &pendingReqs.entries[i]);
+				RequestList_RemoveAt(&pendingReqs, i);
+				count = TakePipelinedRequests(requests);
+
+				origin = GetRequestOrigin(&requests[0]);
+				String_Copy(&workerOrigins[worker], &origin);
+				hasMore = FindNextRequest() >= 0;
 			}
 		}
 		Mutex_Unlock(pendingMutex);
 
-		if (hasRequest) {
-			DoRequest(&request);
+		if (count) {
+			/* Wake up another worker to start on the next pending request */
+			if (hasMore) Waitable_Signal(workerWaitable);
+			Profiler_BeginZone("HTTP request");
+#if HTTP_MAX_PIPELINED > 1
+			if (count > 1) { DoPipelinedRequests(requests, count, worker); Profiler_EndZone(); continue; }
+#endif
+			DoRequest(&requests[0], worker);
+			Profiler_EndZone();
 		} else {
 			/* Block until another thread submits a request to do */
 			Platform_LogConst("Download queue empty, going back to sleep...");
@@ -1369,7 +1733,7 @@ static void WorkerLoop(void) {
 static void HttpBackend_Add(struct HttpRequest* req, cc_uint8 flags) {
 #if defined CC_BUILD_PSP || defined CC_BUILD_NDS
 	/* TODO why doesn't threading work properly on PSP */
-	DoRequest(req);
+	DoRequest(req, 0);
 #else
 	Mutex_Lock(pendingMutex);
 	{
@@ -1384,10 +1748,14 @@ static void HttpBackend_Add(struct HttpRequest* req, cc_uint8 flags) {
 *-----------------------------------------------------Http component------------------------------------------------------*
 *#########################################################################################################################*/
 static void Http_Init(void) {
+	int i;
 	Http_InitCommon();
-	http_curRequest.progress = HTTP_PROGRESS_NOT_WORKING_ON;
+	for (i = 0; i < HTTP_MAX_WORKERS; i++)
+	{
+		http_curRequests[i].progress = HTTP_PROGRESS_NOT_WORKING_ON;
+	}
 	/* Http component gets initialised multiple times on Android */
-	if (workerThread) return;
+	if (workerThreads[0]) return;
 
 	HttpBackend_Init();
 	RequestList_Init(&pendingReqs);
@@ -1397,7 +1765,19 @@ static void Http_Init(void) {
 	pendingMutex    = Mutex_Create("HTTP pending");
 	processedMutex  = Mutex_Create("HTTP processed");
 	curRequestMutex = Mutex_Create("HTTP current");
-	
-	Thread_Run(&workerThread, WorkerLoop, 128 * 1024, "HTTP");
+
+	workersCount = Options_GetInt(OPT_HTTP_WORKERS, 1, HTTP_MAX_WORKERS, min(4, HTTP_MAX_WORKERS));
+	for (i = 0; i < workersCount; i++)
+	{
+		String_InitArray(workerOrigins[i], workerOriginsBuffer[i]);
+	}
+#if defined CC_BUILD_PSP || defined CC_BUILD_NDS
+	workersCount = 1;
+#else
+	for (i = 0; i < workersCount; i++)
+	{
+		Thread_Run(&workerThreads[i], WorkerLoop, 128 * 1024, "HTTP");
+	}
+#endif
 }
 #endif
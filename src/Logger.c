@@ -83,6 +83,7 @@ static const char* GetCCErrorDesc(cc_result res) {
 	case WAV_ERR_DATA_TYPE:   return "Unsupported WAV audio format";
 
 	case ZIP_ERR_TOO_MANY_ENTRIES: return "Cannot load .zip files with over 1024 entries";
+	case ZIP_ERR_FILE_TOO_LARGE:   return "Cannot load .zip entries of 4 GB or over";
 
 	case PNG_ERR_INVALID_SIG:      return "Only PNG images supported";
 	case PNG_ERR_INVALID_HDR_SIZE: return "Invalid PNG header size";
@@ -14,8 +14,11 @@
 #include "Utils.h"
 #include "World.h"
 #include "Options.h"
+#include "Profiler.h"
 
 int MapRenderer_1DUsedCount;
+int MapRenderer_BuildCount;
+cc_uint64 MapRenderer_BuildTime;
 struct ChunkPartInfo* MapRenderer_PartsNormal;
 struct ChunkPartInfo* MapRenderer_PartsTranslucent;
 
@@ -46,6 +49,19 @@ static cc_uint32* distances;
 static int maxChunkUpdates;
 /* Cached number of chunks in the world */
 static int chunksCount;
+/* Scratch arrays the sorted chunks/distances are scattered into when the sort order is updated. */
+static struct ChunkInfo** sortedTemp;
+static cc_uint32* distancesTemp;
+/* Whether every chunk must be checked next update, instead of just the chunks in range */
+static cc_bool walkAllChunks;
+
+/* Chunks are grouped into 4x4x4 regions, so that entire regions can be culled with one test. */
+#define GROUP_SHIFT 2
+#define GROUP_CULLED  0 /* Every chunk in the group is outside the frustum or render distance */
+#define GROUP_PARTIAL 1 /* Each chunk in the group needs to be tested individually */
+#define GROUP_INSIDE  2 /* Group is entirely inside the frustum, only distance needs testing */
+static cc_uint8* groupStates;
+static int groupsX, groupsY, groupsZ, groupsCount;
 
 static void ChunkInfo_Reset(struct ChunkInfo* chunk, int x, int y, int z) {
 	chunk->centreX = x + HALF_CHUNK_SIZE; chunk->centreY = y + HALF_CHUNK_SIZE; 
@@ -53,6 +69,12 @@ static void ChunkInfo_Reset(struct ChunkInfo* chunk, int x, int y, int z) {
 #ifndef CC_BUILD_GL11
 	chunk->vb = 0;
 #endif
+#ifdef CC_BUILD_CHUNKARENA
+	chunk->arenaPage = -1;
+#endif
+#ifdef CC_BUILD_SORTTRANSLUCENT
+	chunk->sortSlot  = -1;
+#endif
 
 	chunk->visible = true;  
 	chunk->empty   = false;
@@ -78,11 +100,227 @@ CC_NOINLINE static int MapRenderer_UsedAtlases(void) {
 	return Atlas1D_Index(maxLoc) + 1;
 }
 
-
+#ifdef CC_BUILD_CHUNKARENA
 /*########################################################################################################################*
-*-------------------------------------------------------Map rendering-----------------------------------------------------*
+*---------------------------------------------------Chunk vertex arena----------------------------------------------------*
 *#########################################################################################################################*/
-static void CheckWeather(float delta) {
+/* Chunk meshes are sub-allocated from a few large shared vertex buffers ('pages'), instead of each chunk */
+/*  having its own vertex buffer. This avoids driver memory churn when rebuilding chunks, and means the */
+/*  visible parts of all chunks in a page can be drawn with one vertex buffer bind and one batched draw. */
+/* Pages are limited to GFX_MAX_VERTICES, so that every range can be drawn using just the index buffer offset */
+#define ARENA_PAGE_VERTICES GFX_MAX_VERTICES
+#define ARENA_MAX_PAGES 64
+#define ARENA_MAX_RANGES 512
+
+struct ArenaAlloc { int offset, count; struct ChunkInfo* owner; };
+struct ArenaRanges { int count; int starts[ARENA_MAX_RANGES], counts[ARENA_MAX_RANGES]; };
+
+struct ArenaPage {
+	GfxResourceID vb;
+	/* Copy of the page's vertices in system memory. Chunks are built directly into */
+	/*  this, and it also allows moving chunk vertices around when compacting the page */
+	struct VertexTextured* data;
+	/* Allocated ranges of vertices, sorted by offset */
+	struct ArenaAlloc* allocs;
+	int allocsCount, allocsCapacity, usedVertices;
+	/* Queued ranges to draw without and with back face culling */
+	struct ArenaRanges ranges[2];
+};
+static struct ArenaPage* arenaPages[ARENA_MAX_PAGES];
+
+static void ArenaPage_Free(int i) {
+	struct ArenaPage* page = arenaPages[i];
+	Gfx_DeleteDynamicVb(&page->vb);
+	Mem_Free(page->data);
+	Mem_Free(page->allocs);
+	Mem_Free(page);
+	arenaPages[i] = NULL;
+}
+
+static struct ArenaPage* ArenaPage_Create(int i) {
+	struct ArenaPage* page = (struct ArenaPage*)Mem_TryAllocCleared(1, sizeof(struct ArenaPage));
+	if (!page) return NULL;
+	arenaPages[i] = page;
+
+	page->data = (struct VertexTextured*)Mem_TryAlloc(ARENA_PAGE_VERTICES, sizeof(struct VertexTextured));
+	page->vb   = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, ARENA_PAGE_VERTICES);
+	if (page->data && page->vb) return page;
+
+	ArenaPage_Free(i);
+	return NULL;
+}
+
+/* Returns offset of first gap between allocations that can fit count vertices, or -1 if none */
+/* Also returns index in allocs list that a new allocation at that offset should be inserted at */
+static int ArenaPage_FindGap(struct ArenaPage* page, int count, int* index) {
+	int i, end = 0;
+	for (i = 0; i < page->allocsCount; i++) 
+	{
+		if (page->allocs[i].offset - end >= count) break;
+		end = page->allocs[i].offset + page->allocs[i].count;
+	}
+
+	*index = i;
+	if (i < page->allocsCount) return end;
+	return ARENA_PAGE_VERTICES - end >= count ? end : -1;
+}
+
+/* Moves all allocations down to the start of the page, so all free space is in one gap at the end */
+static void ArenaPage_Compact(struct ArenaPage* page) {
+	struct ArenaAlloc* alloc;
+	int i, end = 0;
+
+	for (i = 0; i < page->allocsCount; i++) 
+	{
+		alloc = &page->allocs[i];
+		if (alloc->offset != end) {
+			Mem_Move(&page->data[end], &page->data[alloc->offset], alloc->count * sizeof(struct VertexTextured));
+			alloc->offset = end;
+			alloc->owner->arenaOffset = end;
+		}
+		end += alloc->count;
+	}
+	Gfx_SetDynamicVbRange(page->vb, VERTEX_FORMAT_TEXTURED, page->data, 0, end);
+}
+
+static void ArenaPage_Insert(struct ArenaPage* page, int index, struct ChunkInfo* info, int offset, int count) {
+	struct ArenaAlloc* alloc;
+	if (page->allocsCount == page->allocsCapacity) {
+		page->allocsCapacity = page->allocsCapacity ? page->allocsCapacity * 2 : 64;
+		page->allocs = (struct ArenaAlloc*)Mem_Realloc(page->allocs, page->allocsCapacity, 
+														sizeof(struct ArenaAlloc), "arena allocs");
+	}
+
+	alloc = &page->allocs[index];
+	Mem_Move(alloc + 1, alloc, (page->allocsCount - index) * sizeof(struct ArenaAlloc));
+	page->allocsCount++;
+	page->usedVertices += count;
+
+	alloc->offset = offset;
+	alloc->count  = count;
+	alloc->owner  = info;
+}
+
+struct VertexTextured* MapRenderer_AllocChunkVertices(struct ChunkInfo* info, int count) {
+	struct ArenaPage* page;
+	int i, index, offset;
+	/* Offsets must stay multiple of 4 vertices, as ranges are drawn using index buffer offset */
+	count = (count + 3) & ~3;
+	if (count > ARENA_PAGE_VERTICES) return NULL;
+
+	/* First fit in existing pages */
+	for (i = 0; i < ARENA_MAX_PAGES; i++) 
+	{
+		if (!(page = arenaPages[i])) continue;
+		if ((offset = ArenaPage_FindGap(page, count, &index)) >= 0) goto found;
+	}
+
+	/* Fragmented page with enough free space in total */
+	for (i = 0; i < ARENA_MAX_PAGES; i++) 
+	{
+		if (!(page = arenaPages[i])) continue;
+		if (ARENA_PAGE_VERTICES - page->usedVertices < count) continue;
+
+		ArenaPage_Compact(page);
+		offset = ArenaPage_FindGap(page, count, &index);
+		goto found;
+	}
+
+	for (i = 0; i < ARENA_MAX_PAGES; i++) 
+	{
+		if (arenaPages[i]) continue;
+		if (!(page = ArenaPage_Create(i))) return NULL;
+
+		offset = 0; index = 0;
+		goto found;
+	}
+	return NULL;
+
+found:
+	ArenaPage_Insert(page, index, info, offset, count);
+	info->arenaPage   = i;
+	info->arenaOffset = offset;
+	return &page->data[offset];
+}
+
+void MapRenderer_UploadChunkVertices(struct ChunkInfo* info, int count) {
+	struct ArenaPage* page = arenaPages[info->arenaPage];
+	int offset = info->arenaOffset;
+	Gfx_SetDynamicVbRange(page->vb, VERTEX_FORMAT_TEXTURED, &page->data[offset], offset, count);
+}
+
+static void FreeChunkVertices(struct ChunkInfo* info) {
+	struct ArenaPage* page;
+	int lo, hi, mid;
+	if (info->arenaPage < 0) return;
+	page = arenaPages[info->arenaPage];
+
+	/* Binary search for the allocation, since they are sorted by offset */
+	for (lo = 0, hi = page->allocsCount - 1; lo <= hi; ) 
+	{
+		mid = (lo + hi) >> 1;
+		if (page->allocs[mid].offset < info->arenaOffset) { lo = mid + 1; continue; } 
+		if (page->allocs[mid].offset > info->arenaOffset) { hi = mid - 1; continue; } 
+
+		page->usedVertices -= page->allocs[mid].count;
+		page->allocsCount--;
+		Mem_Move(&page->allocs[mid], &page->allocs[mid + 1], (page->allocsCount - mid) * sizeof(struct ArenaAlloc));
+
+		if (!page->allocsCount) ArenaPage_Free(info->arenaPage);
+		info->arenaPage = -1;
+		return;
+	}
+	Process_Abort("Chunk arena allocation not found");
+}
+
+static void FlushArenaRanges(struct ArenaPage* page) {
+	struct ArenaRanges* ranges;
+	Gfx_BindVb_Textured(page->vb);
+
+	ranges = &page->ranges[false];
+	if (ranges->count) {
+		Gfx_DrawIndexedTris_T2fC4b_Multi(ranges->counts, ranges->starts, ranges->count);
+		ranges->count = 0;
+	}
+
+	ranges = &page->ranges[true];
+	if (ranges->count) {
+		Gfx_SetFaceCulling(true);
+		Gfx_DrawIndexedTris_T2fC4b_Multi(ranges->counts, ranges->starts, ranges->count);
+		Gfx_SetFaceCulling(false);
+		ranges->count = 0;
+	}
+}
+
+static void FlushArenaPages(void) {
+	struct ArenaPage* page;
+	int i;
+
+	for (i = 0; i < ARENA_MAX_PAGES; i++) 
+	{
+		page = arenaPages[i];
+		if (!page || !(page->ranges[0].count | page->ranges[1].count)) continue;
+		FlushArenaRanges(page);
+	}
+}
+
+static void QueueArenaRange(struct ArenaPage* page, cc_bool culled, int count, int offset) {
+	struct ArenaRanges* ranges = &page->ranges[culled];
+	int last = ranges->count - 1;
+
+	/* Merge with previous range when contiguous (e.g. consecutive faces of the same chunk) */
+	if (last >= 0 && ranges->starts[last] + ranges->counts[last] == offset) {
+		ranges->counts[last] += count; return;
+	}
+
+	if (ranges->count == ARENA_MAX_RANGES) FlushArenaRanges(page);
+	ranges->starts[ranges->count] = offset;
+	ranges->counts[ranges->count] = count;
+	ranges->count++;
+}
+#endif
+
+static void UpdateInTranslucent(void) {
 	IVec3 pos;
 	BlockID block;
 	cc_bool outside;
@@ -91,7 +329,280 @@ static void CheckWeather(float delta) {
 	block   = World_SafeGetBlock(pos.x, pos.y, pos.z);
 	outside = pos.y < 0 || !World_ContainsXZ(pos.x, pos.z);
 	inTranslucent = Blocks.Draw[block] == DRAW_TRANSLUCENT || (pos.y < Env.EdgeHeight && outside);
+}
+
+#ifdef CC_BUILD_SORTTRANSLUCENT
+/*########################################################################################################################*
+*------------------------------------------------Translucent face sorting-------------------------------------------------*
+*#########################################################################################################################*/
+/* Translucent faces of chunks near the camera are re-sorted back to front whenever the camera moves, */
+/*  which allows drawing them without a depth pre-pass, so that faces behind them blend correctly. */
+/* A copy of the translucent vertices of these chunks is kept in system memory, and the sorted faces */
+/*  are then written back over the chunk's translucent vertices in its vertex buffer. */
+/* Faces the camera can't see (same as drawXMin etc of the chunk) are moved to the end and not drawn. */
+/* Faces of chunks further away are left in the order they were built in, and still use a depth pre-pass. */
+#define SORT_MAX_CHUNKS 64
+/* Max squared distance between chunk centre and camera chunk centre for faces to be sorted */
+#define SORT_MAX_DIST (40 * 40)
+/* Camera must move at least this far (squared) before faces of a chunk are sorted again */
+#define SORT_MIN_MOVE (0.25f * 0.25f)
+/* sortSlot of chunks whose faces couldn't be saved (e.g. out of memory), so are drawn unsorted */
+#define SORT_SLOT_UNSORTABLE -2
+
+#ifdef CC_BUILD_COMPACTCHUNKS
+#define SORT_STRIDE (Builder_CompactVertices ? SIZEOF_VERTEX_CHUNK : SIZEOF_VERTEX_TEXTURED)
+#else
+#define SORT_STRIDE SIZEOF_VERTEX_TEXTURED
+#endif
+
+struct SortChunk {
+	struct ChunkInfo* owner; /* NULL if slot is unused */
+	cc_uint8* vertices;      /* Copy of translucent vertices of all parts, in built order */
+	Vec3* centres;           /* Centre of each quad */
+	float* keys;             /* Squared distance of each quad from the camera */
+	cc_uint16* order;        /* Back to front order of quads, sorted separately within each part */
+	cc_uint16* drawn;        /* Number of quads in each part that are drawn */
+	cc_uint8* faces;         /* Face of each quad */
+	int quadsCount;
+	Vec3 lastPos;            /* Camera position faces were last sorted for */
+};
+static struct SortChunk sortChunks[SORT_MAX_CHUNKS];
+static int sortChunksCount;
+/* Staging memory for writing sorted faces of chunks that have their own vertex buffer */
+static cc_uint8* sortStaging;
+static int sortStagingSize;
+
+static int PartVerticesCount(const struct ChunkPartInfo* part) {
+	int i, count = 0;
+	for (i = 0; i < FACE_COUNT; i++) count += part->counts[i];
+	return count;
+}
+
+static cc_bool CanSeeFace(struct ChunkInfo* info, int face) {
+	if (inTranslucent) return true;
+
+	switch (face) {
+	case FACE_XMIN: return info->drawXMin;
+	case FACE_XMAX: return info->drawXMax;
+	case FACE_ZMIN: return info->drawZMin;
+	case FACE_ZMAX: return info->drawZMax;
+	case FACE_YMIN: return info->drawYMin;
+	}
+	return info->drawYMax;
+}
+
+static cc_bool InSortRange(struct ChunkInfo* info) {
+	int dx = info->centreX - chunkPos.x, dy = info->centreY - chunkPos.y, dz = info->centreZ - chunkPos.z;
+	if (chunkPos.x == Int32_MaxValue) return false;
+	return dx * dx + dy * dy + dz * dz <= SORT_MAX_DIST;
+}
+
+static void FreeSortChunk(struct ChunkInfo* info) {
+	struct SortChunk* sort;
+	if (info->sortSlot < 0) return;
+
+	sort = &sortChunks[info->sortSlot];
+	Mem_Free(sort->vertices);
+	sort->vertices = NULL;
+	sort->owner    = NULL;
+
+	info->sortSlot = -1;
+	sortChunksCount--;
+}
+
+void MapRenderer_SaveTranslucent(struct ChunkInfo* info, const struct VertexTextured* vertices, const void* data) {
+	const struct VertexTextured* v;
+	const cc_uint8* src = (const cc_uint8*)data;
+	struct ChunkPartInfo* part;
+	struct SortChunk* sort;
+	int stride = SORT_STRIDE;
+	int i, j, k, face, slot, count, quads = 0;
+	cc_uint8* mem;
+
+	if (!InSortRange(info)) return;
+	for (slot = 0; slot < SORT_MAX_CHUNKS; slot++) 
+	{
+		if (!sortChunks[slot].owner) break;
+	}
+	if (slot == SORT_MAX_CHUNKS) return;
+
+	part = info->translucentParts;
+	for (i = 0; i < MapRenderer_1DUsedCount; i++, part += chunksCount) 
+	{
+		if (part->offset >= 0) quads += PartVerticesCount(part) >> 2;
+	}
+	/* Avoid UpdateSortSlot rebuilding the chunk every frame to try saving again */
+	if (!quads) { info->sortSlot = SORT_SLOT_UNSORTABLE; return; }
+
+	mem = (cc_uint8*)Mem_TryAlloc(quads * (4 * stride + sizeof(Vec3) + sizeof(float) + sizeof(cc_uint16) + 1)
+								+ MapRenderer_1DUsedCount * sizeof(cc_uint16), 1);
+	if (!mem) { info->sortSlot = SORT_SLOT_UNSORTABLE; return; }
+
+	sort = &sortChunks[slot];
+	sort->owner      = info;
+	sort->vertices   = mem;
+	sort->centres    = (Vec3*)(mem + quads * 4 * stride);
+	sort->keys       = (float*)(sort->centres + quads);
+	sort->order      = (cc_uint16*)(sort->keys + quads);
+	sort->drawn      = sort->order + quads;
+	sort->faces      = (cc_uint8*)(sort->drawn + MapRenderer_1DUsedCount);
+	sort->quadsCount = quads;
+	sort->lastPos    = Vec3_BigPos();
+
+	info->sortSlot = slot;
+	sortChunksCount++;
+
+	part = info->translucentParts;
+	for (i = 0, j = 0; i < MapRenderer_1DUsedCount; i++, part += chunksCount) 
+	{
+		sort->drawn[i] = 0;
+		if (part->offset < 0) continue;
+		count = PartVerticesCount(part);
+		Mem_Copy(mem + j * 4 * stride, src + part->offset * stride, count * stride);
+		/* Until first sorted, all faces are drawn in built order */
+		sort->drawn[i] = count >> 2;
+
+		for (face = 0, k = 0; face < FACE_COUNT; face++) 
+		{
+			for (count = k + part->counts[face]; k < count; k += 4, j++) 
+			{
+				v = &vertices[part->offset + k];
+				sort->centres[j].x = (v[0].x + v[1].x + v[2].x + v[3].x) * 0.25f;
+				sort->centres[j].y = (v[0].y + v[1].y + v[2].y + v[3].y) * 0.25f;
+				sort->centres[j].z = (v[0].z + v[1].z + v[2].z + v[3].z) * 0.25f;
+				sort->order[j]     = j;
+				sort->faces[j]     = face;
+			}
+		}
+	}
+}
+
+/* Sorts the quads of each translucent part back to front, and uploads them if the order changed */
+/* Quads the camera can't see are moved after all the other quads */
+static void SortChunkFaces(struct SortChunk* sort, Vec3 pos) {
+	struct ChunkInfo* info = sort->owner;
+	struct ChunkPartInfo* part;
+	int quadSize = 4 * SORT_STRIDE;
+	float* keys  = sort->keys;
+	cc_uint16* order;
+	cc_uint16 index;
+	cc_bool changed;
+	float key, dx, dy, dz;
+	int i, j, k, first, quads, start;
+	cc_uint8* dst;
+
+	for (i = 0; i < sort->quadsCount; i++) 
+	{
+		dx = sort->centres[i].x - pos.x; dy = sort->centres[i].y - pos.y; dz = sort->centres[i].z - pos.z;
+		keys[i] = CanSeeFace(info, sort->faces[i]) ? dx * dx + dy * dy + dz * dz : -1.0f;
+	}
+	sort->lastPos = pos;
+
+	part = info->translucentParts;
+	for (i = 0, first = 0; i < MapRenderer_1DUsedCount; i++, part += chunksCount) 
+	{
+		if (part->offset < 0) continue;
+		quads = PartVerticesCount(part) >> 2;
+		order = sort->order + first;
+		first += quads;
+		changed = false;
+
+		/* Insertion sort, since order from the last sort is usually already nearly correct */
+		for (j = 1; j < quads; j++) 
+		{
+			index = order[j]; key = keys[index];
+			for (k = j - 1; k >= 0 && keys[order[k]] < key; k--) 
+			{
+				order[k + 1] = order[k]; changed = true;
+			}
+			order[k + 1] = index;
+		}
+
+		for (j = quads; j > 0 && keys[order[j - 1]] < 0.0f; j--) { }
+		sort->drawn[i] = j;
+		if (!changed) continue;
+
+		if (info->arenaPage >= 0) {
+			start = info->arenaOffset + part->offset;
+			dst   = (cc_uint8*)&arenaPages[info->arenaPage]->data[start];
+		} else {
+			if (quads * quadSize > sortStagingSize) {
+				sortStagingSize = quads * quadSize;
+				sortStaging     = (cc_uint8*)Mem_Realloc(sortStaging, sortStagingSize, 1, "sort staging");
+			}
+			start = part->offset;
+			dst   = sortStaging;
+		}
+
+		for (j = 0; j < quads; j++) 
+		{
+			Mem_Copy(dst + j * quadSize, sort->vertices + order[j] * quadSize, quadSize);
+		}
+
+		if (info->arenaPage >= 0) {
+			Gfx_SetDynamicVbRange(arenaPages[info->arenaPage]->vb, VERTEX_FORMAT_TEXTURED, dst, start, quads * 4);
+		} else {
+			Gfx_SetDynamicVbRange(info->vb, Builder_VertexFormat, dst, start, quads * 4);
+		}
+	}
+}
+
+/* Forces faces of all chunks to be sorted again, e.g. because which faces the camera can see changed */
+static void ResetTranslucentSort(void) {
+	int i;
+	for (i = 0; i < SORT_MAX_CHUNKS; i++) 
+	{
+		sortChunks[i].lastPos = Vec3_BigPos();
+	}
+}
+
+static void UpdateTranslucentSort(void) {
+	static cc_bool lastInTranslucent;
+	struct SortChunk* sort;
+	Vec3 delta;
+	int i;
+	if (!sortChunksCount) return;
 
+	/* All faces can be seen when the camera is inside a translucent block */
+	UpdateInTranslucent();
+	if (inTranslucent != lastInTranslucent) ResetTranslucentSort();
+	lastInTranslucent = inTranslucent;
+
+	for (i = 0; i < SORT_MAX_CHUNKS; i++) 
+	{
+		sort = &sortChunks[i];
+		/* Sorting of chunks not currently visible is deferred until they are */
+		if (!sort->owner || !sort->owner->visible) continue;
+
+		Vec3_Sub(&delta, &Camera.CurrentPos, &sort->lastPos);
+		if (Vec3_LengthSquared(&delta) < SORT_MIN_MOVE) continue;
+		SortChunkFaces(sort, Camera.CurrentPos);
+	}
+}
+
+/* Frees sort data of chunks that moved out of sorting range, and marks chunks that moved */
+/*  into sorting range as needing rebuilding, so that their translucent vertices get saved */
+/* (chunks that failed to be saved are only retried after they move out of and back into range) */
+static void UpdateSortSlot(struct ChunkInfo* info, int distSqr) {
+	if (info->sortSlot >= 0) {
+		if (distSqr > SORT_MAX_DIST) FreeSortChunk(info);
+	} else if (info->sortSlot == SORT_SLOT_UNSORTABLE) {
+		if (distSqr > SORT_MAX_DIST) info->sortSlot = -1;
+	} else if (info->translucentParts && distSqr <= SORT_MAX_DIST && sortChunksCount < SORT_MAX_CHUNKS) {
+		info->dirty = true;
+	}
+}
+#else
+#define ResetTranslucentSort()
+#define UpdateTranslucentSort()
+#endif
+
+
+/*########################################################################################################################*
+*-------------------------------------------------------Map rendering-----------------------------------------------------*
+*#########################################################################################################################*/
+static void CheckWeather(float delta) {
+	UpdateInTranslucent();
 	/* If we are under water, render weather before to blend properly */
 	if (!inTranslucent || Env.Weather == WEATHER_SUNNY) return;
 	Gfx_SetAlphaBlending(true);
@@ -99,19 +610,59 @@ static void CheckWeather(float delta) {
 	Gfx_SetAlphaBlending(false);
 }
 
+#ifdef CC_BUILD_CHUNKARENA
+/* Arena page of the chunk currently being drawn, NULL if chunk has its own vertex buffer */
+static struct ArenaPage* drawPage;
+static cc_bool drawCulled;
+
+static void SetChunkCulling(cc_bool enabled) {
+	drawCulled = enabled;
+	if (!drawPage) Gfx_SetFaceCulling(enabled);
+}
+
+static void DrawChunkRange(int count, int offset) {
+	if (drawPage) {
+		QueueArenaRange(drawPage, drawCulled, count, offset);
+	} else {
+		Gfx_DrawIndexedTris_T2fC4b(count, offset);
+	}
+}
+#define ChunkOffset(info) ((info)->arenaPage >= 0 ? (info)->arenaOffset : 0)
+#else
+#define SetChunkCulling   Gfx_SetFaceCulling
+#define DrawChunkRange    Gfx_DrawIndexedTris_T2fC4b
+#define ChunkOffset(info) 0
+#define FlushArenaPages()
+#endif
+
+#ifndef CC_BUILD_GL11
+static void BindChunk(struct ChunkInfo* info) {
+#ifdef CC_BUILD_CHUNKARENA
+	drawPage = info->arenaPage >= 0 ? arenaPages[info->arenaPage] : NULL;
+	if (drawPage) return;
+#endif
+	Gfx_BindVb_Textured(info->vb);
+#ifdef CC_BUILD_COMPACTCHUNKS
+	if (!Builder_CompactVertices) return;
+	Gfx_SetChunkOrigin((float)(info->centreX - HALF_CHUNK_SIZE), (float)(info->centreY - HALF_CHUNK_SIZE), 
+						(float)(info->centreZ - HALF_CHUNK_SIZE));
+#endif
+}
+#endif
+
 #ifdef CC_BUILD_GL11
 #define DrawFace(face, ign)    Gfx_BindVb(part.vbs[face]); Gfx_DrawIndexedTris_T2fC4b(0, 0);
 #define DrawFaces(f1, f2, ign) DrawFace(f1, ign); DrawFace(f2, ign);
 #else
-#define DrawFace(face, offset)    Gfx_DrawIndexedTris_T2fC4b(part.counts[face], offset);
-#define DrawFaces(f1, f2, offset) Gfx_DrawIndexedTris_T2fC4b(part.counts[f1] + part.counts[f2], offset);
+#define DrawFace(face, offset)    DrawChunkRange(part.counts[face], offset);
+#define DrawFaces(f1, f2, offset) DrawChunkRange(part.counts[f1] + part.counts[f2], offset);
 #endif
 
 #define DrawNormalFaces(minFace, maxFace) \
 if (drawMin && drawMax) { \
-	Gfx_SetFaceCulling(true); \
+	SetChunkCulling(true); \
 	DrawFaces(minFace, maxFace, offset); \
-	Gfx_SetFaceCulling(false); \
+	SetChunkCulling(false); \
 	Game_Vertices += (part.counts[minFace] + part.counts[maxFace]); \
 } else if (drawMin) { \
 	DrawFace(minFace, offset); \
@@ -137,10 +688,10 @@ static void RenderNormalBatch(int batch) {
 		hasNormParts[batch] = true;
 
 #ifndef CC_BUILD_GL11
-		Gfx_BindVb_Textured(info->vb);
+		BindChunk(info);
 #endif
 
-		offset  = part.offset + part.spriteCount;
+		offset  = ChunkOffset(info) + part.offset + part.spriteCount;
 		drawMin = info->drawXMin && part.counts[FACE_XMIN];
 		drawMax = info->drawXMax && part.counts[FACE_XMAX];
 		DrawNormalFaces(FACE_XMIN, FACE_XMAX);
@@ -156,10 +707,10 @@ static void RenderNormalBatch(int batch) {
 		DrawNormalFaces(FACE_YMIN, FACE_YMAX);
 
 		if (!part.spriteCount) continue;
-		offset = part.offset;
+		offset = ChunkOffset(info) + part.offset;
 		count  = part.spriteCount >> 2; /* 4 per sprite */
 
-		Gfx_SetFaceCulling(true);
+		SetChunkCulling(true);
 		/* TODO: fix to not render them all */
 #ifdef CC_BUILD_GL11
 		Gfx_BindVb(part.vbs[FACE_COUNT]);
@@ -169,29 +720,30 @@ static void RenderNormalBatch(int batch) {
 		continue;
 #endif
 		if (info->drawXMax || info->drawZMin) {
-			Gfx_DrawIndexedTris_T2fC4b(count, offset); Game_Vertices += count;
+			DrawChunkRange(count, offset); Game_Vertices += count;
 		} offset += count;
 
 		if (info->drawXMin || info->drawZMax) {
-			Gfx_DrawIndexedTris_T2fC4b(count, offset); Game_Vertices += count;
+			DrawChunkRange(count, offset); Game_Vertices += count;
 		} offset += count;
 
 		if (info->drawXMin || info->drawZMin) {
-			Gfx_DrawIndexedTris_T2fC4b(count, offset); Game_Vertices += count;
+			DrawChunkRange(count, offset); Game_Vertices += count;
 		} offset += count;
 
 		if (info->drawXMax || info->drawZMax) {
-			Gfx_DrawIndexedTris_T2fC4b(count, offset); Game_Vertices += count;
+			DrawChunkRange(count, offset); Game_Vertices += count;
 		}
-		Gfx_SetFaceCulling(false);
+		SetChunkCulling(false);
 	}
+	FlushArenaPages();
 }
 
 void MapRenderer_RenderNormal(float delta) {
 	int batch;
 	if (!mapChunks) return;
 
-	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
+	Gfx_SetVertexFormat(Builder_VertexFormat);
 	Gfx_SetAlphaTest(true);
 	
 	Gfx_EnableMipmaps();
@@ -225,14 +777,23 @@ if (drawMin && drawMax) { \
 	Game_Vertices += part.counts[maxFace]; \
 }
 
+#ifdef CC_BUILD_SORTTRANSLUCENT
+/* Whether only filling depth buffer, which is skipped for chunks with sorted faces */
+static cc_bool translucentDepthPass;
+#endif
+
 static void RenderTranslucentBatch(int batch) {
 	int batchOffset = chunksCount * batch;
 	struct ChunkInfo* info;
 	struct ChunkPartInfo part;
 	cc_bool drawMin, drawMax;
 	int i, offset;
+#ifdef CC_BUILD_SORTTRANSLUCENT
+	int count;
+#endif
 
-	for (i = 0; i < renderChunksCount; i++) {
+	/* Draw chunks back to front */
+	for (i = renderChunksCount - 1; i >= 0; i--) {
 		info = renderChunks[i];
 		if (!info->translucentParts) continue;
 
@@ -240,11 +801,27 @@ static void RenderTranslucentBatch(int batch) {
 		if (part.offset < 0) continue;
 		hasTranParts[batch] = true;
 
+#ifdef CC_BUILD_SORTTRANSLUCENT
+		if (translucentDepthPass && info->sortSlot >= 0) continue;
+		/* Queued ranges of previous chunks must be drawn first to keep back to front order */
+		if (drawPage && (info->arenaPage < 0 || arenaPages[info->arenaPage] != drawPage)) {
+			FlushArenaRanges(drawPage);
+		}
+#endif
 #ifndef CC_BUILD_GL11
-		Gfx_BindVb_Textured(info->vb);
+		BindChunk(info);
 #endif
 
-		offset  = part.offset;
+		offset  = ChunkOffset(info) + part.offset;
+#ifdef CC_BUILD_SORTTRANSLUCENT
+		/* Sorted faces are mixed across all face directions, with faces that can't be seen last */
+		if (info->sortSlot >= 0) {
+			count = sortChunks[info->sortSlot].drawn[batch] * 4;
+			if (count) DrawChunkRange(count, offset);
+			Game_Vertices += count;
+			continue;
+		}
+#endif
 		drawMin = (inTranslucent || info->drawXMin) && part.counts[FACE_XMIN];
 		drawMax = (inTranslucent || info->drawXMax) && part.counts[FACE_XMAX];
 		DrawTranslucentFaces(FACE_XMIN, FACE_XMAX);
@@ -259,17 +836,21 @@ static void RenderTranslucentBatch(int batch) {
 		drawMax = (inTranslucent || info->drawYMax) && part.counts[FACE_YMAX];
 		DrawTranslucentFaces(FACE_YMIN, FACE_YMAX);
 	}
+	FlushArenaPages();
 }
 
 void MapRenderer_RenderTranslucent(float delta) {
-	int vertices, batch;
+	int batch, vertices;
 	if (!mapChunks) return;
 
 	/* First fill depth buffer */
 	vertices = Game_Vertices;
-	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
+	Gfx_SetVertexFormat(Builder_VertexFormat);
 	Gfx_SetAlphaBlending(false);
 	Gfx_DepthOnlyRendering(true);
+#ifdef CC_BUILD_SORTTRANSLUCENT
+	translucentDepthPass = true;
+#endif
 
 	for (batch = 0; batch < MapRenderer_1DUsedCount; batch++) 
 	{
@@ -280,11 +861,15 @@ void MapRenderer_RenderTranslucent(float delta) {
 		}
 	}
 	Game_Vertices = vertices;
+#ifdef CC_BUILD_SORTTRANSLUCENT
+	translucentDepthPass = false;
+#endif
 
 	/* Then actually draw the transluscent blocks */
 	Gfx_SetAlphaBlending(true);
 	Gfx_DepthOnlyRendering(false);
-	Gfx_SetDepthWrite(false); /* already calculated depth values in depth pass */
+	/* already calculated depth values in depth pass (or faces are sorted back to front) */
+	Gfx_SetDepthWrite(false);
 
 	Gfx_EnableMipmaps();
 	for (batch = 0; batch < MapRenderer_1DUsedCount; batch++) 
@@ -320,6 +905,12 @@ static void DeleteChunk(struct ChunkInfo* info) {
 #else
 	Gfx_DeleteVb(&info->vb);
 #endif
+#ifdef CC_BUILD_CHUNKARENA
+	FreeChunkVertices(info);
+#endif
+#ifdef CC_BUILD_SORTTRANSLUCENT
+	FreeSortChunk(info);
+#endif
 
 	info->empty  = false; 
 	info->allAir = false;
@@ -359,9 +950,16 @@ static void BuildChunk(struct ChunkInfo* info, int* chunkUpdates) {
 	struct ChunkPartInfo* ptr;
 	int i;
 
+	cc_uint64 beg;
+
 	Game.ChunkUpdates++;
 	(*chunkUpdates)++;
+	Profiler_BeginZone("Builder_MakeChunk");
+	beg = Stopwatch_Measure();
 	Builder_MakeChunk(info);
+	MapRenderer_BuildTime += Stopwatch_Measure() - beg;
+	MapRenderer_BuildCount++;
+	Profiler_EndZone();
 
 	info->dirty  = false;
 	info->noData = !info->normalParts && !info->translucentParts;
@@ -398,11 +996,17 @@ static void FreeChunks(void) {
 	Mem_Free(sortedChunks);
 	Mem_Free(renderChunks);
 	Mem_Free(distances);
-
-	mapChunks    = NULL;
-	sortedChunks = NULL;
-	renderChunks = NULL;
-	distances    = NULL;
+	Mem_Free(sortedTemp);
+	Mem_Free(distancesTemp);
+	Mem_Free(groupStates);
+
+	mapChunks     = NULL;
+	sortedChunks  = NULL;
+	renderChunks  = NULL;
+	distances     = NULL;
+	sortedTemp    = NULL;
+	distancesTemp = NULL;
+	groupStates   = NULL;
 }
 
 static void AllocateParts(void) {
@@ -419,6 +1023,15 @@ static void AllocateChunks(void) {
 	sortedChunks = (struct ChunkInfo**)Mem_Alloc(chunksCount, sizeof(struct ChunkInfo*), "sorted chunk info");
 	renderChunks = (struct ChunkInfo**)Mem_Alloc(chunksCount, sizeof(struct ChunkInfo*), "render chunk info");
 	distances    = (cc_uint32*)Mem_Alloc(chunksCount, 4, "chunk distances");
+
+	sortedTemp    = (struct ChunkInfo**)Mem_Alloc(chunksCount, sizeof(struct ChunkInfo*), "sorted chunk temp");
+	distancesTemp = (cc_uint32*)Mem_Alloc(chunksCount, 4, "chunk distances temp");
+
+	groupsX = (World.ChunksX + (1 << GROUP_SHIFT) - 1) >> GROUP_SHIFT;
+	groupsY = (World.ChunksY + (1 << GROUP_SHIFT) - 1) >> GROUP_SHIFT;
+	groupsZ = (World.ChunksZ + (1 << GROUP_SHIFT) - 1) >> GROUP_SHIFT;
+	groupsCount = groupsX * groupsY * groupsZ;
+	groupStates = (cc_uint8*)Mem_Alloc(groupsCount, 1, "chunk group states");
 }
 
 static void ResetPartFlags(void) {
@@ -452,6 +1065,7 @@ static void InitChunks(void) {
 			}
 		}
 	}
+	Mem_Set(groupStates, GROUP_PARTIAL, groupsCount);
 }
 
 static void ResetChunks(void) {
@@ -542,15 +1156,92 @@ static void CalcViewDists(void) {
 	renderDistSquared = AdjustDist(Game_ViewDistance);
 }
 
-static int UpdateChunksAndVisibility(int* chunkUpdates) {
-	int renderDistSqr = renderDistSquared;
+/* Returns distance from v to the closest value in [min, max] */
+static int ClampedDist(int v, int min, int max) {
+	if (v < min) return min - v;
+	if (v > max) return v - max;
+	return 0;
+}
+
+/* Classifies each group of chunks against the view frustum and render distance */
+static void UpdateGroupStates(void) {
+	int gx, gy, gz, index = 0;
+	int minX, minY, minZ, maxX, maxY, maxZ;
+	int dx, dy, dz, distSqr;
+	float cx, cy, cz, radius;
+	int size = CHUNK_SIZE << GROUP_SHIFT;
+
+	/* NOTE: Bounds are rounded up to whole chunks, as the last chunk along an axis */
+	/*  still extends a full CHUNK_SIZE even when world size isn't a multiple of it */
+	for (gz = 0; gz < groupsZ; gz++) {
+		for (gy = 0; gy < groupsY; gy++) {
+			for (gx = 0; gx < groupsX; gx++, index++) {
+				minX = gx * size; maxX = min(minX + size, World.ChunksX * CHUNK_SIZE);
+				minY = gy * size; maxY = min(minY + size, World.ChunksY * CHUNK_SIZE);
+				minZ = gz * size; maxZ = min(minZ + size, World.ChunksZ * CHUNK_SIZE);
+
+				/* Distance to closest chunk centre in the group */
+				dx = ClampedDist(chunkPos.x, minX + HALF_CHUNK_SIZE, maxX - HALF_CHUNK_SIZE);
+				dy = ClampedDist(chunkPos.y, minY + HALF_CHUNK_SIZE, maxY - HALF_CHUNK_SIZE);
+				dz = ClampedDist(chunkPos.z, minZ + HALF_CHUNK_SIZE, maxZ - HALF_CHUNK_SIZE);
+				distSqr = dx * dx + dy * dy + dz * dz;
+				if (distSqr > renderDistSquared) { groupStates[index] = GROUP_CULLED; continue; }
+
+				cx = (minX + maxX) * 0.5f; cy = (minY + maxY) * 0.5f; cz = (minZ + maxZ) * 0.5f;
+				dx = maxX - minX; dy = maxY - minY; dz = maxZ - minZ;
+				radius = Math_SqrtF((float)(dx * dx + dy * dy + dz * dz)) * 0.5f;
+
+				if (!FrustumCulling_SphereInFrustum(cx, cy, cz, radius)) {
+					groupStates[index] = GROUP_CULLED;
+				} else if (FrustumCulling_SphereFullyInFrustum(cx, cy, cz, radius)) {
+					groupStates[index] = GROUP_INSIDE;
+				} else {
+					groupStates[index] = GROUP_PARTIAL;
+				}
+			}
+		}
+	}
+}
+
+static cc_bool IsChunkVisible(struct ChunkInfo* info, int distSqr) {
+	int gx = info->centreX >> (CHUNK_SHIFT + GROUP_SHIFT);
+	int gy = info->centreY >> (CHUNK_SHIFT + GROUP_SHIFT);
+	int gz = info->centreZ >> (CHUNK_SHIFT + GROUP_SHIFT);
+	int state;
+	if (distSqr > renderDistSquared) return false;
+
+	state = groupStates[(gz * groupsY + gy) * groupsX + gx];
+	if (state != GROUP_PARTIAL) return state == GROUP_INSIDE;
+	return FrustumCulling_SphereInFrustum(info->centreX, info->centreY, info->centreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
+}
+
+/* Returns number of chunks (from start of sortedChunks) that may need building, unloading or drawing */
+/* Chunks further away than this have already been unloaded by an earlier full walk, and since */
+/*  chunks are only ever built within build distance, they cannot have data again until the */
+/*  camera moves to another chunk (which causes the chunks to be re-sorted and walked again) */
+static int CountChunksInRange(void) {
+	cc_uint32 limit = max(buildDistSquared + 32 * 16, renderDistSquared);
+	int lo = 0, hi = chunksCount, mid;
+
+	if (walkAllChunks) { walkAllChunks = false; return chunksCount; }
+
+	/* distances is sorted, so binary search for first chunk past the limit */
+	while (lo < hi) {
+		mid = (lo + hi) >> 1;
+		if (distances[mid] <= limit) { lo = mid + 1; } else { hi = mid; }
+	}
+	return lo;
+}
+
+static int UpdateChunksAndVisibility(int* chunkUpdates, int count) {
 	int buildDistSqr  = buildDistSquared;
 
 	struct ChunkInfo* info;
 	int i, j = 0, distSqr;
 	cc_bool noData;
 
-	for (i = 0; i < chunksCount; i++) {
+	UpdateGroupStates();
+	for (i = 0; i < count; i++) {
 		info = sortedChunks[i];
 		if (info->empty) continue;
 
@@ -561,6 +1252,9 @@ static int UpdateChunksAndVisibility(int* chunkUpdates) {
 		if (!noData && distSqr >= buildDistSqr + 32 * 16) {
 			DeleteChunk(info); continue;
 		}
+#ifdef CC_BUILD_SORTTRANSLUCENT
+		UpdateSortSlot(info, distSqr);
+#endif
 		noData |= info->dirty;
 
 		if (noData && distSqr <= buildDistSqr && *chunkUpdates < chunksTarget) {
@@ -568,22 +1262,20 @@ static int UpdateChunksAndVisibility(int* chunkUpdates) {
 			BuildChunk(info, chunkUpdates);
 		}
 
-		info->visible = distSqr <= renderDistSqr &&
-			FrustumCulling_SphereInFrustum(info->centreX, info->centreY, info->centreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
+		info->visible = IsChunkVisible(info, distSqr);
 		if (info->visible && !info->empty) { renderChunks[j] = info; j++; }
 	}
 	return j;
 }
 
-static int UpdateChunksStill(int* chunkUpdates) {
-	int renderDistSqr = renderDistSquared;
+static int UpdateChunksStill(int* chunkUpdates, int count) {
 	int buildDistSqr  = buildDistSquared;
 
 	struct ChunkInfo* info;
 	int i, j = 0, distSqr;
 	cc_bool noData;
 
-	for (i = 0; i < chunksCount; i++) {
+	for (i = 0; i < count; i++) {
 		info = sortedChunks[i];
 		if (info->empty) continue;
 
@@ -601,8 +1293,7 @@ static int UpdateChunksStill(int* chunkUpdates) {
 			BuildChunk(info, chunkUpdates);
 
 			/* only need to update the visibility of chunks in range. */
-			info->visible = distSqr <= renderDistSqr &&
-				FrustumCulling_SphereInFrustum(info->centreX, info->centreY, info->centreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
+			info->visible = IsChunkVisible(info, distSqr);
 			if (info->visible && !info->empty) { renderChunks[j] = info; j++; }
 		} else if (info->visible) {
 			renderChunks[j] = info; j++;
@@ -614,7 +1305,7 @@ static int UpdateChunksStill(int* chunkUpdates) {
 static void UpdateChunks(float delta) {
 	struct LocalPlayer* p;
 	cc_bool samePos;
-	int chunkUpdates = 0;
+	int chunkUpdates = 0, count;
 
 	/* Build more chunks if 30 FPS or over, otherwise slowdown */
 	chunksTarget += delta < CHUNK_TARGET_TIME ? 1 : -1; 
@@ -624,9 +1315,10 @@ static void UpdateChunks(float delta) {
 	samePos = Vec3_Equals(&Camera.CurrentPos, &lastCamPos)
 		&& p->Base.Pitch == lastPitch && p->Base.Yaw == lastYaw;
 
+	count = CountChunksInRange();
 	renderChunksCount = samePos ?
-		UpdateChunksStill(&chunkUpdates) :
-		UpdateChunksAndVisibility(&chunkUpdates);
+		UpdateChunksStill(&chunkUpdates, count) :
+		UpdateChunksAndVisibility(&chunkUpdates, count);
 
 	lastCamPos = Camera.CurrentPos;
 	lastPitch  = p->Base.Pitch;
@@ -635,22 +1327,44 @@ static void UpdateChunks(float delta) {
 	if (!samePos || chunkUpdates) ResetPartFlags();
 }
 
-static void SortMapChunks(int left, int right) {
-	struct ChunkInfo** values = sortedChunks; struct ChunkInfo* value;
-	cc_uint32* keys = distances; cc_uint32 key;
+#define SORT_RADIX_BITS 11
+#define SORT_RADIX_SIZE (1 << SORT_RADIX_BITS)
+
+/* Sorts chunks by distance, using a least significant digit first radix sort. */
+/* This always takes O(n) time, unlike comparison sorts which degrade when many chunks move. */
+/* NOTE: Offsets from camera chunk are always multiples of CHUNK_SIZE, so lowest 8 bits of the */
+/*  squared distances are always 0. (therefore only 2 passes needed for most world sizes) */
+static void SortMapChunks(cc_uint32 maxDist) {
+	static int counts[SORT_RADIX_SIZE];
+	struct ChunkInfo** values;
+	cc_uint32* keys;
+	int i, j, digit, shift, total;
 
-	while (left < right) {
-		int i = left, j = right;
-		cc_uint32 pivot = keys[(i + j) >> 1];
+	for (shift = 2 * CHUNK_SHIFT; shift < 32 && (maxDist >> shift); shift += SORT_RADIX_BITS) 
+	{
+		Mem_Set(counts, 0, sizeof(counts));
+		for (i = 0; i < chunksCount; i++) 
+		{
+			counts[(distances[i] >> shift) & (SORT_RADIX_SIZE - 1)]++;
+		}
+
+		/* Convert counts into starting offsets */
+		for (i = 0, total = 0; i < SORT_RADIX_SIZE; i++) 
+		{
+			j = counts[i]; counts[i] = total; total += j;
+		}
 
-		/* partition the list */
-		while (i <= j) {
-			while (pivot > keys[i]) i++;
-			while (pivot < keys[j]) j--;
-			QuickSort_Swap_KV_Maybe();
+		/* Scattering is stable, so order from previous passes is preserved within each digit */
+		for (i = 0; i < chunksCount; i++) 
+		{
+			digit = (distances[i] >> shift) & (SORT_RADIX_SIZE - 1);
+			j     = counts[digit]++;
+			sortedTemp[j]    = sortedChunks[i];
+			distancesTemp[j] = distances[i];
 		}
-		/* recurse into the smaller subset */
-		QuickSort_Recurse(SortMapChunks)
+
+		values = sortedTemp;    sortedTemp    = sortedChunks; sortedChunks = values;
+		keys   = distancesTemp; distancesTemp = distances;    distances    = keys;
 	}
 }
 
@@ -658,6 +1372,7 @@ static void UpdateSortOrder(void) {
 	struct ChunkInfo* info;
 	IVec3 pos;
 	int i, dx, dy, dz;
+	cc_uint32 maxDist = 0;
 
 	/* pos is centre coordinate of chunk camera is in */
 	IVec3_Floor(&pos, &Camera.CurrentPos);
@@ -675,6 +1390,7 @@ static void UpdateSortOrder(void) {
 		/* Calculate distance to chunk centre */
 		dx = info->centreX - pos.x; dy = info->centreY - pos.y; dz = info->centreZ - pos.z;
 		distances[i] = dx * dx + dy * dy + dz * dz;
+		maxDist = max(maxDist, distances[i]);
 
 		/* Consider these 3 chunks: */
 		/* |       X-1      |        X        |       X+1      | */
@@ -689,7 +1405,10 @@ static void UpdateSortOrder(void) {
 		info->drawYMin = dy >= 0; info->drawYMax = dy <= 0;
 	}
 
-	SortMapChunks(0, chunksCount - 1);
+	SortMapChunks(maxDist);
+	walkAllChunks = true;
+	/* drawXMin etc changed, which affects which sorted faces are drawn */
+	ResetTranslucentSort();
 	ResetPartFlags();
 	/*SimpleOcclusionCulling();*/
 }
@@ -698,6 +1417,7 @@ void MapRenderer_Update(float delta) {
 	if (!mapChunks) return;
 	UpdateSortOrder();
 	UpdateChunks(delta);
+	UpdateTranslucentSort();
 }
 
 
@@ -756,7 +1476,8 @@ static void OnBlockDefinitionChanged(void* obj) {
 }
 
 static void OnVisibilityChanged(void* obj) {
-	lastCamPos = Vec3_BigPos();
+	lastCamPos    = Vec3_BigPos();
+	walkAllChunks = true;
 	CalcViewDists();
 }
 static void DeleteChunks_(void* obj) { DeleteChunks(); }
@@ -10,10 +10,14 @@ CC_BEGIN_HEADER
    Copyright 2014-2023 ClassiCube | Licensed under BSD-3
 */
 struct IGameComponent;
+struct VertexTextured;
 extern struct IGameComponent MapRenderer_Component;
 
 /* Max used 1D atlases. (i.e. Atlas1D_Index(maxTextureLoc) + 1) */
 extern int MapRenderer_1DUsedCount;
+/* Total number of chunk meshes built, and total time spent building them (in Stopwatch_Measure units) */
+extern int MapRenderer_BuildCount;
+extern cc_uint64 MapRenderer_BuildTime;
 
 /* Buffer for all chunk parts. There are (MapRenderer_ChunksCount * Atlas1D_Count) parts in the buffer,
 with parts for 'normal' buffer being in lower half. */
@@ -59,8 +63,29 @@ struct ChunkInfo {
 #endif
 	struct ChunkPartInfo* normalParts;
 	struct ChunkPartInfo* translucentParts;
+#ifdef CC_BUILD_CHUNKARENA
+	cc_int16 arenaPage; /* Arena page vertices were sub-allocated from, -1 if chunk uses its own vb */
+	int arenaOffset;    /* Offset of first vertex in the arena page. Part offsets are relative to this. */
+#endif
+#ifdef CC_BUILD_SORTTRANSLUCENT
+	cc_int16 sortSlot;  /* Slot of sorted translucent faces data, negative if translucent faces are not sorted */
+#endif
 };
 
+#ifdef CC_BUILD_CHUNKARENA
+/* Attempts to sub-allocate space for the given number of vertices from the shared chunk arena. */
+/* Returns pointer to write the chunk's vertices to, or NULL if chunk must use its own vb instead. */
+struct VertexTextured* MapRenderer_AllocChunkVertices(struct ChunkInfo* info, int count);
+/* Uploads the vertices of a chunk previously allocated by MapRenderer_AllocChunkVertices. */
+void MapRenderer_UploadChunkVertices(struct ChunkInfo* info, int count);
+#endif
+#ifdef CC_BUILD_SORTTRANSLUCENT
+/* Keeps a copy of the translucent faces of the given chunk if it is near the camera, */
+/*  so that they can be sorted back to front whenever the camera moves. */
+/* vertices is used to calculate face centres, data is the vertices in Builder_VertexFormat */
+void MapRenderer_SaveTranslucent(struct ChunkInfo* info, const struct VertexTextured* vertices, const void* data);
+#endif
+
 /* Renders the meshes of non-translucent blocks in visible chunks. */
 void MapRenderer_RenderNormal(float delta);
 /* Renders the meshes of translucent blocks in visible chunks. */
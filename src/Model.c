@@ -129,8 +129,10 @@ void Model_SetupState(struct Model* model, struct Entity* e) {
 	/* then it is not using the model API properly. */
 	/* So set uScale/vScale to ridiculous defaults to make it obvious */
 	/* TODO: Remove setting this eventually */
-	Models.uScale = 100.0f;
-	Models.vScale = 100.0f;
+	Models.uScale  = 100.0f;
+	Models.vScale  = 100.0f;
+	Models.uOffset = 0.0f;
+	Models.vOffset = 0.0f;
 
 	if (!e->NoShade) {
 		Models.Cols[1] = PackedCol_Scale(col, PACKEDCOL_SHADE_YMIN);
@@ -156,8 +158,15 @@ void Model_ApplyTexture(struct Entity* e) {
 	cc_bool _64x64;
 
 	tex = model->usesHumanSkin ? e->TextureId : e->MobTextureId;
+	Models.uOffset = 0.0f;
+	Models.vOffset = 0.0f;
+
 	if (tex) {
 		Models.skinType = e->SkinType;
+		if (e->Flags & ENTITY_FLAG_SKIN_ATLAS) {
+			Models.uOffset = e->uOffset;
+			Models.vOffset = e->vOffset;
+		}
 	} else {
 		data = model->defaultTex;
 		tex  = data->texID;
@@ -222,8 +231,8 @@ void Model_DrawPart(struct ModelPart* part) {
 		dst->x = v.x; dst->y = v.y; dst->z = v.z;
 		dst->Col = Models.Cols[i >> 2];
 
-		dst->U = (v.u & UV_POS_MASK) * Models.uScale - (v.u >> UV_MAX_SHIFT) * 0.01f * Models.uScale;
-		dst->V = (v.v & UV_POS_MASK) * Models.vScale - (v.v >> UV_MAX_SHIFT) * 0.01f * Models.vScale;
+		dst->U = (v.u & UV_POS_MASK) * Models.uScale - (v.u >> UV_MAX_SHIFT) * 0.01f * Models.uScale + Models.uOffset;
+		dst->V = (v.v & UV_POS_MASK) * Models.vScale - (v.v >> UV_MAX_SHIFT) * 0.01f * Models.vScale + Models.vOffset;
 		src++; dst++;
 	}
 	model->index += count;
@@ -276,8 +285,8 @@ void Model_DrawRotate(float angleX, float angleY, float angleZ, struct ModelPart
 		dst->x = v.x + x; dst->y = v.y + y; dst->z = v.z + z;
 		dst->Col = Models.Cols[i >> 2];
 
-		dst->U = (v.u & UV_POS_MASK) * Models.uScale - (v.u >> UV_MAX_SHIFT) * 0.01f * Models.uScale;
-		dst->V = (v.v & UV_POS_MASK) * Models.vScale - (v.v >> UV_MAX_SHIFT) * 0.01f * Models.vScale;
+		dst->U = (v.u & UV_POS_MASK) * Models.uScale - (v.u >> UV_MAX_SHIFT) * 0.01f * Models.uScale + Models.uOffset;
+		dst->V = (v.v & UV_POS_MASK) * Models.vScale - (v.v >> UV_MAX_SHIFT) * 0.01f * Models.vScale + Models.vOffset;
 		src++; dst++;
 	}
 	model->index += count;
@@ -845,8 +854,8 @@ static void CustomModel_DrawArm(struct Entity* e) {
 	if (!cm->numArmParts) return;
 	Gfx_SetAlphaTest(true);
 
-	Models.uScale = 1.0f / cm->uScale;
-	Models.vScale = 1.0f / cm->vScale;
+	Models.uScale = e->uScale / cm->uScale;
+	Models.vScale = e->vScale / cm->vScale;
 	Model_LockVB(e, cm->numArmParts * MODEL_BOX_VERTICES);
 
 	for (i = 0; i < cm->numParts; i++) 
@@ -1779,6 +1788,12 @@ static void SheepModel_Draw(struct Entity* e) {
 	Model_LockVB(e, SHEEP_BODY_VERTICES + SHEEP_FUR_VERTICES);
 
 	SheepModel_DrawBody(e);
+	/* Fur uses its own texture, so can't use the skin's location within atlas */
+	/*  (same scale as Model_ApplyTexture would use for a standalone skin texture) */
+	if (e->Flags & ENTITY_FLAG_SKIN_ATLAS) {
+		Models.uOffset = 0.0f; Models.uScale = 0.015625f;
+		Models.vOffset = 0.0f; Models.vScale = Models.skinType != SKIN_64x32 ? 0.015625f : 0.03125f;
+	}
 	Model_DrawRotate(-e->Pitch * MATH_DEG2RAD, 0, 0, &fur_head, true);
 	Model_DrawPart(&fur_torso);
 	Model_DrawRotate(e->Anim.LeftLegX,  0, 0, &fur_leftLegFront,  false);
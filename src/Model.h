@@ -118,6 +118,9 @@ CC_VAR extern struct _ModelsData {
 	struct Model* Human;
 	/* Pointer to block model */
 	struct Model* Block;
+	/* U/V offset applied to skin texture when rendering models. */
+	/* (non-zero when skin is stored in a shared skin atlas page) */
+	float uOffset, vOffset;
 } Models;
 
 /* Initialises fields of a model to default. */
@@ -21,13 +21,18 @@ Copyright 2014-2023 ClassiCube | Licensed under BSD-3
 #define OPT_SENSITIVITY "mousesensitivity"
 #define OPT_FPS_LIMIT "fpslimit"
 #define OPT_DEFAULT_TEX_PACK "defaulttexpack"
+#define OPT_DECODED_CACHE "texpack-decodedcache"
+#define OPT_DECODED_CACHE_MAX_SIZE "texpack-decodedcachemax"
 #define OPT_VIEW_BOBBING "viewbobbing"
 #define OPT_ENTITY_SHADOW "entityshadow"
 #define OPT_RENDER_TYPE "normal"
 #define OPT_SMOOTH_LIGHTING "gfx-smoothlighting"
 #define OPT_LIGHTING_MODE "gfx-lightingmode"
 #define OPT_MIPMAPS "gfx-mipmaps"
+#define OPT_SCREENSHOT_MODE "screenshot-mode"
 #define OPT_CHAT_LOGGING "chat-logging"
+#define OPT_CHAT_LOG_MAX_SIZE "chat-logmaxsize"
+#define OPT_PROFILER_DUMP "profiler-dump"
 #define OPT_WINDOW_WIDTH "window-width"
 #define OPT_WINDOW_HEIGHT "window-height"
 
@@ -71,6 +76,8 @@ Copyright 2014-2023 ClassiCube | Licensed under BSD-3
 #define OPT_CLASSIC_CHAT "nostalgia-classicchat"
 #define OPT_CLASSIC_INVENTORY "nostalgia-classicinventory"
 #define OPT_MAX_CHUNK_UPDATES "gfx-maxchunkupdates"
+#define OPT_MAX_PARTICLES "gfx-maxparticles"
+#define OPT_COMPACT_CHUNKS "gfx-compactchunks"
 #define OPT_CAMERA_MASS "cameramass"
 #define OPT_CAMERA_SMOOTH "camera-smooth"
 #define OPT_GRAB_CURSOR "win-grab-cursor"
@@ -80,6 +87,9 @@ Copyright 2014-2023 ClassiCube | Licensed under BSD-3
 #define OPT_HTTP_ONLY "http-no-https"
 #define OPT_HTTPS_VERIFY "https-verify"
 #define OPT_SKIN_SERVER "http-skinserver"
+#define OPT_HTTP_WORKERS "http-workers"
+#define OPT_HTTP_PIPELINING "http-pipelining"
+#define OPT_NET_RECORD "net-record"
 #define OPT_RAW_INPUT "win-raw-input"
 #define OPT_DPI_SCALING "win-dpi-scaling"
 #define OPT_GAME_VERSION "game-version"
@@ -1,4 +1,7 @@
 #include "Particle.h"
+#ifdef CC_BUILD_SSE2
+#include <emmintrin.h>
+#endif
 #include "Block.h"
 #include "World.h"
 #include "ExtMath.h"
@@ -9,12 +12,20 @@
 #include "Funcs.h"
 #include "Game.h"
 #include "Event.h"
-
-#ifdef CC_BUILD_TINYMEM
-	#define PARTICLES_MAX 10
+#include "EnvRenderer.h"
+#include "Options.h"
+#include "Platform.h"
+
+#if defined CC_BUILD_TINYMEM
+	#define PARTICLES_DEF_MAX 10
+#elif defined CC_BUILD_LOWMEM
+	#define PARTICLES_DEF_MAX 600
 #else
-	#define PARTICLES_MAX 600
+	#define PARTICLES_DEF_MAX 4096
 #endif
+/* Max number of particles that can be drawn in one draw call */
+#define PARTICLES_BATCH (GFX_MAX_VERTICES / 4)
+static int particles_max;
 
 
 /*########################################################################################################################*
@@ -25,6 +36,18 @@ static RNGState rnd;
 static cc_bool hitTerrain;
 typedef cc_bool (*CanPassThroughFunc)(BlockID b);
 
+/* Particles are stored in structure of arrays layout, so that integrating */
+/*  positions and velocities is a simple loop over contiguous arrays */
+struct ParticleList {
+	float* data; /* Single allocation backing all the arrays below */
+	float *velX,  *velY,  *velZ;
+	float *lastX, *lastY, *lastZ;
+	float *nextX, *nextY, *nextZ;
+	float *lifetime, *size, *gravity;
+	int count, replaceIndex;
+};
+#define PARTICLE_ARRAYS 12
+
 void Particle_DoRender(const Vec2* size, const Vec3* pos, const TextureRec* rec, PackedCol col, struct VertexTextured* v) {
 	struct Matrix* view;
 	float sX, sY;
@@ -44,12 +67,116 @@ void Particle_DoRender(const Vec2* size, const Vec3* pos, const TextureRec* rec,
 	v->x = centre.x + aX - bX; v->y = centre.y + aY - bY; v->z = centre.z + aZ - bZ; v->Col = col; v->U = rec->u2; v->V = rec->v2; v++;
 }
 
-static cc_bool CollidesHor(Vec3* nextPos, BlockID block) {
-	Vec3 horPos = Vec3_Create3((float)Math_Floor(nextPos->x), 0.0f, (float)Math_Floor(nextPos->z));
-	Vec3 min, max;
-	Vec3_Add(&min, &Blocks.MinBB[block], &horPos);
-	Vec3_Add(&max, &Blocks.MaxBB[block], &horPos);
-	return nextPos->x >= min.x && nextPos->z >= min.z && nextPos->x < max.x && nextPos->z < max.z;
+static cc_bool ParticleList_Alloc(struct ParticleList* l) {
+	float* data;
+	if (l->data) return true;
+
+	data = (float*)Mem_TryAlloc(particles_max * PARTICLE_ARRAYS, sizeof(float));
+	if (!data) return false;
+	l->data = data;
+
+	l->velX  = data; data += particles_max;
+	l->velY  = data; data += particles_max;
+	l->velZ  = data; data += particles_max;
+	l->lastX = data; data += particles_max;
+	l->lastY = data; data += particles_max;
+	l->lastZ = data; data += particles_max;
+	l->nextX = data; data += particles_max;
+	l->nextY = data; data += particles_max;
+	l->nextZ = data; data += particles_max;
+	l->lifetime = data; data += particles_max;
+	l->size     = data; data += particles_max;
+	l->gravity  = data;
+	return true;
+}
+
+static void ParticleList_Free(struct ParticleList* l) {
+	Mem_Free(l->data);
+	l->data  = NULL;
+	l->count = 0;
+}
+
+/* Returns index of the slot to store a new particle in */
+/*  (when list is full, this replaces one of the existing particles) */
+static int ParticleList_Add(struct ParticleList* l) {
+	if (l->count < particles_max) return l->count++;
+
+	l->replaceIndex = (l->replaceIndex + 1) % particles_max;
+	return l->replaceIndex;
+}
+
+/* Removes the given particle by replacing it with the last particle */
+static void ParticleList_RemoveAt(struct ParticleList* l, int i) {
+	float* data = l->data;
+	int j, last = --l->count;
+
+	for (j = 0; j < PARTICLE_ARRAYS; j++, data += particles_max)
+	{
+		data[i] = data[last];
+	}
+}
+
+static void ParticleList_GetPos(struct ParticleList* l, int i, float t, Vec3* pos) {
+	pos->x = l->lastX[i] + (l->nextX[i] - l->lastX[i]) * t;
+	pos->y = l->lastY[i] + (l->nextY[i] - l->lastY[i]) * t;
+	pos->z = l->lastZ[i] + (l->nextZ[i] - l->lastZ[i]) * t;
+}
+
+static void ParticleList_SetPos(struct ParticleList* l, int i, float x, float y, float z) {
+	l->lastX[i] = x; l->nextX[i] = x;
+	l->lastY[i] = y; l->nextY[i] = y;
+	l->lastZ[i] = z; l->nextZ[i] = z;
+}
+
+/* Moves all particles forward by one tick, ignoring collisions */
+static void ParticleList_Integrate(struct ParticleList* l, float delta) {
+	float *velX  = l->velX,  *velY  = l->velY,  *velZ  = l->velZ;
+	float *nextX = l->nextX, *nextY = l->nextY, *nextZ = l->nextZ;
+	float *lifetime = l->lifetime, *gravity = l->gravity;
+	float step = delta * 3.0f;
+	int i = 0, count = l->count;
+
+	Mem_Copy(l->lastX, nextX, count * sizeof(float));
+	Mem_Copy(l->lastY, nextY, count * sizeof(float));
+	Mem_Copy(l->lastZ, nextZ, count * sizeof(float));
+
+#ifdef CC_BUILD_SSE2
+	{
+		__m128 deltas = _mm_set1_ps(delta), steps = _mm_set1_ps(step);
+		__m128 vel;
+
+		/* Integrate 4 particles at once */
+		/* (same operations as scalar loop below, so results are identical) */
+		for (; i + 4 <= count; i += 4) 
+		{
+			vel = _mm_sub_ps(_mm_loadu_ps(&velY[i]), _mm_mul_ps(_mm_loadu_ps(&gravity[i]), deltas));
+			_mm_storeu_ps(&velY[i], vel);
+
+			_mm_storeu_ps(&nextX[i], _mm_add_ps(_mm_loadu_ps(&nextX[i]), _mm_mul_ps(_mm_loadu_ps(&velX[i]), steps)));
+			_mm_storeu_ps(&nextY[i], _mm_add_ps(_mm_loadu_ps(&nextY[i]), _mm_mul_ps(vel, steps)));
+			_mm_storeu_ps(&nextZ[i], _mm_add_ps(_mm_loadu_ps(&nextZ[i]), _mm_mul_ps(_mm_loadu_ps(&velZ[i]), steps)));
+			_mm_storeu_ps(&lifetime[i], _mm_sub_ps(_mm_loadu_ps(&lifetime[i]), deltas));
+		}
+	}
+#endif
+
+	for (; i < count; i++) 
+	{
+		velY[i]     -= gravity[i] * delta;
+		nextX[i]    += velX[i] * step;
+		nextY[i]    += velY[i] * step;
+		nextZ[i]    += velZ[i] * step;
+		lifetime[i] -= delta;
+	}
+}
+
+static cc_bool CollidesHor(float x, float z, BlockID block) {
+	float minX, minZ, maxX, maxZ;
+	x = x - Math_Floor(x); z = z - Math_Floor(z);
+
+	minX = Blocks.MinBB[block].x; maxX = Blocks.MaxBB[block].x;
+	minZ = Blocks.MinBB[block].z; maxZ = Blocks.MaxBB[block].z;
+	return x >= minX && z >= minZ && x < maxX && z < maxZ;
 }
 
 static BlockID GetBlock(int x, int y, int z) {
@@ -60,79 +187,89 @@ static BlockID GetBlock(int x, int y, int z) {
 	return Env.SidesBlock;
 }
 
-static cc_bool ClipY(struct Particle* p, int y, cc_bool topFace, CanPassThroughFunc canPassThrough) {
+/* Whether there are definitely no blocks that rain blocks could collide with, */
+/*  at or below the given y in the column at the given x/z coordinates */
+static cc_bool IsAirColumnBelow(float x, int y, float z) {
+	int cx = (int)x, cz = (int)z;
+	if (y < 0 || !World_ContainsXZ(cx, cz)) return false;
+
+	return y > Weather_GetColumnHeight(cx, cz);
+}
+
+static cc_bool ClipY(struct ParticleList* l, int i, int y, cc_bool topFace, CanPassThroughFunc canPassThrough) {
 	BlockID block;
 	Vec3 minBB, maxBB;
 	float collideY;
 	cc_bool collideVer;
 
 	if (y < 0) {
-		p->nextPos.y = ENTITY_ADJUSTMENT; 
-		p->lastPos.y = ENTITY_ADJUSTMENT;
+		l->nextY[i] = ENTITY_ADJUSTMENT; 
+		l->lastY[i] = ENTITY_ADJUSTMENT;
 
-		Vec3_Set(p->velocity, 0,0,0);
+		l->velX[i] = 0; l->velY[i] = 0; l->velZ[i] = 0;
 		hitTerrain = true;
 		return false;
 	}
 
-	block = GetBlock((int)p->nextPos.x, y, (int)p->nextPos.z);
+	block = GetBlock((int)l->nextX[i], y, (int)l->nextZ[i]);
 	if (canPassThrough(block)) return true;
 	minBB = Blocks.MinBB[block]; maxBB = Blocks.MaxBB[block];
 
 	collideY   = y + (topFace ? maxBB.y : minBB.y);
-	collideVer = topFace ? (p->nextPos.y < collideY) : (p->nextPos.y > collideY);
+	collideVer = topFace ? (l->nextY[i] < collideY) : (l->nextY[i] > collideY);
 
-	if (collideVer && CollidesHor(&p->nextPos, block)) {
+	if (collideVer && CollidesHor(l->nextX[i], l->nextZ[i], block)) {
 		float adjust = topFace ? ENTITY_ADJUSTMENT : -ENTITY_ADJUSTMENT;
-		p->lastPos.y = collideY + adjust;
-		p->nextPos.y = p->lastPos.y;
+		l->lastY[i] = collideY + adjust;
+		l->nextY[i] = l->lastY[i];
 
-		Vec3_Set(p->velocity, 0,0,0);
+		l->velX[i] = 0; l->velY[i] = 0; l->velZ[i] = 0;
 		hitTerrain = true;
 		return false;
 	}
 	return true;
 }
 
-static cc_bool IntersectsBlock(struct Particle* p, CanPassThroughFunc canPassThrough) {
-	BlockID cur = GetBlock((int)p->nextPos.x, (int)p->nextPos.y, (int)p->nextPos.z);
-	float minY  = Math_Floor(p->nextPos.y) + Blocks.MinBB[cur].y;
-	float maxY  = Math_Floor(p->nextPos.y) + Blocks.MaxBB[cur].y;
+static cc_bool IntersectsBlock(float x, float y, float z, CanPassThroughFunc canPassThrough) {
+	BlockID cur = GetBlock((int)x, (int)y, (int)z);
+	float minY  = Math_Floor(y) + Blocks.MinBB[cur].y;
+	float maxY  = Math_Floor(y) + Blocks.MaxBB[cur].y;
 
-	return !canPassThrough(cur) && p->nextPos.y >= minY && p->nextPos.y < maxY && CollidesHor(&p->nextPos, cur);
+	return !canPassThrough(cur) && y >= minY && y < maxY && CollidesHor(x, z, cur);
 }
 
-static cc_bool PhysicsTick(struct Particle* p, float gravity, CanPassThroughFunc canPassThrough, float delta) {
-	Vec3 velocity;
+/* Resolves collisions of the given particle after it has been moved by ParticleList_Integrate */
+/* Returns true if the particle was inside a block before moving (and so should be removed) */
+/* NOTE: When airColumns is true, collision checks are skipped for particles in columns */
+/*  that the weather heightmap indicates are empty (only valid if any block that */
+/*  would stop rain falling down through a column also cannot be passed through) */
+static cc_bool ParticleList_Collide(struct ParticleList* l, int i, CanPassThroughFunc canPassThrough, cc_bool airColumns) {
+	float x = l->lastX[i], z = l->lastZ[i];
 	int y, begY, endY;
+	hitTerrain = false;
 
-	p->lastPos = p->nextPos;
-	if (IntersectsBlock(p, canPassThrough)) return true;
+	begY = Math_Floor(l->lastY[i]);
+	endY = Math_Floor(l->nextY[i]);
 
-	p->velocity.y -= gravity * delta;
-	begY = Math_Floor(p->nextPos.y);
-	
-	Vec3_Mul1(&velocity, &p->velocity, delta * 3.0f);
-	Vec3_Add(&p->nextPos, &p->nextPos, &velocity);
-	endY = Math_Floor(p->nextPos.y);
+	if (!airColumns || !IsAirColumnBelow(x, begY, z)) {
+		if (IntersectsBlock(x, l->lastY[i], z, canPassThrough)) return true;
+	}
+	if (airColumns && IsAirColumnBelow(l->nextX[i], min(begY, endY), l->nextZ[i])) return false;
 
-	if (p->velocity.y > 0.0f) {
+	if (l->velY[i] > 0.0f) {
 		/* don't test block we are already in */
-		for (y = begY + 1; y <= endY && ClipY(p, y, false, canPassThrough); y++) {}
+		for (y = begY + 1; y <= endY && ClipY(l, i, y, false, canPassThrough); y++) {}
 	} else {
-		for (y = begY; y >= endY && ClipY(p, y, true, canPassThrough); y--) {}
+		for (y = begY; y >= endY && ClipY(l, i, y, true, canPassThrough); y--) {}
 	}
-
-	p->lifetime -= delta;
-	return p->lifetime < 0.0f;
+	return false;
 }
 
 
 /*########################################################################################################################*
 *-------------------------------------------------------Rain particle-----------------------------------------------------*
 *#########################################################################################################################*/
-static struct Particle rain_Particles[PARTICLES_MAX];
-static int rain_count;
+static struct ParticleList rain;
 static TextureRec rain_rec = { 2.0f/128.0f, 14.0f/128.0f, 5.0f/128.0f, 16.0f/128.0f };
 
 static cc_bool RainParticle_CanPass(BlockID block) {
@@ -140,19 +277,14 @@ static cc_bool RainParticle_CanPass(BlockID block) {
 	return draw == DRAW_GAS || draw == DRAW_SPRITE;
 }
 
-static cc_bool RainParticle_Tick(struct Particle* p, float delta) {
-	hitTerrain = false;
-	return PhysicsTick(p, 3.5f, RainParticle_CanPass, delta) || hitTerrain;
-}
-
-static void RainParticle_Render(struct Particle* p, float t, struct VertexTextured* vertices) {
+static void RainParticle_Render(int i, float t, struct VertexTextured* vertices) {
 	Vec3 pos;
 	Vec2 size;
 	PackedCol col;
 	int x, y, z;
 
-	Vec3_Lerp(&pos, &p->lastPos, &p->nextPos, t);
-	size.x = p->size * 0.015625f; size.y = size.x;
+	ParticleList_GetPos(&rain, i, t, &pos);
+	size.x = rain.size[i] * 0.015625f; size.y = size.x;
 
 	x = Math_Floor(pos.x); y = Math_Floor(pos.y); z = Math_Floor(pos.z);
 	col = Lighting.Color(x, y, z);
@@ -161,58 +293,57 @@ static void RainParticle_Render(struct Particle* p, float t, struct VertexTextur
 
 static void Rain_Render(float t) {
 	struct VertexTextured* data;
-	int i;
-	if (!rain_count) return;
+	int i, beg, count;
 	
-	data = (struct VertexTextured*)Gfx_LockDynamicVb(particles_VB, 
-										VERTEX_FORMAT_TEXTURED, rain_count * 4);
-	for (i = 0; i < rain_count; i++) {
-		RainParticle_Render(&rain_Particles[i], t, data);
-		data += 4;
-	}
-
-	Gfx_BindTexture(particles_TexId);
-	Gfx_UnlockDynamicVb(particles_VB);
-	Gfx_DrawVb_IndexedTris(rain_count * 4);
-}
+	for (beg = 0; beg < rain.count; beg += PARTICLES_BATCH)
+	{
+		count = min(rain.count - beg, PARTICLES_BATCH);
+		data  = (struct VertexTextured*)Gfx_LockDynamicVb(particles_VB, 
+											VERTEX_FORMAT_TEXTURED, count * 4);
+		for (i = beg; i < beg + count; i++) {
+			RainParticle_Render(i, t, data);
+			data += 4;
+		}
 
-static void Rain_RemoveAt(int i) {
-	for (; i < rain_count - 1; i++) {
-		rain_Particles[i] = rain_Particles[i + 1];
+		Gfx_BindTexture(particles_TexId);
+		Gfx_UnlockDynamicVb(particles_VB);
+		Gfx_DrawVb_IndexedTris(count * 4);
 	}
-	rain_count--;
 }
 
 static void Rain_Tick(float delta) {
 	int i;
-	for (i = 0; i < rain_count; i++) {
-		if (RainParticle_Tick(&rain_Particles[i], delta)) {
-			Rain_RemoveAt(i); i--;
+	ParticleList_Integrate(&rain, delta);
+
+	for (i = 0; i < rain.count; i++) 
+	{
+		if (ParticleList_Collide(&rain, i, RainParticle_CanPass, true) || hitTerrain || rain.lifetime[i] < 0.0f) {
+			ParticleList_RemoveAt(&rain, i); i--;
 		}
 	}
 }
 
 void Particles_RainSnowEffect(float x, float y, float z) {
-	struct Particle* p;
-	int i, type;
+	int i, j, type;
+	if (!ParticleList_Alloc(&rain)) return;
 
 	for (i = 0; i < 2; i++) {
-		if (rain_count == PARTICLES_MAX) Rain_RemoveAt(0);
-		p = &rain_Particles[rain_count++];
+		j = ParticleList_Add(&rain);
 
-		p->velocity.x = Random_Float(&rnd) * 0.8f - 0.4f; /* [-0.4, 0.4] */
-		p->velocity.z = Random_Float(&rnd) * 0.8f - 0.4f;
-		p->velocity.y = Random_Float(&rnd) + 0.4f;
+		rain.velX[j] = Random_Float(&rnd) * 0.8f - 0.4f; /* [-0.4, 0.4] */
+		rain.velZ[j] = Random_Float(&rnd) * 0.8f - 0.4f;
+		rain.velY[j] = Random_Float(&rnd) + 0.4f;
 
-		p->lastPos.x = x + Random_Float(&rnd); /* [0.0, 1.0] */
-		p->lastPos.y = y + Random_Float(&rnd) * 0.1f + 0.01f;
-		p->lastPos.z = z + Random_Float(&rnd);
+		ParticleList_SetPos(&rain, j, 
+			x + Random_Float(&rnd), /* [0.0, 1.0] */
+			y + Random_Float(&rnd) * 0.1f + 0.01f,
+			z + Random_Float(&rnd));
 
-		p->nextPos  = p->lastPos;
-		p->lifetime = 40.0f;
+		rain.lifetime[j] = 40.0f;
+		rain.gravity[j]  = 3.5f;
 
 		type = Random_Next(&rnd, 30);
-		p->size = type >= 28 ? 2 : (type >= 25 ? 4 : 3);
+		rain.size[j] = type >= 28 ? 2 : (type >= 25 ? 4 : 3);
 	}
 }
 
@@ -221,34 +352,30 @@ void Particles_RainSnowEffect(float x, float y, float z) {
 *------------------------------------------------------Terrain particle---------------------------------------------------*
 *#########################################################################################################################*/
 struct TerrainParticle {
-	struct Particle base;
 	TextureRec rec;
 	TextureLoc texLoc;
 	BlockID block;
 };
 
-static struct TerrainParticle terrain_particles[PARTICLES_MAX];
-static int terrain_count;
-static cc_uint16 terrain_1DCount[ATLAS1D_MAX_ATLASES];
-static cc_uint16 terrain_1DIndices[ATLAS1D_MAX_ATLASES];
+static struct ParticleList terrain;
+static struct TerrainParticle* terrain_info;
+static int terrain_1DCount[ATLAS1D_MAX_ATLASES];
+static int terrain_1DIndices[ATLAS1D_MAX_ATLASES];
 
 static cc_bool TerrainParticle_CanPass(BlockID block) {
 	cc_uint8 draw = Blocks.Draw[block];
 	return draw == DRAW_GAS || draw == DRAW_SPRITE || Blocks.IsLiquid[block];
 }
 
-static cc_bool TerrainParticle_Tick(struct TerrainParticle* p, float delta) {
-	return PhysicsTick(&p->base, Blocks.ParticleGravity[p->block], TerrainParticle_CanPass, delta);
-}
-
-static void TerrainParticle_Render(struct TerrainParticle* p, float t, struct VertexTextured* vertices) {
+static void TerrainParticle_Render(int i, float t, struct VertexTextured* vertices) {
+	struct TerrainParticle* p = &terrain_info[i];
 	PackedCol col = PACKEDCOL_WHITE;
 	Vec3 pos;
 	Vec2 size;
 	int x, y, z;
 
-	Vec3_Lerp(&pos, &p->base.lastPos, &p->base.nextPos, t);
-	size.x = p->base.size * 0.015625f; size.y = size.x;
+	ParticleList_GetPos(&terrain, i, t, &pos);
+	size.x = terrain.size[i] * 0.015625f; size.y = size.x;
 	
 	if (!Blocks.Brightness[p->block]) {
 		x = Math_Floor(pos.x); y = Math_Floor(pos.y); z = Math_Floor(pos.z);
@@ -259,15 +386,15 @@ static void TerrainParticle_Render(struct TerrainParticle* p, float t, struct Ve
 	Particle_DoRender(&size, &pos, &p->rec, col, vertices);
 }
 
-static void Terrain_Update1DCounts(void) {
+static void Terrain_Update1DCounts(int beg, int count) {
 	int i, index;
 
 	for (i = 0; i < ATLAS1D_MAX_ATLASES; i++) {
 		terrain_1DCount[i]   = 0;
 		terrain_1DIndices[i] = 0;
 	}
-	for (i = 0; i < terrain_count; i++) {
-		index = Atlas1D_Index(terrain_particles[i].texLoc);
+	for (i = beg; i < beg + count; i++) {
+		index = Atlas1D_Index(terrain_info[i].texLoc);
 		terrain_1DCount[index] += 4;
 	}
 	for (i = 1; i < Atlas1D.Count; i++) {
@@ -275,22 +402,21 @@ static void Terrain_Update1DCounts(void) {
 	}
 }
 
-static void Terrain_Render(float t) {
+static void Terrain_RenderBatch(int beg, int count, float t) {
 	struct VertexTextured* data;
 	struct VertexTextured* ptr;
 	int offset = 0;
 	int i, index;
-	if (!terrain_count) return;
 
 	data = (struct VertexTextured*)Gfx_LockDynamicVb(particles_VB, 
-										VERTEX_FORMAT_TEXTURED, terrain_count * 4);
-	Terrain_Update1DCounts();
-	for (i = 0; i < terrain_count; i++) 
+										VERTEX_FORMAT_TEXTURED, count * 4);
+	Terrain_Update1DCounts(beg, count);
+	for (i = beg; i < beg + count; i++) 
 	{
-		index = Atlas1D_Index(terrain_particles[i].texLoc);
+		index = Atlas1D_Index(terrain_info[i].texLoc);
 		ptr   = data + terrain_1DIndices[index];
 
-		TerrainParticle_Render(&terrain_particles[i], t, ptr);
+		TerrainParticle_Render(i, t, ptr);
 		terrain_1DIndices[index] += 4;
 	}
 
@@ -306,24 +432,42 @@ static void Terrain_Render(float t) {
 	}
 }
 
-static void Terrain_RemoveAt(int i) {
-	for (; i < terrain_count - 1; i++) 
+static void Terrain_Render(float t) {
+	int beg;
+	for (beg = 0; beg < terrain.count; beg += PARTICLES_BATCH)
 	{
-		terrain_particles[i] = terrain_particles[i + 1];
+		Terrain_RenderBatch(beg, min(terrain.count - beg, PARTICLES_BATCH), t);
 	}
-	terrain_count--;
+}
+
+static void Terrain_RemoveAt(int i) {
+	ParticleList_RemoveAt(&terrain, i);
+	terrain_info[i] = terrain_info[terrain.count];
 }
 
 static void Terrain_Tick(float delta) {
 	int i;
-	for (i = 0; i < terrain_count; i++) 
+	ParticleList_Integrate(&terrain, delta);
+
+	for (i = 0; i < terrain.count; i++) 
 	{
-		if (TerrainParticle_Tick(&terrain_particles[i], delta)) {
+		if (ParticleList_Collide(&terrain, i, TerrainParticle_CanPass, true) || terrain.lifetime[i] < 0.0f) {
 			Terrain_RemoveAt(i); i--;
 		}
 	}
 }
 
+static cc_bool Terrain_Alloc(void) {
+	if (terrain_info) return true;
+	if (!ParticleList_Alloc(&terrain)) return false;
+
+	terrain_info = (struct TerrainParticle*)Mem_TryAlloc(particles_max, sizeof(struct TerrainParticle));
+	if (terrain_info) return true;
+
+	ParticleList_Free(&terrain);
+	return false;
+}
+
 void Particles_BreakBlockEffect(IVec3 coords, BlockID old, BlockID now) {
 	struct TerrainParticle* p;
 	TextureLoc loc;
@@ -340,9 +484,10 @@ void Particles_BreakBlockEffect(IVec3 coords, BlockID old, BlockID now) {
 	/* per-particle variables */
 	float cellX, cellY, cellZ;
 	Vec3 cell;
-	int x, y, z, type;
+	int x, y, z, i, type;
 
 	if (now != BLOCK_AIR || Blocks.Draw[old] == DRAW_GAS) return;
+	if (!Terrain_Alloc()) return;
 	IVec3_ToVec3(&origin, &coords);
 	loc = Block_Tex(old, FACE_XMIN);
 	
@@ -375,13 +520,13 @@ void Particles_BreakBlockEffect(IVec3 coords, BlockID old, BlockID now) {
 				if (cell.x < minBB.x || cell.x > maxBB.x || cell.y < minBB.y
 					|| cell.y > maxBB.y || cell.z < minBB.z || cell.z > maxBB.z) continue;
 
-				if (terrain_count == PARTICLES_MAX) Terrain_RemoveAt(0);
-				p = &terrain_particles[terrain_count++];
+				i = ParticleList_Add(&terrain);
+				p = &terrain_info[i];
 
 				/* centre random offset around [-0.2, 0.2] */
-				p->base.velocity.x = CELL_CENTRE + (cellX - 0.5f) + (Random_Float(&rnd) * 0.4f - 0.2f);
-				p->base.velocity.y = CELL_CENTRE + (cellY - 0.0f) + (Random_Float(&rnd) * 0.4f - 0.2f);
-				p->base.velocity.z = CELL_CENTRE + (cellZ - 0.5f) + (Random_Float(&rnd) * 0.4f - 0.2f);
+				terrain.velX[i] = CELL_CENTRE + (cellX - 0.5f) + (Random_Float(&rnd) * 0.4f - 0.2f);
+				terrain.velY[i] = CELL_CENTRE + (cellY - 0.0f) + (Random_Float(&rnd) * 0.4f - 0.2f);
+				terrain.velZ[i] = CELL_CENTRE + (cellZ - 0.5f) + (Random_Float(&rnd) * 0.4f - 0.2f);
 
 				rec = baseRec;
 				rec.u1 = baseRec.u1 + Random_Range(&rnd, minU, maxUsedU) * uScale;
@@ -391,34 +536,39 @@ void Particles_BreakBlockEffect(IVec3 coords, BlockID old, BlockID now) {
 				rec.u2 = min(rec.u2, maxU2) - 0.01f * uScale;
 				rec.v2 = min(rec.v2, maxV2) - 0.01f * vScale;
 		
-				Vec3_Add(&p->base.lastPos, &origin, &cell);
-				p->base.nextPos  = p->base.lastPos;
-				p->base.lifetime = 0.3f + Random_Float(&rnd) * 1.2f;
+				ParticleList_SetPos(&terrain, i, origin.x + cell.x, origin.y + cell.y, origin.z + cell.z);
+				terrain.lifetime[i] = 0.3f + Random_Float(&rnd) * 1.2f;
+				terrain.gravity[i]  = Blocks.ParticleGravity[old];
 
 				p->rec    = rec;
 				p->texLoc = loc;
 				p->block  = old;
 				type = Random_Next(&rnd, 30);
-				p->base.size = type >= 28 ? 12 : (type >= 25 ? 10 : 8);
+				terrain.size[i] = type >= 28 ? 12 : (type >= 25 ? 10 : 8);
 			}
 		}
 	}
 }
 
+static void Terrain_Free(void) {
+	ParticleList_Free(&terrain);
+	Mem_Free(terrain_info);
+	terrain_info = NULL;
+}
+
 
 /*########################################################################################################################*
 *-------------------------------------------------------Custom particle---------------------------------------------------*
 *#########################################################################################################################*/
 #ifdef CC_BUILD_NETWORKING
 struct CustomParticle {
-	struct Particle base;
-	int effectId;
 	float totalLifespan;
+	cc_uint8 effectId;
 };
 
 struct CustomParticleEffect Particles_CustomEffects[256];
-static struct CustomParticle custom_particles[PARTICLES_MAX];
-static int custom_count;
+static struct ParticleList custom;
+static struct CustomParticle* custom_info;
 static cc_uint8 collideFlags;
 #define EXPIRES_UPON_TOUCHING_GROUND (1 << 0)
 #define SOLID_COLLIDES  (1 << 1)
@@ -437,16 +587,8 @@ static cc_bool CustomParticle_CanPass(BlockID block) {
 	return true;
 }
 
-static cc_bool CustomParticle_Tick(struct CustomParticle* p, float delta) {
-	struct CustomParticleEffect* e = &Particles_CustomEffects[p->effectId];
-	hitTerrain   = false;
-	collideFlags = e->collideFlags;
-
-	return PhysicsTick(&p->base, e->gravity, CustomParticle_CanPass, delta)
-		|| (hitTerrain && (e->collideFlags & EXPIRES_UPON_TOUCHING_GROUND));
-}
-
-static void CustomParticle_Render(struct CustomParticle* p, float t, struct VertexTextured* vertices) {
+static void CustomParticle_Render(int i, float t, struct VertexTextured* vertices) {
+	struct CustomParticle* p       = &custom_info[i];
 	struct CustomParticleEffect* e = &Particles_CustomEffects[p->effectId];
 	Vec3 pos;
 	Vec2 size;
@@ -454,15 +596,15 @@ static void CustomParticle_Render(struct CustomParticle* p, float t, struct Vert
 	TextureRec rec = e->rec;
 	int x, y, z;
 
-	float time_lived = p->totalLifespan - p->base.lifetime;
+	float time_lived = p->totalLifespan - custom.lifetime[i];
 	int curFrame = Math_Floor(e->frameCount * (time_lived / p->totalLifespan));
 	float shiftU = curFrame * (rec.u2 - rec.u1);
 
 	rec.u1 += shiftU;/* * 0.0078125f; */
 	rec.u2 += shiftU;/* * 0.0078125f; */
 
-	Vec3_Lerp(&pos, &p->base.lastPos, &p->base.nextPos, t);
-	size.x = p->base.size; size.y = size.x;
+	ParticleList_GetPos(&custom, i, t, &pos);
+	size.x = custom.size[i]; size.y = size.x;
 
 	x = Math_Floor(pos.x); y = Math_Floor(pos.y); z = Math_Floor(pos.z);
 	col = e->fullBright ? PACKEDCOL_WHITE : Lighting.Color(x, y, z);
@@ -473,51 +615,77 @@ static void CustomParticle_Render(struct CustomParticle* p, float t, struct Vert
 
 static void Custom_Render(float t) {
 	struct VertexTextured* data;
-	int i;
-	if (!custom_count) return;
+	int i, beg, count;
 
-	data = (struct VertexTextured*)Gfx_LockDynamicVb(particles_VB, 
-										VERTEX_FORMAT_TEXTURED, custom_count * 4);
-	for (i = 0; i < custom_count; i++) {
-		CustomParticle_Render(&custom_particles[i], t, data);
-		data += 4;
-	}
+	for (beg = 0; beg < custom.count; beg += PARTICLES_BATCH)
+	{
+		count = min(custom.count - beg, PARTICLES_BATCH);
+		data  = (struct VertexTextured*)Gfx_LockDynamicVb(particles_VB, 
+											VERTEX_FORMAT_TEXTURED, count * 4);
+		for (i = beg; i < beg + count; i++) {
+			CustomParticle_Render(i, t, data);
+			data += 4;
+		}
 
-	Gfx_BindTexture(particles_TexId);
-	Gfx_UnlockDynamicVb(particles_VB);
-	Gfx_DrawVb_IndexedTris(custom_count * 4);
+		Gfx_BindTexture(particles_TexId);
+		Gfx_UnlockDynamicVb(particles_VB);
+		Gfx_DrawVb_IndexedTris(count * 4);
+	}
 }
 
 static void Custom_RemoveAt(int i) {
-	for (; i < custom_count - 1; i++) {
-		custom_particles[i] = custom_particles[i + 1];
-	}
-	custom_count--;
+	ParticleList_RemoveAt(&custom, i);
+	custom_info[i] = custom_info[custom.count];
 }
 
 static void Custom_Tick(float delta) {
+	struct CustomParticleEffect* e;
+	cc_bool expired;
 	int i;
-	for (i = 0; i < custom_count; i++) {
-		if (CustomParticle_Tick(&custom_particles[i], delta)) {
-			Custom_RemoveAt(i); i--;
-		}
+	ParticleList_Integrate(&custom, delta);
+
+	for (i = 0; i < custom.count; i++) 
+	{
+		e = &Particles_CustomEffects[custom_info[i].effectId];
+		collideFlags = e->collideFlags;
+
+		/* Can't skip air columns, as e.g. invisible blocks may still stop custom particles */
+		expired = ParticleList_Collide(&custom, i, CustomParticle_CanPass, false) || custom.lifetime[i] < 0.0f
+			|| (hitTerrain && (e->collideFlags & EXPIRES_UPON_TOUCHING_GROUND));
+		if (expired) { Custom_RemoveAt(i); i--; }
 	}
 }
 
+static cc_bool Custom_Alloc(void) {
+	if (custom_info) return true;
+	if (!ParticleList_Alloc(&custom)) return false;
+
+	custom_info = (struct CustomParticle*)Mem_TryAlloc(particles_max, sizeof(struct CustomParticle));
+	if (custom_info) return true;
+
+	ParticleList_Free(&custom);
+	return false;
+}
+
+static void Custom_Free(void) {
+	ParticleList_Free(&custom);
+	Mem_Free(custom_info);
+	custom_info = NULL;
+}
+
 void Particles_CustomEffect(int effectID, float x, float y, float z, float originX, float originY, float originZ) {
-	struct CustomParticle* p;
 	struct CustomParticleEffect* e = &Particles_CustomEffects[effectID];
-	int i, count = e->particleCount;
-	Vec3 offset, delta, origin;
-	float d;
+	int i, j, count = e->particleCount;
+	Vec3 offset, delta, origin, pos;
+	float d, lifetime;
 
+	if (!Custom_Alloc()) return;
 	origin.x = originX; origin.y = originY; origin.z = originZ;
 
 	for (i = 0; i < count; i++) 
 	{
-		if (custom_count == PARTICLES_MAX) Custom_RemoveAt(0);
-		p = &custom_particles[custom_count++];
-		p->effectId = effectID;
+		j = ParticleList_Add(&custom);
+		custom_info[j].effectId = effectID;
 
 		offset.x = Random_Float(&rnd) - 0.5f;
 		offset.y = Random_Float(&rnd) - 0.5f;
@@ -530,34 +698,37 @@ void Particles_CustomEffect(int effectID, float x, float y, float z, float origi
 		d  = Math_Exp2(Math_Log2(d) / 3.0); /* d^1/3 for better distribution */
 		d *= e->spread;
 
-		p->base.lastPos.x = x + offset.x * d;
-		p->base.lastPos.y = y + offset.y * d;
-		p->base.lastPos.z = z + offset.z * d;
+		pos.x = x + offset.x * d;
+		pos.y = y + offset.y * d;
+		pos.z = z + offset.z * d;
+		ParticleList_SetPos(&custom, j, pos.x, pos.y, pos.z);
 		
-		Vec3_Sub(&delta, &p->base.lastPos, &origin);
+		Vec3_Sub(&delta, &pos, &origin);
 		Vec3_Normalise(&delta);
 
-		p->base.velocity.x = delta.x * e->speed;
-		p->base.velocity.y = delta.y * e->speed;
-		p->base.velocity.z = delta.z * e->speed;
+		custom.velX[j] = delta.x * e->speed;
+		custom.velY[j] = delta.y * e->speed;
+		custom.velZ[j] = delta.z * e->speed;
 
-		p->base.nextPos  = p->base.lastPos;
-		p->base.lifetime = e->baseLifetime + (e->baseLifetime * e->lifetimeVariation) * ((Random_Float(&rnd) - 0.5f) * 2);
-		p->totalLifespan = p->base.lifetime;
+		lifetime = e->baseLifetime + (e->baseLifetime * e->lifetimeVariation) * ((Random_Float(&rnd) - 0.5f) * 2);
+		custom.lifetime[j] = lifetime;
+		custom.gravity[j]  = e->gravity;
+		custom_info[j].totalLifespan = lifetime;
 
-		p->base.size = e->size + (e->size * e->sizeVariation) * ((Random_Float(&rnd) - 0.5f) * 2);
+		custom.size[j] = e->size + (e->size * e->sizeVariation) * ((Random_Float(&rnd) - 0.5f) * 2);
 
 		/* Don't spawn custom particle inside a block (otherwise it appears */
 		/*   for a few frames, then disappears in first PhysicsTick call)*/
 		collideFlags = e->collideFlags;
-		if (IntersectsBlock(&p->base, CustomParticle_CanPass)) custom_count--;
+		if (IntersectsBlock(pos.x, pos.y, pos.z, CustomParticle_CanPass)) Custom_RemoveAt(j);
 	}
 }
 #else
-static int custom_count;
+static struct ParticleList custom;
 
 static void Custom_Render(float t) { }
 static void Custom_Tick(float delta) { }
+static void Custom_Free(void) { }
 #endif
 
 
@@ -565,11 +736,11 @@ static void Custom_Tick(float delta) { }
 *--------------------------------------------------------Particles--------------------------------------------------------*
 *#########################################################################################################################*/
 void Particles_Render(float t) {
-	if (!terrain_count && !rain_count && !custom_count) return;
+	if (!terrain.count && !rain.count && !custom.count) return;
 
 	if (Gfx.LostContext) return;
 	if (!particles_VB)
-		particles_VB = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, PARTICLES_MAX * 4);
+		particles_VB = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, min(particles_max, PARTICLES_BATCH) * 4);
 
 	Gfx_SetAlphaTest(true);
 
@@ -610,6 +781,7 @@ static void OnBreakBlockEffect_Handler(void* obj, IVec3 coords, BlockID old, Blo
 }
 
 static void OnInit(void) {
+	particles_max = Options_GetInt(OPT_MAX_PARTICLES, 10, 65536, PARTICLES_DEF_MAX);
 	ScheduledTask_Add(GAME_DEF_TICKS, Particles_Tick);
 	Random_SeedFromCurrentTime(&rnd);
 	TextureEntry_Register(&particles_entry);
@@ -618,9 +790,14 @@ static void OnInit(void) {
 	Event_Register_(&GfxEvents.ContextLost,   NULL, OnContextLost);
 }
 
-static void OnFree(void) { OnContextLost(NULL); }
+static void OnFree(void) { 
+	OnContextLost(NULL);
+	ParticleList_Free(&rain);
+	Terrain_Free();
+	Custom_Free();
+}
 
-static void OnReset(void) { rain_count = 0; terrain_count = 0; custom_count = 0; }
+static void OnReset(void) { rain.count = 0; terrain.count = 0; custom.count = 0; }
 
 struct IGameComponent Particles_Component = {
 	OnInit,  /* Init  */
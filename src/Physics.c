@@ -149,17 +149,64 @@ static void Searcher_QuickSort(int left, int right) {
 	}
 }
 
+/* Sorts states that are already mostly in order (see Searcher_FindReachableBlocks) */
+/*  in close to linear time, falling back to quicksort when there are lots of states */
+#define SEARCHER_INSERTION_MAX 256
+static void Searcher_Sort(int count) {
+	struct SearcherState* keys = Searcher_States; struct SearcherState key;
+	int i, j;
+	if (count > SEARCHER_INSERTION_MAX) { Searcher_QuickSort(0, count - 1); return; }
+
+	for (i = 1; i < count; i++) 
+	{
+		key = keys[i];
+		for (j = i; j > 0 && keys[j - 1].tSquared > key.tSquared; j--) 
+		{
+			keys[j] = keys[j - 1];
+		}
+		keys[j] = key;
+	}
+}
+
+#define SEARCHER_TIMES_MIN 96
+static float searcherDefaultTimes[SEARCHER_TIMES_MIN];
+static cc_uint32 searcherTimesCapacity = SEARCHER_TIMES_MIN;
+static float* searcherTimes = searcherDefaultTimes;
+
+/* Calculates time for the entity to reach each block along an axis, in the order blocks are reached */
+/* NOTE: Must produce exactly the same results as Searcher_CalcTime does for a whole block */
+static void Searcher_CalcAxisTimes(float* times, int beg, int len, int step, float vel, float entityMin, float entityMax) {
+	float blockMin, blockMax;
+	int i;
+
+	for (i = 0; i < len; i++, beg += step) 
+	{
+		blockMin = (float)beg;
+		blockMax = 1.0f + blockMin;
+
+		if (entityMax >= blockMin && entityMin <= blockMax) {
+			times[i] = 0.0f;
+		} else if (vel == 0.0f) {
+			times[i] = MATH_LARGENUM;
+		} else {
+			times[i] = Math_AbsF((vel > 0.0f ? blockMin - entityMax : entityMin - blockMax) / vel);
+		}
+	}
+}
+
 int Searcher_FindReachableBlocks(struct Entity* entity, struct AABB* entityBB, struct AABB* entityExtentBB) {
 	Vec3 vel = entity->Velocity;
-	IVec3 min, max;
-	cc_uint32 elements;
+	IVec3 min, max, beg, len, step;
+	cc_uint32 elements, axes;
 	struct SearcherState* curState;
+	float* timesX; float* timesY; float* timesZ;
+	cc_bool inside;
 	int count;
 
 	BlockID block;
 	struct AABB blockBB;
 	float xx, yy, zz, tx, ty, tz;
-	int x, y, z;
+	int i, j, k, x, y, z;
 
 	Entity_GetBounds(entity, entityBB);
 	/* Exact maximum extent the entity can reach, and the equivalent map coordinates. */
@@ -182,21 +229,49 @@ int Searcher_FindReachableBlocks(struct Entity* entity, struct AABB* entityBB, s
 	}
 	curState = Searcher_States;
 
+	len.x = max.x - min.x + 1; len.y = max.y - min.y + 1; len.z = max.z - min.z + 1;
+	axes  = len.x + len.y + len.z;
+
+	if (axes > searcherTimesCapacity) {
+		if (searcherTimes != searcherDefaultTimes) Mem_Free(searcherTimes);
+		searcherTimesCapacity = axes;
+		searcherTimes = (float*)Mem_Alloc(axes, sizeof(float), "collision search times");
+	}
+	timesX = searcherTimes; timesY = timesX + len.x; timesZ = timesY + len.y;
+
+	/* Walk through the swept area in the direction the entity is moving, so blocks are */
+	/*  mostly visited in the order they would be reached (and so need very little sorting) */
+	beg.x = vel.x < 0.0f ? max.x : min.x; step.x = vel.x < 0.0f ? -1 : 1;
+	beg.y = vel.y < 0.0f ? max.y : min.y; step.y = vel.y < 0.0f ? -1 : 1;
+	beg.z = vel.z < 0.0f ? max.z : min.z; step.z = vel.z < 0.0f ? -1 : 1;
+
+	/* Time to reach a whole block only depends on its position along each axis */
+	Searcher_CalcAxisTimes(timesX, beg.x, len.x, step.x, vel.x, entityBB->Min.x, entityBB->Max.x);
+	Searcher_CalcAxisTimes(timesY, beg.y, len.y, step.y, vel.y, entityBB->Min.y, entityBB->Max.y);
+	Searcher_CalcAxisTimes(timesZ, beg.z, len.z, step.z, vel.z, entityBB->Min.z, entityBB->Max.z);
+	inside = min.y >= 0 && max.y < World.Height && World_ContainsXZ(min.x, min.z) && World_ContainsXZ(max.x, max.z);
+
 	/* Order loops so that we minimise cache misses */
-	for (y = min.y; y <= max.y; y++) {
-		for (z = min.z; z <= max.z; z++) {
-			for (x = min.x; x <= max.x; x++) {
-				block = World_GetPhysicsBlock(x, y, z);
+	for (j = 0, y = beg.y; j < len.y; j++, y += step.y) {
+		for (k = 0, z = beg.z; k < len.z; k++, z += step.z) {
+			for (i = 0, x = beg.x; i < len.x; i++, x += step.x) {
+				block = inside ? World_GetBlock(x, y, z) : World_GetPhysicsBlock(x, y, z);
 				if (Blocks.Collide[block] != COLLIDE_SOLID) continue;
 
-				xx = (float)x; yy = (float)y; zz = (float)z;
-				blockBB.Min = Blocks.MinBB[block];
-				blockBB.Min.x += xx; blockBB.Min.y += yy; blockBB.Min.z += zz;
-				blockBB.Max = Blocks.MaxBB[block];
-				blockBB.Max.x += xx; blockBB.Max.y += yy; blockBB.Max.z += zz;
-
-				if (!AABB_Intersects(entityExtentBB, &blockBB)) continue; /* necessary for non whole blocks. (slabs) */
-				Searcher_CalcTime(&vel, entityBB, &blockBB, &tx, &ty, &tz);
+				/* Whole blocks always intersect the extent, so can use precalculated times */
+				if (Blocks.MinBB[block].x == 0.0f && Blocks.MinBB[block].y == 0.0f && Blocks.MinBB[block].z == 0.0f &&
+					Blocks.MaxBB[block].x == 1.0f && Blocks.MaxBB[block].y == 1.0f && Blocks.MaxBB[block].z == 1.0f) {
+					tx = timesX[i]; ty = timesY[j]; tz = timesZ[k];
+				} else {
+					xx = (float)x; yy = (float)y; zz = (float)z;
+					blockBB.Min = Blocks.MinBB[block];
+					blockBB.Min.x += xx; blockBB.Min.y += yy; blockBB.Min.z += zz;
+					blockBB.Max = Blocks.MaxBB[block];
+					blockBB.Max.x += xx; blockBB.Max.y += yy; blockBB.Max.z += zz;
+
+					if (!AABB_Intersects(entityExtentBB, &blockBB)) continue; /* necessary for non whole blocks. (slabs) */
+					Searcher_CalcTime(&vel, entityBB, &blockBB, &tx, &ty, &tz);
+				}
 				if (tx > 1.0f || ty > 1.0f || tz > 1.0f) continue;
 
 				curState->x = (x << 3) | (block  & 0x007);
@@ -209,7 +284,7 @@ int Searcher_FindReachableBlocks(struct Entity* entity, struct AABB* entityBB, s
 	}
 
 	count = (int)(curState - Searcher_States);
-	if (count) Searcher_QuickSort(0, count - 1);
+	Searcher_Sort(count);
 	return count;
 }
 
@@ -241,4 +316,8 @@ void Searcher_Free(void) {
 	if (Searcher_States != searcherDefaultStates) Mem_Free(Searcher_States);
 	Searcher_States  = searcherDefaultStates;
 	searcherCapacity = SEARCHER_STATES_MIN;
+
+	if (searcherTimes != searcherDefaultTimes) Mem_Free(searcherTimes);
+	searcherTimes         = searcherDefaultTimes;
+	searcherTimesCapacity = SEARCHER_TIMES_MIN;
 }
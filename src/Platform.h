@@ -274,11 +274,11 @@ cc_result File_Write(cc_file file, const void* data, cc_uint32 count, cc_uint32*
 /* Attempts to close the given file. */
 cc_result File_Close(cc_file file);
 /* Attempts to seek to a position in the given file. */
-cc_result File_Seek(cc_file file, int offset, int seekType);
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType);
 /* Attempts to get the current position in the given file. */
-cc_result File_Position(cc_file file, cc_uint32* pos);
+cc_result File_Position(cc_file file, cc_uint64* pos);
 /* Attempts to retrieve the length of the given file. */
-cc_result File_Length(cc_file file, cc_uint32* len);
+cc_result File_Length(cc_file file, cc_uint64* len);
 
 
 /*########################################################################################################################*
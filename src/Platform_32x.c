@@ -155,15 +155,15 @@ cc_result File_Close(cc_file file) {
 	return ERR_NOT_SUPPORTED;
 }
 
-cc_result File_Seek(cc_file file, int offset, int seekType) {	
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType) {	
 	return ERR_NOT_SUPPORTED;
 }
 
-cc_result File_Position(cc_file file, cc_uint32* pos) {
+cc_result File_Position(cc_file file, cc_uint64* pos) {
 	return ERR_NOT_SUPPORTED;
 }
 
-cc_result File_Length(cc_file file, cc_uint32* len) {
+cc_result File_Length(cc_file file, cc_uint64* len) {
 	return ERR_NOT_SUPPORTED;
 }
 
@@ -367,20 +367,20 @@ cc_result File_Close(cc_file file) {
 	return res == -1 ? errno : 0;
 }
 
-cc_result File_Seek(cc_file file, int offset, int seekType) {
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType) {
 	static cc_uint8 modes[3] = { SEEK_SET, SEEK_CUR, SEEK_END };
 	
 	int res = fs_seek(file, offset, modes[seekType]);
 	return res == -1 ? errno : 0;
 }
 
-cc_result File_Position(cc_file file, cc_uint32* pos) {
+cc_result File_Position(cc_file file, cc_uint64* pos) {
 	int res = fs_seek(file, 0, SEEK_CUR);
 	*pos    = res;
 	return res == -1 ? errno : 0;
 }
 
-cc_result File_Length(cc_file file, cc_uint32* len) {
+cc_result File_Length(cc_file file, cc_uint64* len) {
 	int res = fs_total(file);
 	*len    = res;
 	return res == -1 ? errno : 0;
@@ -305,7 +305,7 @@ cc_result File_Close(cc_file file) {
 	return PBCloseSync(&pb);
 }
 
-cc_result File_Seek(cc_file file, int offset, int seekType) {
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType) {
 	static cc_uint8 modes[] = { fsFromStart, fsFromMark, fsFromLEOF };
 	ParamBlockRec pb;
 	pb.ioParam.ioRefNum    = file;
@@ -315,7 +315,7 @@ cc_result File_Seek(cc_file file, int offset, int seekType) {
 	return PBSetFPosSync(&pb);
 }
 
-cc_result File_Position(cc_file file, cc_uint32* pos) {
+cc_result File_Position(cc_file file, cc_uint64* pos) {
 	ParamBlockRec pb;
 	pb.ioParam.ioRefNum = file;
 
@@ -324,7 +324,7 @@ cc_result File_Position(cc_file file, cc_uint32* pos) {
 	return err;
 }
 
-cc_result File_Length(cc_file file, cc_uint32* len) {
+cc_result File_Length(cc_file file, cc_uint64* len) {
 	ParamBlockRec pb;
 	pb.ioParam.ioRefNum = file;
 
@@ -151,12 +151,12 @@ cc_result File_Close(cc_file file) {
 	return dfs_close(file);
 }
 
-cc_result File_Seek(cc_file file, int offset, int seekType) {
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType) {
 	static cc_uint8 modes[3] = { SEEK_SET, SEEK_CUR, SEEK_END };
 	return dfs_seek(file, offset, modes[seekType]);
 }
 
-cc_result File_Position(cc_file file, cc_uint32* pos) {
+cc_result File_Position(cc_file file, cc_uint64* pos) {
 	int ret = dfs_tell(file);
 	if (ret < 0) { *pos = -1; return ret; }
 	
@@ -164,7 +164,7 @@ cc_result File_Position(cc_file file, cc_uint32* pos) {
 	return 0;
 }
 
-cc_result File_Length(cc_file file, cc_uint32* len) {
+cc_result File_Length(cc_file file, cc_uint64* len) {
 	int ret = dfs_size(file);
 	if (ret < 0) { *len = -1; return ret; }
 	
@@ -241,20 +241,20 @@ cc_result File_Close(cc_file file) {
 	return res < 0 ? res : 0;
 }
 
-cc_result File_Seek(cc_file file, int offset, int seekType) {
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType) {
 	static cc_uint8 modes[3] = { SEEK_SET, SEEK_CUR, SEEK_END };
 	
 	int res = fioLseek(file, offset, modes[seekType]);
 	return res < 0 ? res : 0;
 }
 
-cc_result File_Position(cc_file file, cc_uint32* pos) {
+cc_result File_Position(cc_file file, cc_uint64* pos) {
 	int res = fioLseek(file, 0, SEEK_CUR);
 	*pos    = res;
 	return res < 0 ? res : 0;
 }
 
-cc_result File_Length(cc_file file, cc_uint32* len) {
+cc_result File_Length(cc_file file, cc_uint64* len) {
 	int cur_pos = fioLseek(file, 0, SEEK_CUR);
 	if (cur_pos < 0) return cur_pos; // error occurred
 	
@@ -205,13 +205,13 @@ cc_result File_Close(cc_file file) {
 	return sysLv2FsClose(file);
 }
 
-cc_result File_Seek(cc_file file, int offset, int seekType) {
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType) {
 	static cc_uint8 modes[] = { SEEK_SET, SEEK_CUR, SEEK_END };
 	u64 position = 0;
 	return sysLv2FsLSeek64(file, offset, modes[seekType], &position);
 }
 
-cc_result File_Position(cc_file file, cc_uint32* pos) {
+cc_result File_Position(cc_file file, cc_uint64* pos) {
 	u64 position = 0;
 	int res = sysLv2FsLSeek64(file, 0, SEEK_CUR, &position);
 	
@@ -219,7 +219,7 @@ cc_result File_Position(cc_file file, cc_uint32* pos) {
 	return res;
 }
 
-cc_result File_Length(cc_file file, cc_uint32* len) {
+cc_result File_Length(cc_file file, cc_uint64* len) {
 	sysFSStat st;
 	int res = sysLv2FsFStat(file, &st);
 	
@@ -183,20 +183,20 @@ cc_result File_Close(cc_file file) {
 	return GetSCEResult(result);
 }
 
-cc_result File_Seek(cc_file file, int offset, int seekType) {
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType) {
 	static cc_uint8 modes[3] = { PSP_SEEK_SET, PSP_SEEK_CUR, PSP_SEEK_END };
 	
 	int result = sceIoLseek32(file, offset, modes[seekType]);
 	return GetSCEResult(result);
 }
 
-cc_result File_Position(cc_file file, cc_uint32* pos) {
+cc_result File_Position(cc_file file, cc_uint64* pos) {
 	int result = sceIoLseek32(file, 0, PSP_SEEK_CUR);
 	*pos       = result;
 	return GetSCEResult(result);
 }
 
-cc_result File_Length(cc_file file, cc_uint32* len) {
+cc_result File_Length(cc_file file, cc_uint64* len) {
 	int curPos = sceIoLseek32(file, 0, PSP_SEEK_CUR);
 	if (curPos < 0) { *len = -1; return GetSCEResult(curPos); }
 	
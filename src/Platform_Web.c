@@ -204,14 +204,14 @@ cc_result File_Close(cc_file file) {
 }
 
 extern int interop_FileSeek(int fd, int offset, int whence);
-cc_result File_Seek(cc_file file, int offset, int seekType) {
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType) {
 	/* returned result is negative for error */
 	int res = interop_FileSeek(file, offset, seekType);
 	/* FileSeek returns current position, discard that */
 	return res >= 0 ? 0 : -res;
 }
 
-cc_result File_Position(cc_file file, cc_uint32* pos) {
+cc_result File_Position(cc_file file, cc_uint64* pos) {
 	/* FILE_SEEKFROM_CURRENT is same as SEEK_CUR */
 	int res = interop_FileSeek(file, 0, FILE_SEEKFROM_CURRENT);
 	/* returned result is negative for error */
@@ -223,7 +223,7 @@ cc_result File_Position(cc_file file, cc_uint32* pos) {
 }
 
 extern int interop_FileLength(int fd);
-cc_result File_Length(cc_file file, cc_uint32* len) {
+cc_result File_Length(cc_file file, cc_uint64* len) {
 	int res = interop_FileLength(file);
 	/* returned result is negative for error */
 	if (res >= 0) {
@@ -392,20 +392,30 @@ cc_result File_Close(cc_file file) {
 	return CloseHandle(file) ? 0 : GetLastError();
 }
 
-cc_result File_Seek(cc_file file, int offset, int seekType) {
+cc_result File_Seek(cc_file file, cc_int64 offset, int seekType) {
 	static cc_uint8 modes[] = { FILE_BEGIN, FILE_CURRENT, FILE_END };
-	DWORD pos = SetFilePointer(file, offset, NULL, modes[seekType]);
+	LONG hi   = (LONG)(offset >> 32);
+	DWORD pos = SetFilePointer(file, (LONG)offset, &hi, modes[seekType]);
+	/* Low 32 bits of a valid position may be INVALID_SET_FILE_POINTER, GetLastError is NO_ERROR then */
 	return pos != INVALID_SET_FILE_POINTER ? 0 : GetLastError();
 }
 
-cc_result File_Position(cc_file file, cc_uint32* pos) {
-	*pos = SetFilePointer(file, 0, NULL, FILE_CURRENT);
-	return *pos != INVALID_SET_FILE_POINTER ? 0 : GetLastError();
+cc_result File_Position(cc_file file, cc_uint64* pos) {
+	LONG hi   = 0;
+	DWORD raw = SetFilePointer(file, 0, &hi, FILE_CURRENT);
+	cc_result res = raw != INVALID_SET_FILE_POINTER ? 0 : GetLastError();
+
+	*pos = ((cc_uint64)(DWORD)hi << 32) | raw;
+	return res;
 }
 
-cc_result File_Length(cc_file file, cc_uint32* len) {
-	*len = GetFileSize(file, NULL);
-	return *len != INVALID_FILE_SIZE ? 0 : GetLastError();
+cc_result File_Length(cc_file file, cc_uint64* len) {
+	DWORD hi  = 0;
+	DWORD raw = GetFileSize(file, &hi);
+	cc_result res = raw != INVALID_FILE_SIZE ? 0 : GetLastError();
+
+	*len = ((cc_uint64)hi << 32) | raw;
+	return res;
 }
 
 
@@ -0,0 +1,449 @@
+#include "Core.h"
+#ifdef CC_BUILD_PROFILER
+#include "Profiler.h"
+#include "Platform.h"
+#include "String.h"
+#include "Stream.h"
+#include "Chat.h"
+#include "Commands.h"
+#include "Game.h"
+#include "Options.h"
+#include "Logger.h"
+#include "Funcs.h"
+
+/* Each thread records its zones into its own ring buffer, so threads never contend */
+/*  with each other (the lock is only contended while a profile is being dumped) */
+#define PROFILER_MAX_THREADS 32
+#define PROFILER_MAX_EVENTS  16384 /* Oldest zones are overwritten once this is reached */
+#define PROFILER_MAX_DEPTH   32
+
+#if defined _MSC_VER
+	#define PROFILER_THREADLOCAL __declspec(thread)
+#else
+	#define PROFILER_THREADLOCAL __thread
+#endif
+
+struct ProfilerZone {
+	const char* name;
+	cc_uint64 beg, end;
+	int depth;
+};
+
+struct ProfilerThread {
+	struct ProfilerZone zones[PROFILER_MAX_EVENTS];
+	cc_uint32 count; /* Total number of zones ever recorded */
+	const char* name;
+	void* mutex;
+	int depth;
+	cc_bool exited;  /* Whether the thread exited, so this can be reused by a new thread */
+	const char* stackNames[PROFILER_MAX_DEPTH];
+	cc_uint64 stackBegs[PROFILER_MAX_DEPTH];
+};
+
+static struct ProfilerThread* profiler_threads[PROFILER_MAX_THREADS];
+static int profiler_threadsCount;
+static void* profiler_mutex;
+static PROFILER_THREADLOCAL struct ProfilerThread* profiler_cur;
+static cc_bool profiler_full, profiler_overlay;
+static cc_uint64 profiler_overlayBeg;
+
+
+/*########################################################################################################################*
+*----------------------------------------------------------Zones----------------------------------------------------------*
+*#########################################################################################################################*/
+/* Reuses the history of a thread that has exited, to avoid short lived threads */
+/*  (e.g. map generation) each permanently using up one of the thread slots */
+static struct ProfilerThread* Profiler_ReuseThread(void) {
+	struct ProfilerThread* thread = NULL;
+	int i;
+
+	Mutex_Lock(profiler_mutex);
+	{
+		for (i = 0; i < profiler_threadsCount; i++) 
+		{
+			if (!profiler_threads[i]->exited) continue;
+			thread = profiler_threads[i];
+			thread->exited = false;
+			break;
+		}
+	}
+	Mutex_Unlock(profiler_mutex);
+	if (!thread) return NULL;
+
+	/* Zones of the exited thread are discarded, as they would otherwise be shown under this thread's name */
+	Mutex_Lock(thread->mutex);
+	{
+		thread->count = 0;
+		thread->depth = 0;
+		thread->name  = NULL;
+	}
+	Mutex_Unlock(thread->mutex);
+	return thread;
+}
+
+static struct ProfilerThread* Profiler_GetThread(void) {
+	struct ProfilerThread* thread = profiler_cur;
+	if (thread) return thread;
+	/* Zones started before profiler component was initialised are ignored */
+	if (!profiler_mutex) return NULL;
+
+	thread = Profiler_ReuseThread();
+	if (thread) { profiler_cur = thread; return thread; }
+	if (profiler_full) return NULL;
+
+	thread = (struct ProfilerThread*)Mem_TryAllocCleared(1, sizeof(struct ProfilerThread));
+	if (!thread) return NULL;
+	thread->mutex = Mutex_Create("Profiler thread");
+
+	Mutex_Lock(profiler_mutex);
+	{
+		if (profiler_threadsCount < PROFILER_MAX_THREADS) {
+			profiler_threads[profiler_threadsCount++] = thread;
+		} else {
+			profiler_full = true;
+		}
+	}
+	Mutex_Unlock(profiler_mutex);
+
+	if (profiler_full) {
+		Mutex_Free(thread->mutex);
+		Mem_Free(thread);
+		return NULL;
+	}
+	profiler_cur = thread;
+	return thread;
+}
+
+void Profiler_BeginZone(const char* name) {
+	struct ProfilerThread* thread = Profiler_GetThread();
+	if (!thread) return;
+
+	/* Zones too deeply nested are still tracked, just not recorded */
+	if (thread->depth < PROFILER_MAX_DEPTH) {
+		thread->stackNames[thread->depth] = name;
+		thread->stackBegs[thread->depth]  = Stopwatch_Measure();
+	}
+	thread->depth++;
+}
+
+void Profiler_EndZone(void) {
+	struct ProfilerThread* thread = profiler_cur;
+	struct ProfilerZone* zone;
+	cc_uint64 end;
+	if (!thread || !thread->depth) return;
+
+	thread->depth--;
+	if (thread->depth >= PROFILER_MAX_DEPTH) return;
+	end = Stopwatch_Measure();
+
+	Mutex_Lock(thread->mutex);
+	{
+		zone = &thread->zones[thread->count % PROFILER_MAX_EVENTS];
+		zone->name  = thread->stackNames[thread->depth];
+		zone->beg   = thread->stackBegs[thread->depth];
+		zone->end   = end;
+		zone->depth = thread->depth;
+		thread->count++;
+	}
+	Mutex_Unlock(thread->mutex);
+}
+
+void Profiler_NameThread(const char* name) {
+	struct ProfilerThread* thread = Profiler_GetThread();
+	if (thread) thread->name = name;
+}
+
+void Profiler_EndThread(void) {
+	struct ProfilerThread* thread = profiler_cur;
+	if (!thread) return;
+	profiler_cur = NULL;
+
+	Mutex_Lock(profiler_mutex);
+	{
+		thread->exited = true;
+	}
+	Mutex_Unlock(profiler_mutex);
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------------Trace dumping-----------------------------------------------------*
+*#########################################################################################################################*/
+#define PROFILER_DUMP_BUFFER 8192
+
+static void Profiler_AppendTime(cc_string* str, cc_uint64 micros) {
+	cc_uint32 secs = (cc_uint32)(micros / 1000000);
+	int frac = (int)(micros % 1000000);
+
+	/* Avoids overflowing 32 bit integers for long sessions */
+	if (secs) {
+		String_AppendUInt32(str, secs);
+		String_AppendPaddedInt(str, frac, 6);
+	} else {
+		String_AppendInt(str, frac);
+	}
+}
+
+/* Zone/thread names are usually string literals, but still need escaping for JSON */
+static void Profiler_AppendName(cc_string* str, const char* name) {
+	for (; *name; name++) 
+	{
+		if (*name == '"' || *name == '\\') String_Append(str, '\\');
+		String_Append(str, *name);
+	}
+}
+
+static cc_result Profiler_Flush(struct Stream* s, cc_string* str) {
+	cc_result res = Stream_Write(s, (const cc_uint8*)str->buffer, str->length);
+	str->length   = 0;
+	return res;
+}
+
+static cc_result Profiler_DumpThread(struct Stream* s, cc_string* str, struct ProfilerThread* thread, int tid, cc_uint64 origin) {
+	struct ProfilerZone zone;
+	cc_uint32 i, beg, count;
+	cc_result res;
+
+	if (thread->name) {
+		String_Format1(str, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"", &tid);
+		Profiler_AppendName(str, thread->name);
+		String_AppendConst(str, "\"}}");
+	}
+
+	Mutex_Lock(thread->mutex);
+	count = thread->count;
+	Mutex_Unlock(thread->mutex);
+	beg = count > PROFILER_MAX_EVENTS ? count - PROFILER_MAX_EVENTS : 0;
+
+	for (i = beg; i < count; i++) 
+	{
+		/* Zone may be overwritten while dumping, so copy it out first */
+		Mutex_Lock(thread->mutex);
+		zone = thread->zones[i % PROFILER_MAX_EVENTS];
+		Mutex_Unlock(thread->mutex);
+		if (zone.beg < origin) continue;
+
+		String_AppendConst(str, ",\n{\"name\":\"");
+		Profiler_AppendName(str, zone.name);
+		String_Format1(str, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%i,\"ts\":", &tid);
+		Profiler_AppendTime(str, Stopwatch_ElapsedMicroseconds(origin, zone.beg));
+		String_AppendConst(str, ",\"dur\":");
+		Profiler_AppendTime(str, Stopwatch_ElapsedMicroseconds(zone.beg, zone.end));
+		String_Append(str, '}');
+
+		if (str->length < str->capacity - 256) continue;
+		if ((res = Profiler_Flush(s, str))) return res;
+	}
+	return 0;
+}
+
+/* Returns time the oldest zone still in any thread's history began at */
+static cc_uint64 Profiler_CalcOrigin(void) {
+	struct ProfilerThread* thread;
+	cc_uint64 origin = 0, beg;
+	cc_uint32 count;
+	int i;
+
+	for (i = 0; i < profiler_threadsCount; i++) 
+	{
+		thread = profiler_threads[i];
+		Mutex_Lock(thread->mutex);
+		{
+			count = thread->count;
+			/* Oldest zone is the next one to be overwritten */
+			beg   = count > PROFILER_MAX_EVENTS ? thread->zones[count % PROFILER_MAX_EVENTS].beg : thread->zones[0].beg;
+		}
+		Mutex_Unlock(thread->mutex);
+
+		if (!count) continue;
+		if (!origin || beg < origin) origin = beg;
+	}
+	return origin;
+}
+
+cc_result Profiler_Dump(const cc_string* path) {
+	cc_string str; char strBuffer[PROFILER_DUMP_BUFFER];
+	struct Stream s;
+	cc_uint64 origin;
+	cc_result res, closeRes;
+	int i, threads;
+
+	if ((res = Stream_CreateFile(&s, path))) return res;
+	String_InitArray(str, strBuffer);
+	String_AppendConst(&str, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	String_AppendConst(&str, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"" GAME_APP_NAME "\"}}");
+
+	Mutex_Lock(profiler_mutex);
+	threads = profiler_threadsCount;
+	Mutex_Unlock(profiler_mutex);
+	origin = Profiler_CalcOrigin();
+
+	for (i = 0; i < threads && !res; i++) 
+	{
+		res = Profiler_DumpThread(&s, &str, profiler_threads[i], i + 1, origin);
+	}
+
+	String_AppendConst(&str, "\n]}\n");
+	if (!res) res = Profiler_Flush(&s, &str);
+
+	closeRes = s.Close(&s);
+	return res ? res : closeRes;
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------------------Overlay----------------------------------------------------------*
+*#########################################################################################################################*/
+#define PROFILER_OVERLAY_ZONES 3
+struct ProfilerTotal { const char* name; cc_uint64 micros; };
+
+static cc_bool Profiler_SameName(const char* a, const char* b) {
+	cc_string str;
+	if (a == b) return true;
+
+	/* Same string literal might have different addresses in different files */
+	str = String_FromReadonly(a);
+	return String_CaselessEqualsConst(&str, b);
+}
+
+/* Adds up how long each main thread zone took since the overlay was last updated */
+static int Profiler_CalcTotals(struct ProfilerThread* thread, struct ProfilerTotal* totals, int maxTotals, int* frames) {
+	struct ProfilerZone zone;
+	cc_uint32 i, beg, count;
+	int j, numTotals = 0;
+
+	Mutex_Lock(thread->mutex);
+	count = thread->count;
+	Mutex_Unlock(thread->mutex);
+	beg = count > PROFILER_MAX_EVENTS ? count - PROFILER_MAX_EVENTS : 0;
+	*frames = 0;
+
+	for (i = beg; i < count; i++) 
+	{
+		Mutex_Lock(thread->mutex);
+		zone = thread->zones[i % PROFILER_MAX_EVENTS];
+		Mutex_Unlock(thread->mutex);
+		if (zone.beg < profiler_overlayBeg) continue;
+
+		/* Outermost zones on the main thread are whole frames, which are */
+		/*  only used to work out the average time each other zone takes */
+		if (!zone.depth) { (*frames)++; continue; }
+
+		for (j = 0; j < numTotals; j++) 
+		{
+			if (Profiler_SameName(totals[j].name, zone.name)) break;
+		}
+
+		if (j == numTotals) {
+			if (numTotals == maxTotals) continue;
+			totals[j].name   = zone.name;
+			totals[j].micros = 0;
+			numTotals++;
+		}
+		totals[j].micros += Stopwatch_ElapsedMicroseconds(zone.beg, zone.end);
+	}
+	return numTotals;
+}
+
+static void Profiler_UpdateOverlay(struct ScheduledTask* task) {
+	struct ProfilerTotal totals[64];
+	struct ProfilerTotal tmp;
+	cc_string msg; char msgBuffer[STRING_SIZE];
+	cc_string name;
+	int i, j, count, frames;
+	float ms;
+
+	if (!profiler_overlay || !profiler_threadsCount) return;
+	/* Main thread is always first thread to record zones */
+	count = Profiler_CalcTotals(profiler_threads[0], totals, Array_Elems(totals), &frames);
+	profiler_overlayBeg = Stopwatch_Measure();
+
+	/* Only the few most expensive zones are shown */
+	for (i = 0; i < count && i < PROFILER_OVERLAY_ZONES; i++) 
+	{
+		for (j = i + 1; j < count; j++) 
+		{
+			if (totals[j].micros <= totals[i].micros) continue;
+			tmp = totals[i]; totals[i] = totals[j]; totals[j] = tmp;
+		}
+	}
+
+	for (i = 0; i < PROFILER_OVERLAY_ZONES; i++) 
+	{
+		String_InitArray(msg, msgBuffer);
+		if (i < count && frames) {
+			name = String_FromReadonly(totals[i].name);
+			ms   = totals[i].micros / (1000.0f * frames);
+			String_Format2(&msg, "&e%s: &f%f2 ms/frame", &name, &ms);
+		}
+		Chat_AddOf(&msg, MSG_TYPE_STATUS_1 + i);
+	}
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------------------Commands---------------------------------------------------------*
+*#########################################################################################################################*/
+static const cc_string profiler_defaultPath = String_FromConst("profile.json");
+
+static void Profiler_DumpTo(const cc_string* path) {
+	cc_result res = Profiler_Dump(path);
+	if (res) { Logger_SysWarn2(res, "writing profile to", path); return; }
+	Chat_Add1("&e/client: &fProfile saved to %s", path);
+}
+
+static void ProfilerCommand_Execute(const cc_string* args, int argsCount) {
+	int i;
+	if (argsCount && String_CaselessEqualsConst(&args[0], "dump")) {
+		Profiler_DumpTo(argsCount > 1 ? &args[1] : &profiler_defaultPath);
+		return;
+	}
+
+	profiler_overlay    = !profiler_overlay;
+	profiler_overlayBeg = Stopwatch_Measure();
+	if (profiler_overlay) return;
+
+	/* Clear the overlay lines */
+	for (i = 0; i < PROFILER_OVERLAY_ZONES; i++)
+	{
+		Chat_AddOf(&String_Empty, MSG_TYPE_STATUS_1 + i);
+	}
+}
+
+static struct ChatCommand ProfilerCommand = {
+	"Profiler", ProfilerCommand_Execute,
+	0,
+	{
+		"&a/client profiler",
+		"&eToggles showing the most expensive zones of each frame",
+		"&a/client profiler dump [file]",
+		"&eSaves recorded zones in Chrome trace format (default profile.json)",
+	}
+};
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Profiler component----------------------------------------------------*
+*#########################################################################################################################*/
+static void OnInit(void) {
+	profiler_mutex = Mutex_Create("Profiler threads");
+	Profiler_NameThread("Main");
+
+	Commands_Register(&ProfilerCommand);
+	ScheduledTask_Add(1.0, Profiler_UpdateOverlay);
+}
+
+static void OnFree(void) {
+	cc_string path;
+	/* Allows getting a profile from headless/automated runs */
+	/* NOTE: Thread buffers are deliberately never freed, as other threads may still be running */
+	if (Options_UNSAFE_Get(OPT_PROFILER_DUMP, &path) && path.length) {
+		Profiler_DumpTo(&path);
+	}
+}
+
+struct IGameComponent Profiler_Component = {
+	OnInit, /* Init  */
+	OnFree  /* Free  */
+};
+#endif
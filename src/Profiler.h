@@ -0,0 +1,38 @@
+#ifndef CC_PROFILER_H
+#define CC_PROFILER_H
+#include "Core.h"
+CC_BEGIN_HEADER
+
+/* 
+Records how long named zones of code take to run on each thread
+Copyright 2014-2023 ClassiCube | Licensed under BSD-3
+*/
+struct IGameComponent;
+
+#ifdef CC_BUILD_PROFILER
+extern struct IGameComponent Profiler_Component;
+
+/* Marks the start of a zone of code on the calling thread. Zones can be nested. */
+/* NOTE: Only the pointer is stored, so name must be a string literal */
+void Profiler_BeginZone(const char* name);
+/* Marks the end of the most recently begun zone on the calling thread */
+void Profiler_EndZone(void);
+/* Sets the name shown for the calling thread in dumped profiles */
+/* NOTE: Only the pointer is stored, so name must be a string literal */
+void Profiler_NameThread(const char* name);
+/* Marks the calling thread as about to exit, so its history can be reused by another thread */
+/* NOTE: Zones recorded by the calling thread are kept until then */
+void Profiler_EndThread(void);
+/* Writes all zones still in each thread's history to the given file, in Chrome's trace event format */
+/* (which can be viewed in chrome://tracing, Perfetto, Speedscope etc) */
+cc_result Profiler_Dump(const cc_string* path);
+#else
+/* Profiler is compiled out entirely */
+#define Profiler_BeginZone(name)
+#define Profiler_EndZone()
+#define Profiler_NameThread(name)
+#define Profiler_EndThread()
+#endif
+
+CC_END_HEADER
+#endif
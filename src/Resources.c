@@ -79,7 +79,9 @@ static void ZipFile_InspectEntries(const cc_string* path, Zip_SelectEntry select
 }
 
 static cc_result ZipEntry_ExtractData(struct ResourceZipEntry* e, struct Stream* data, struct ZipEntry* source) {
-	cc_uint32 size = source->UncompressedSize;
+	cc_uint32 size = (cc_uint32)source->UncompressedSize;
+	if (source->UncompressedSize > 0xFFFFFFFFUL) return ZIP_ERR_FILE_TOO_LARGE;
+
 	e->value.data  = Mem_TryAlloc(size, 1);
 	e->size        = size;
 
@@ -104,9 +106,11 @@ static cc_result ZipWriter_LocalFile(struct Stream* s, struct ResourceZipEntry*
 	cc_uint8 header[30 + STRING_SIZE];
 	cc_result res;
 	int modTime, modDate;
+	cc_uint64 offset;
 
 	GetCurrentZipDate(&modTime, &modDate);
-	if ((res = s->Position(s, &e->offset))) return res;
+	if ((res = s->Position(s, &offset))) return res;
+	e->offset = (cc_uint32)offset;
 
 	Stream_SetU32_LE(header + 0,  0x04034b50);  /* signature */
 	Stream_SetU16_LE(header + 4,  20);          /* version needed */
@@ -157,7 +161,7 @@ static cc_result ZipWriter_CentralDir(struct Stream* s, struct ResourceZipEntry*
 }
 
 static cc_result ZipWriter_EndOfCentralDir(struct Stream* s, int numEntries,
-											cc_uint32 centralDirBeg, cc_uint32 centralDirEnd) {
+											cc_uint64 centralDirBeg, cc_uint64 centralDirEnd) {
 	cc_uint8 header[22];
 
 	Stream_SetU32_LE(header + 0,  0x06054b50); /* signature */
@@ -165,8 +169,8 @@ static cc_result ZipWriter_EndOfCentralDir(struct Stream* s, int numEntries,
 	Stream_SetU16_LE(header + 6,  0);          /* disk number of start */
 	Stream_SetU16_LE(header + 8,  numEntries); /* disk entries */
 	Stream_SetU16_LE(header + 10, numEntries); /* total entries */
-	Stream_SetU32_LE(header + 12, centralDirEnd - centralDirBeg);  /* central dir size */
-	Stream_SetU32_LE(header + 16, centralDirBeg);                  /* central dir start */
+	Stream_SetU32_LE(header + 12, (cc_uint32)(centralDirEnd - centralDirBeg)); /* central dir size */
+	Stream_SetU32_LE(header + 16, (cc_uint32)centralDirBeg);                   /* central dir start */
 	Stream_SetU16_LE(header + 20, 0);         /* comment length */
 	return Stream_Write(s, header, 22);
 }
@@ -174,21 +178,20 @@ static cc_result ZipWriter_EndOfCentralDir(struct Stream* s, int numEntries,
 static cc_result ZipWriter_FixupLocalFile(struct Stream* s, struct ResourceZipEntry* e) {
 	int filenameLen = String_Length(e->filename);
 	cc_uint8 tmp[2048];
-	cc_uint32 dataBeg, dataEnd;
+	cc_uint64 dataBeg, dataEnd;
 	cc_uint32 i, crc, toRead, read;
 	cc_result res;
 
 	dataBeg = e->offset + 30 + filenameLen;
 	if ((res = s->Position(s, &dataEnd))) return res;
-	e->size = dataEnd - dataBeg;
+	e->size = (cc_uint32)(dataEnd - dataBeg);
 
 	/* work out the CRC 32 */
 	crc = 0xffffffffUL;
 	if ((res = s->Seek(s, dataBeg))) return res;
 
 	for (; dataBeg < dataEnd; dataBeg += read) {
-		toRead = dataEnd - dataBeg;
-		toRead = min(toRead, sizeof(tmp));
+		toRead = (cc_uint32)min(dataEnd - dataBeg, sizeof(tmp));
 
 		if ((res = s->Read(s, tmp, toRead, &read))) return res;
 		if (!read) return ERR_END_OF_STREAM;
@@ -238,7 +241,7 @@ static cc_result ZipWriter_WriteWav(struct Stream* dst, struct ResourceZipEntry*
 *#########################################################################################################################*/
 static cc_result ZipFile_WriteEntries(struct Stream* s, struct ResourceZipEntry* entries, int numEntries) {
 	struct ResourceZipEntry* e;
-	cc_uint32 beg, end;
+	cc_uint64 beg, end;
 	int i;
 	cc_result res;
 
@@ -417,7 +420,7 @@ static cc_result SoundPatcher_Save(struct Stream* s, struct ResourceZipEntry* e)
 #define WAV_HDR_SIZE 44
 
 /* Fixes up the .WAV header after having written all samples */
-static cc_result SoundPatcher_FixupHeader(struct Stream* s, struct VorbisState* ctx, cc_uint32 offset, cc_uint32 len) {
+static cc_result SoundPatcher_FixupHeader(struct Stream* s, struct VorbisState* ctx, cc_uint64 offset, cc_uint32 len) {
 	cc_uint8 header[WAV_HDR_SIZE];
 	cc_result res = s->Seek(s, offset);
 	if (res) return res;
@@ -443,7 +446,7 @@ static cc_result SoundPatcher_FixupHeader(struct Stream* s, struct VorbisState*
 /* Decodes all samples, then produces a .WAV file from them */
 static cc_result SoundPatcher_WriteWav(struct Stream* s, struct VorbisState* ctx) {
 	cc_int16* samples;
-	cc_uint32 begOffset;
+	cc_uint64 begOffset;
 	cc_uint32 len = WAV_HDR_SIZE;
 	cc_result res;
 	int count;
@@ -89,6 +89,7 @@ static struct HUDScreen {
 static void HUDScreen_RemakeLine1(struct HUDScreen* s) {
 	cc_string status; char statusBuffer[STRING_SIZE * 2];
 	int indices, ping, fps;
+	int i, conns, connReqs[4];
 	float real_fps;
 
 	String_InitArray(status, statusBuffer);
@@ -119,6 +120,13 @@ static void HUDScreen_RemakeLine1(struct HUDScreen* s) {
 
 		ping = Ping_AveragePingMS();
 		if (ping) String_Format1(&status, ", ping %i ms", &ping);
+
+		/* Number of requests made using each open HTTP connection */
+		conns = Http_GetConnectionStats(connReqs, Array_Elems(connReqs));
+		for (i = 0; i < conns; i++) 
+		{
+			String_Format1(&status, i ? "/%i" : ", http reqs %i", &connReqs[i]);
+		}
 	}
 	TextWidget_Set(&s->line1, &status, &s->font);
 	s->dirty = true;
@@ -25,6 +25,10 @@
 #include "Input.h"
 #include "Errors.h"
 #include "Options.h"
+#include "Profiler.h"
+#include "Stream.h"
+#include "Window.h"
+#include "MapRenderer.h"
 
 static char nameBuffer[STRING_SIZE];
 static char motdBuffer[STRING_SIZE];
@@ -45,6 +49,8 @@ static void Server_ResetState(void) {
 
 void Server_RetrieveTexturePack(const cc_string* url) {
 	if (!Game_AllowServerTextures || TextureCache_HasDenied(url)) return;
+	/* HTTP responses aren't recorded, so downloading would make replays unrepeatable */
+	if (MP_ReplayFile.length) return;
 
 	if (!url->length || TextureCache_HasAccepted(url)) {
 		TexturePack_Extract(url);
@@ -226,6 +232,221 @@ static void SPConnection_Init(void) {
 }
 
 
+/*########################################################################################################################*
+*-------------------------------------------------Packet recording/replay-------------------------------------------------*
+*#########################################################################################################################*/
+/* Data received from a server can be recorded to a file, and later replayed back through the protocol handlers */
+/*  without any server (which provides a repeatable benchmark for the whole process of joining and playing) */
+static char replayBuffer[FILENAME_SIZE];
+cc_string MP_ReplayFile = String_FromArray(replayBuffer);
+
+#ifdef CC_BUILD_NETWORKING
+/* File format: header of NET_REPLAY_MAGIC and NET_REPLAY_VERSION, then for each network tick data was read in: */
+/*  u32 tick, u32 milliseconds since connecting, u32 length, then the raw data that was read from the socket */
+#define NET_REPLAY_MAGIC   0x43435250UL /* "CCRP" */
+#define NET_REPLAY_VERSION 1
+#define NET_RECORD_SIZE    12
+
+static cc_uint32 net_tick; /* Number of network ticks since finished connecting */
+static cc_uint64 net_connectBeg;
+
+static struct Stream net_recordStream;
+static cc_bool net_recording;
+
+static struct Stream net_replayFile, net_replayStream;
+static cc_uint8 net_replayBuffer[16384];
+static cc_bool net_replaying, net_replayDone;
+static cc_uint32 net_replayTick, net_replaySize;
+static int net_settledTicks, net_lastBuildCount;
+
+enum REPLAY_STAT {
+	REPLAY_STAT_MAPDATA, REPLAY_STAT_MAPSETUP, REPLAY_STAT_BLOCKS,
+	REPLAY_STAT_ENTITIES, REPLAY_STAT_OTHER, REPLAY_STAT_COUNT
+};
+static const char* const replay_statNames[REPLAY_STAT_COUNT] = {
+	"Map data (MapState_Read)", "Map init/finalise", "Block updates", "Entity packets", "Other packets"
+};
+static cc_uint64 replay_statTimes[REPLAY_STAT_COUNT];
+static int replay_statCounts[REPLAY_STAT_COUNT];
+static cc_uint64 replay_beg, replay_buildTimeBeg;
+static int replay_buildCountBeg;
+
+static void Recorder_Stop(void) {
+	cc_result res;
+	if (!net_recording) return;
+	net_recording = false;
+
+	res = net_recordStream.Close(&net_recordStream);
+	if (res) Logger_SysWarn(res, "closing packet recording");
+}
+
+static void Recorder_Start(void) {
+	cc_uint8 header[8];
+	cc_string path;
+	cc_result res;
+	if (net_replaying || !Options_UNSAFE_Get(OPT_NET_RECORD, &path) || !path.length) return;
+
+	res = Stream_CreateFile(&net_recordStream, &path);
+	if (res) { Logger_SysWarn2(res, "creating", &path); return; }
+	net_recording = true;
+
+	Stream_SetU32_LE(header + 0, NET_REPLAY_MAGIC);
+	Stream_SetU32_LE(header + 4, NET_REPLAY_VERSION);
+	res = Stream_Write(&net_recordStream, header, sizeof(header));
+	if (res) { Logger_SysWarn2(res, "writing", &path); Recorder_Stop(); }
+}
+
+static void Recorder_Write(const cc_uint8* data, cc_uint32 len) {
+	cc_uint8 header[NET_RECORD_SIZE];
+	int ms = Stopwatch_ElapsedMS(net_connectBeg, Stopwatch_Measure());
+	cc_result res;
+
+	Stream_SetU32_LE(header + 0, net_tick);
+	Stream_SetU32_LE(header + 4, ms);
+	Stream_SetU32_LE(header + 8, len);
+
+	res = Stream_Write(&net_recordStream, header, NET_RECORD_SIZE);
+	if (!res) res = Stream_Write(&net_recordStream, data, len);
+	if (res) { Logger_SysWarn(res, "writing packet recording"); Recorder_Stop(); }
+}
+
+static void Replay_Close(void) {
+	if (!net_replaying) return;
+	net_replayFile.Close(&net_replayFile);
+	net_replaying = false;
+}
+
+/* Reads the header of the next recorded tick, returning false once end of the recording is reached */
+static cc_bool Replay_Advance(void) {
+	cc_uint8 header[NET_RECORD_SIZE];
+	cc_result res = Stream_Read(&net_replayStream, header, NET_RECORD_SIZE);
+
+	if (!res) {
+		net_replayTick = Stream_GetU32_LE(header + 0);
+		net_replaySize = Stream_GetU32_LE(header + 8);
+		/* Recorded reads are never larger than what MPConnection_Tick reads in one go */
+		if (net_replaySize <= 4096 * 4) return true;
+		res = ERR_INVALID_ARGUMENT;
+	}
+
+	if (res != ERR_END_OF_STREAM) Logger_SysWarn2(res, "reading", &MP_ReplayFile);
+	net_replayDone = true;
+	return false;
+}
+
+static cc_result Replay_Open(void) {
+	cc_uint8 header[8];
+	cc_result res;
+
+	res = Stream_OpenFile(&net_replayFile, &MP_ReplayFile);
+	if (res) return res;
+	Stream_ReadonlyBuffered(&net_replayStream, &net_replayFile, net_replayBuffer, sizeof(net_replayBuffer));
+	net_replaying  = true;
+	net_replayDone = false;
+
+	res = Stream_Read(&net_replayStream, header, sizeof(header));
+	if (res) return res;
+	if (Stream_GetU32_LE(header + 0) != NET_REPLAY_MAGIC)   return ERR_INVALID_ARGUMENT;
+	if (Stream_GetU32_LE(header + 4) != NET_REPLAY_VERSION) return ERR_NOT_SUPPORTED;
+
+	Mem_Set(replay_statTimes,  0, sizeof(replay_statTimes));
+	Mem_Set(replay_statCounts, 0, sizeof(replay_statCounts));
+	replay_beg       = Stopwatch_Measure();
+	replay_buildTimeBeg  = MapRenderer_BuildTime;
+	replay_buildCountBeg = MapRenderer_BuildCount;
+	net_settledTicks     = 0;
+
+	Replay_Advance();
+	return 0;
+}
+
+/* Substitutes for Socket_Read, returning the data that was read from the socket in the same tick when recorded */
+static cc_result Replay_Read(cc_uint8* data, cc_uint32* read) {
+	cc_result res;
+	*read = 0;
+	if (net_replayDone || net_replayTick > net_tick) return ReturnCode_SocketWouldBlock;
+
+	res = Stream_Read(&net_replayStream, data, net_replaySize);
+	if (res) { net_replayDone = true; return ReturnCode_SocketWouldBlock; }
+
+	*read = net_replaySize;
+	Replay_Advance();
+	return 0;
+}
+
+static int Replay_StatOf(cc_uint8 opcode) {
+	switch (opcode)
+	{
+	case OPCODE_LEVEL_DATA:
+		return REPLAY_STAT_MAPDATA;
+	case OPCODE_LEVEL_BEGIN:
+	case OPCODE_LEVEL_END:
+		return REPLAY_STAT_MAPSETUP;
+	case OPCODE_SET_BLOCK:
+	case OPCODE_BULK_BLOCK_UPDATE:
+		return REPLAY_STAT_BLOCKS;
+	case OPCODE_ADD_ENTITY:
+	case OPCODE_ENTITY_TELEPORT:
+	case OPCODE_RELPOS_AND_ORI_UPDATE:
+	case OPCODE_RELPOS_UPDATE:
+	case OPCODE_ORI_UPDATE:
+	case OPCODE_REMOVE_ENTITY:
+	case OPCODE_EXT_ADD_ENTITY:
+	case OPCODE_EXT_ADD_ENTITY2:
+	case OPCODE_SET_ENTITY_PROPERTY:
+	case OPCODE_ENTITY_TELEPORT_EXT:
+		return REPLAY_STAT_ENTITIES;
+	}
+	return REPLAY_STAT_OTHER;
+}
+
+static void Replay_TimePacket(cc_uint8 opcode, cc_uint64 beg) {
+	int stat = Replay_StatOf(opcode);
+	replay_statTimes[stat] += Stopwatch_Measure() - beg;
+	replay_statCounts[stat]++;
+}
+
+static void Replay_LogStat(const char* name, cc_uint64 time, int count, const char* units) {
+	cc_string msg; char msgBuffer[STRING_SIZE];
+	float ms = Stopwatch_ElapsedMicroseconds(0, time) / 1000.0f;
+	String_InitArray(msg, msgBuffer);
+
+	String_Format4(&msg, "  %c: %f2 ms, %i %c", name, &ms, &count, units);
+	Platform_Log(msg.buffer, msg.length);
+	Chat_Add(&msg);
+}
+
+static void Replay_Report(void) {
+	int i, chunks = MapRenderer_BuildCount - replay_buildCountBeg;
+	cc_uint64 end = Stopwatch_Measure();
+	float secs    = Stopwatch_ElapsedMS(replay_beg, end) / 1000.0f;
+
+	Platform_Log2("Replay of %s finished after %i network ticks", &MP_ReplayFile, &net_tick);
+	Chat_Add2("Replay of %s finished after %i network ticks", &MP_ReplayFile, &net_tick);
+	Platform_Log1("  Total time: %f2 seconds", &secs);
+
+	for (i = 0; i < REPLAY_STAT_COUNT; i++) 
+	{
+		Replay_LogStat(replay_statNames[i], replay_statTimes[i], replay_statCounts[i], "packets");
+	}
+	Replay_LogStat("Chunk rebuilds", MapRenderer_BuildTime - replay_buildTimeBeg, chunks, "chunks");
+}
+
+/* Replay is finished once all recorded data is processed, and no chunks were rebuilt in the last second */
+static void Replay_CheckFinished(void) {
+	if (!net_replayDone || !net_replaying) return;
+
+	if (net_lastBuildCount != MapRenderer_BuildCount) {
+		net_lastBuildCount = MapRenderer_BuildCount;
+		net_settledTicks   = 0;
+	} else if (++net_settledTicks == 60) {
+		Replay_Report();
+		Window_RequestClose();
+	}
+}
+#endif
+
+
 /*########################################################################################################################*
 *--------------------------------------------------Multiplayer connection-------------------------------------------------*
 *#########################################################################################################################*/
@@ -250,6 +471,10 @@ static void MPConnection_FinishConnect(void) {
 
 	net_readCurrent = net_readBuffer;
 	net_lastPacket  = Game.Time;
+	net_tick        = 0;
+	net_connectBeg  = Stopwatch_Measure();
+
+	Recorder_Start();
 	Classic_SendLogin();
 }
 
@@ -292,6 +517,26 @@ static void MPConnection_TickConnect(void) {
 	}
 }
 
+static void MPConnection_BeginReplay(void) {
+	static const cc_string title  = String_FromConst("Failed to replay packets");
+	static const cc_string reason = String_FromConst("Recorded packets could not be read, see client.log");
+	cc_string msg; char msgBuffer[STRING_SIZE];
+	cc_result res;
+	String_InitArray(msg, msgBuffer);
+
+	res = Replay_Open();
+	if (res) {
+		Logger_SysWarn2(res, "opening", &MP_ReplayFile);
+		Game_Disconnect(&title, &reason);
+		OnClose(); return;
+	}
+
+	Server.Disconnected = false;
+	String_Format1(&msg, "Replaying %s..", &MP_ReplayFile);
+	LoadingScreen_Show(&msg, &String_Empty);
+	MPConnection_FinishConnect();
+}
+
 static void MPConnection_BeginConnect(void) {
 	static const cc_string invalid_reason = String_FromConst("Invalid IP address");
 	cc_string title; char titleBuffer[STRING_SIZE];
@@ -307,6 +552,7 @@ static void MPConnection_BeginConnect(void) {
 	Blocks.CanPlace[BLOCK_STILL_LAVA] = false;  Blocks.CanDelete[BLOCK_STILL_LAVA] = false;
 	Blocks.CanPlace[BLOCK_STILL_WATER] = false; Blocks.CanDelete[BLOCK_STILL_WATER] = false;
 	Blocks.CanPlace[BLOCK_BEDROCK] = false;     Blocks.CanDelete[BLOCK_BEDROCK] = false;
+	if (MP_ReplayFile.length) { MPConnection_BeginReplay(); return; }
 	
 	res = Socket_ParseAddress(&Server.Address, Server.Port, addrs, &numValidAddrs);
 	if (res == ERR_INVALID_ARGUMENT) {
@@ -383,14 +629,21 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 	cc_uint8* readEnd;
 	cc_uint8* readCur;
 	cc_uint32 read;
+	cc_uint64 beg = 0;
 	int i, remaining;
 	cc_result res;
 
 	if (Server.Disconnected) return;
 	if (net_connecting) { MPConnection_TickConnect(); return; }
+	net_tick++;
 
 	/* NOTE: using a read call that is a multiple of 4096 (appears to?) improve read performance */	
-	res = Socket_Read(net_socket, net_readCurrent, 4096 * 4, &read);
+	if (net_replaying) {
+		res = Replay_Read(net_readCurrent, &read);
+	} else {
+		res = Socket_Read(net_socket, net_readCurrent, 4096 * 4, &read);
+	}
+	if (!res && read && net_recording) Recorder_Write(net_readCurrent, read);
 	
 	if (res) {
 		/* 'no data available for non-blocking read' is an expected error */
@@ -407,6 +660,7 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 		readCur        = net_readBuffer;
 		readEnd        = net_readCurrent + read;
 		net_lastPacket = Game.Time;
+		Profiler_BeginZone("Protocol handlers");
 
 		while (readCur < readEnd) {
 			cc_uint8 opcode = readCur[0];
@@ -421,12 +675,15 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 
 			if (readCur + Protocol.Sizes[opcode] > readEnd) break;
 			handler = Protocol.Handlers[opcode];
-			if (!handler) { DisconnectInvalidOpcode(opcode); return; }
+			if (!handler) { Profiler_EndZone(); DisconnectInvalidOpcode(opcode); return; }
 
 			lastOpcode = opcode;
+			if (net_replaying) beg = Stopwatch_Measure();
 			handler(readCur + 1); /* skip opcode */
+			if (net_replaying) Replay_TimePacket(opcode, beg);
 			readCur += Protocol.Sizes[opcode];
 		}
+		Profiler_EndZone();
 
 		/* Protocol packets might be split up across TCP packets */
 		/* If so, copy last few unprocessed bytes back to beginning of buffer */
@@ -438,6 +695,7 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 		}
 		net_readCurrent = net_readBuffer + remaining;
 	}
+	Replay_CheckFinished();
 
 	if (net_writeFailure) {
 		Platform_Log1("Error from send: %e", &net_writeFailure);
@@ -455,7 +713,7 @@ static void MPConnection_SendData(const cc_uint8* data, cc_uint32 len) {
 	cc_uint32 wrote;
 	cc_result res;
 	int tries = 0;
-	if (Server.Disconnected) return;
+	if (Server.Disconnected || net_replaying) return;
 
 	while (len) {
 		res = Socket_Write(net_socket, data, len, &wrote);
@@ -510,7 +768,7 @@ static void OnInit(void) {
 	String_InitArray(Server.MOTD,    motdBuffer);
 	String_InitArray(Server.AppName, appBuffer);
 
-	if (!Server.Address.length) {
+	if (!Server.Address.length && !MP_ReplayFile.length) {
 		SPConnection_Init();
 	} else {
 		MPConnection_Init();
@@ -543,6 +801,10 @@ static void OnClose(void) {
 		Physics_Free();
 	} else {
 		Ping_Reset();
+#ifdef CC_BUILD_NETWORKING
+		Recorder_Stop();
+		Replay_Close();
+#endif
 		if (Server.Disconnected) return;
 
 		Socket_Close(net_socket);
@@ -73,6 +73,9 @@ void Server_RetrieveTexturePack(const cc_string* url);
 
 /* Path of map to automatically load in singleplayer */
 extern cc_string SP_AutoloadMap;
+/* Path of recorded packets to replay, instead of connecting to a multiplayer server */
+/* NOTE: Packets are recorded when the net-record option is set to a file path */
+extern cc_string MP_ReplayFile;
 
 CC_END_HEADER
 #endif
@@ -64,10 +64,10 @@ static cc_result Stream_DefaultSkip(struct Stream* s, cc_uint32 count) {
 	return 0;
 }
 
-static cc_result Stream_DefaultSeek(struct Stream* s, cc_uint32 pos) {
+static cc_result Stream_DefaultSeek(struct Stream* s, cc_uint64 pos) {
 	return ERR_NOT_SUPPORTED;
 }
-static cc_result Stream_DefaultGet(struct Stream* s, cc_uint32* value) { 
+static cc_result Stream_DefaultGet(struct Stream* s, cc_uint64* value) { 
 	return ERR_NOT_SUPPORTED;
 }
 static cc_result Stream_DefaultClose(struct Stream* s) { return 0; }
@@ -102,13 +102,13 @@ static cc_result Stream_FileClose(struct Stream* s) {
 static cc_result Stream_FileSkip(struct Stream* s, cc_uint32 count) {
 	return File_Seek(s->meta.file, count, FILE_SEEKFROM_CURRENT);
 }
-static cc_result Stream_FileSeek(struct Stream* s, cc_uint32 position) {
-	return File_Seek(s->meta.file, position, FILE_SEEKFROM_BEGIN);
+static cc_result Stream_FileSeek(struct Stream* s, cc_uint64 position) {
+	return File_Seek(s->meta.file, (cc_int64)position, FILE_SEEKFROM_BEGIN);
 }
-static cc_result Stream_FilePosition(struct Stream* s, cc_uint32* position) {
+static cc_result Stream_FilePosition(struct Stream* s, cc_uint64* position) {
 	return File_Position(s->meta.file, position);
 }
-static cc_result Stream_FileLength(struct Stream* s, cc_uint32* length) {
+static cc_result Stream_FileLength(struct Stream* s, cc_uint64* length) {
 	return File_Length(s->meta.file, length);
 }
 
@@ -179,7 +179,7 @@ static cc_result Stream_PortionRead(struct Stream* s, cc_uint8* data, cc_uint32
 	struct Stream* source;
 	cc_result res;
 
-	count  = min(count, s->meta.portion.left);
+	if (count > s->meta.portion.left) count = (cc_uint32)s->meta.portion.left;
 	source = s->meta.portion.source;
 
 	res = source->Read(source, data, count, modified);
@@ -208,14 +208,14 @@ static cc_result Stream_PortionSkip(struct Stream* s, cc_uint32 count) {
 	return res;
 }
 
-static cc_result Stream_PortionPosition(struct Stream* s, cc_uint32* position) {
+static cc_result Stream_PortionPosition(struct Stream* s, cc_uint64* position) {
 	*position = s->meta.portion.length - s->meta.portion.left; return 0;
 }
-static cc_result Stream_PortionLength(struct Stream* s, cc_uint32* length) {
+static cc_result Stream_PortionLength(struct Stream* s, cc_uint64* length) {
 	*length = s->meta.portion.length; return 0;
 }
 
-void Stream_ReadonlyPortion(struct Stream* s, struct Stream* source, cc_uint32 len) {
+void Stream_ReadonlyPortion(struct Stream* s, struct Stream* source, cc_uint64 len) {
 	Stream_Init(s);
 	s->Read     = Stream_PortionRead;
 	s->ReadU8   = Stream_PortionReadU8;
@@ -259,18 +259,18 @@ static cc_result Stream_MemorySkip(struct Stream* s, cc_uint32 count) {
 	return 0;
 }
 
-static cc_result Stream_MemorySeek(struct Stream* s, cc_uint32 position) {
+static cc_result Stream_MemorySeek(struct Stream* s, cc_uint64 position) {
 	if (position >= s->meta.mem.length) return ERR_INVALID_ARGUMENT;
 
-	s->meta.mem.cur  = s->meta.mem.base   + position;
-	s->meta.mem.left = s->meta.mem.length - position;
+	s->meta.mem.cur  = s->meta.mem.base   + (cc_uint32)position;
+	s->meta.mem.left = s->meta.mem.length - (cc_uint32)position;
 	return 0;
 }
 
-static cc_result Stream_MemoryPosition(struct Stream* s, cc_uint32* position) {
+static cc_result Stream_MemoryPosition(struct Stream* s, cc_uint64* position) {
 	*position = s->meta.mem.length - s->meta.mem.left; return 0;
 }
-static cc_result Stream_MemoryLength(struct Stream* s, cc_uint32* length) {
+static cc_result Stream_MemoryLength(struct Stream* s, cc_uint64* length) {
 	*length = s->meta.mem.length; return 0;
 }
 
@@ -303,6 +303,13 @@ static cc_result Stream_BufferedRead(struct Stream* s, cc_uint8* data, cc_uint32
 		source               = s->meta.buffered.source; 
 		s->meta.buffered.cur = s->meta.buffered.base;
 
+		/* Reads at least as large as the buffer can go directly into the destination */
+		if (count >= s->meta.buffered.length) {
+			res = source->Read(source, data, count, modified);
+			if (!res) s->meta.buffered.end += *modified;
+			return res;
+		}
+
 		res = source->Read(source, s->meta.buffered.cur, s->meta.buffered.length, &read);
 		if (res) return res;
 		s->meta.buffered.left  = read;
@@ -327,9 +334,10 @@ static cc_result Stream_BufferedReadU8(struct Stream* s, cc_uint8* data) {
 	return 0;
 }
 
-static cc_result Stream_BufferedSeek(struct Stream* s, cc_uint32 position) {
+static cc_result Stream_BufferedSeek(struct Stream* s, cc_uint64 position) {
 	struct Stream* source;
-	cc_uint32 beg, len, offset;
+	cc_uint32 len, offset;
+	cc_uint64 beg;
 	cc_result res;
 
 	/* Check if seek position is within cached buffer */
@@ -337,7 +345,7 @@ static cc_result Stream_BufferedSeek(struct Stream* s, cc_uint32 position) {
 	beg = s->meta.buffered.end  - len;
 
 	if (position >= beg && position < beg + len) {
-		offset = position - beg;
+		offset = (cc_uint32)(position - beg);
 		s->meta.buffered.cur  = s->meta.buffered.base + offset;
 		s->meta.buffered.left = len - offset;
 		return 0;
@@ -353,14 +361,47 @@ static cc_result Stream_BufferedSeek(struct Stream* s, cc_uint32 position) {
 	return res;
 }
 
+static cc_result Stream_BufferedSkip(struct Stream* s, cc_uint32 count) {
+	cc_uint64 position;
+	cc_result res;
+
+	if (count <= s->meta.buffered.left) {
+		s->meta.buffered.cur  += count;
+		s->meta.buffered.left -= count;
+		return 0;
+	}
+
+	/* Seek past the data instead when possible, rather than reading and then discarding it */
+	position = s->meta.buffered.end - s->meta.buffered.left + count;
+	res      = Stream_BufferedSeek(s, position);
+	return res == ERR_NOT_SUPPORTED ? Stream_DefaultSkip(s, count) : res;
+}
+
+static cc_result Stream_BufferedPosition(struct Stream* s, cc_uint64* position) {
+	*position = s->meta.buffered.end - s->meta.buffered.left; return 0;
+}
+static cc_result Stream_BufferedLength(struct Stream* s, cc_uint64* length) {
+	struct Stream* source = s->meta.buffered.source;
+	return source->Length(source, length);
+}
+
 void Stream_ReadonlyBuffered(struct Stream* s, struct Stream* source, void* data, cc_uint32 size) {
 	Stream_Init(s);
-	s->Read   = Stream_BufferedRead;
-	s->ReadU8 = Stream_BufferedReadU8;
-	s->Seek   = Stream_BufferedSeek;
+	s->Read     = Stream_BufferedRead;
+	s->ReadU8   = Stream_BufferedReadU8;
+	s->Seek     = Stream_BufferedSeek;
+	s->Length   = Stream_BufferedLength;
+
+	/* Offsets are only known when the wrapped stream's position is */
+	/* (otherwise skipping just reads and discards data instead) */
+	if (!source->Position(source, &s->meta.buffered.end)) {
+		s->Skip     = Stream_BufferedSkip;
+		s->Position = Stream_BufferedPosition;
+	} else {
+		s->meta.buffered.end = 0;
+	}
 
 	s->meta.buffered.left   = 0;
-	s->meta.buffered.end    = 0;
 	s->meta.buffered.cur    = (cc_uint8*)data;
 	s->meta.buffered.base   = (cc_uint8*)data;
 	s->meta.buffered.length = size;
@@ -22,11 +22,11 @@ struct Stream {
 	cc_result (*Skip)(struct Stream* s, cc_uint32 count);
 
 	/* Attempts to seek to the given position in this stream. (may not be supported) */
-	cc_result (*Seek)(struct Stream* s, cc_uint32 position);
+	cc_result (*Seek)(struct Stream* s, cc_uint64 position);
 	/* Attempts to find current position this stream. (may not be supported) */
-	cc_result (*Position)(struct Stream* s, cc_uint32* position);
+	cc_result (*Position)(struct Stream* s, cc_uint64* position);
 	/* Attempts to find total length of this stream. (may not be supported) */
-	cc_result (*Length)(struct Stream* s, cc_uint32* length);
+	cc_result (*Length)(struct Stream* s, cc_uint64* length);
 	/* Attempts to close this stream, freeing associated resources. */
 	cc_result (*Close)(struct Stream* s);
 	
@@ -34,8 +34,8 @@ struct Stream {
 		cc_file file;
 		void* inflate;
 		struct { cc_uint8* cur; cc_uint32 left, length; cc_uint8* base; } mem;
-		struct { struct Stream* source; cc_uint32 left, length; } portion;
-		struct { cc_uint8* cur; cc_uint32 left, length; cc_uint8* base; struct Stream* source; cc_uint32 end; } buffered;
+		struct { struct Stream* source; cc_uint64 left, length; } portion;
+		struct { cc_uint8* cur; cc_uint32 left, length; cc_uint8* base; struct Stream* source; cc_uint64 end; } buffered;
 		struct { struct Stream* source; cc_uint32 crc32; } crc32;
 	} meta;
 };
@@ -63,10 +63,11 @@ cc_result Stream_WriteAllTo(const cc_string* path, const cc_uint8* data, cc_uint
 CC_API void Stream_FromFile(struct Stream* s, cc_file file);
 
 /* Wraps another Stream, only allows reading up to 'len' bytes from the wrapped stream. */
-CC_API void Stream_ReadonlyPortion(struct Stream* s, struct Stream* source, cc_uint32 len);
+CC_API void Stream_ReadonlyPortion(struct Stream* s, struct Stream* source, cc_uint64 len);
 /* Wraps a block of memory, allowing reading from and seeking in the block. */
 CC_API void Stream_ReadonlyMemory(struct Stream* s, void* data, cc_uint32 len);
 /* Wraps another Stream, reading through an intermediary buffer. (Useful for files, since each read call is expensive) */
+/* NOTE: Seeking/skipping within the buffered data does not call into the wrapped stream at all */
 CC_API void Stream_ReadonlyBuffered(struct Stream* s, struct Stream* source, void* data, cc_uint32 size);
 
 /* Wraps another Stream, calculating a running CRC32 as data is written. */
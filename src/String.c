@@ -820,6 +820,8 @@ void StringsBuffer_Init(struct StringsBuffer* buffer) {
 	buffer->flagsBuffer    = buffer->_defaultFlags;
 	buffer->_textCapacity  = STRINGSBUFFER_BUFFER_DEF_SIZE;
 	buffer->_flagsCapacity = STRINGSBUFFER_FLAGS_DEF_ELEMS;
+	buffer->_index         = NULL;
+	buffer->_indexCapacity = 0;
 
 	if (buffer->_lenShift) return;
 	StringsBuffer_SetLengthBits(buffer, STRINGSBUFFER_DEF_LEN_SHIFT);
@@ -840,9 +842,102 @@ void StringsBuffer_Clear(struct StringsBuffer* buffer) {
 	if (buffer->flagsBuffer != buffer->_defaultFlags) {
 		Mem_Free(buffer->flagsBuffer);
 	}
+	Mem_Free(buffer->_index);
 	StringsBuffer_Init(buffer);
 }
 
+/* Hash index is only worth using when there are more than a few entries */
+#define STRINGSBUFFER_INDEX_MIN_COUNT 16
+#define STRINGSBUFFER_INDEX_MIN_SIZE  64
+#define STRINGSBUFFER_INDEX_EMPTY     -1
+
+/* Calculates the FNV-1a hash of the given key, ignoring case */
+static cc_uint32 StringsBuffer_HashKey(const cc_string* key) {
+	cc_uint32 hash = 2166136261UL;
+	int i;
+	char c;
+
+	for (i = 0; i < key->length; i++) {
+		c = key->buffer[i]; Char_MakeLower(c);
+		hash = (hash ^ (cc_uint8)c) * 16777619UL;
+	}
+	return hash;
+}
+
+static void StringsBuffer_GetKey(struct StringsBuffer* buffer, int i, cc_string* key) {
+	cc_string entry, value;
+	StringsBuffer_UNSAFE_GetRaw(buffer, i, &entry);
+	String_UNSAFE_Separate(&entry, buffer->_indexSeparator, key, &value);
+}
+
+static void StringsBuffer_IndexInsert(struct StringsBuffer* buffer, int i) {
+	cc_uint32 mask = buffer->_indexCapacity - 1;
+	cc_uint32 slot;
+	cc_string key;
+
+	StringsBuffer_GetKey(buffer, i, &key);
+	slot = StringsBuffer_HashKey(&key) & mask;
+
+	while (buffer->_index[slot] != STRINGSBUFFER_INDEX_EMPTY) {
+		slot = (slot + 1) & mask;
+	}
+	buffer->_index[slot] = i;
+}
+
+static void StringsBuffer_BuildIndex(struct StringsBuffer* buffer, char separator) {
+	int i, capacity = STRINGSBUFFER_INDEX_MIN_SIZE;
+	/* Hash table is kept at most half full, to keep probe sequences short */
+	while (capacity < buffer->count * 2) capacity <<= 1;
+
+	Mem_Free(buffer->_index);
+	buffer->_index          = (int*)Mem_Alloc(capacity, sizeof(int), "StringsBuffer index");
+	buffer->_indexCapacity  = capacity;
+	buffer->_indexSeparator = separator;
+
+	for (i = 0; i < capacity; i++)
+	{
+		buffer->_index[i] = STRINGSBUFFER_INDEX_EMPTY;
+	}
+	for (i = 0; i < buffer->count; i++)
+	{
+		StringsBuffer_IndexInsert(buffer, i);
+	}
+}
+
+static void StringsBuffer_IndexRemove(struct StringsBuffer* buffer, int index) {
+	cc_uint32 mask = buffer->_indexCapacity - 1;
+	cc_uint32 slot, next, home;
+	cc_string key;
+	int i;
+
+	StringsBuffer_GetKey(buffer, index, &key);
+	slot = StringsBuffer_HashKey(&key) & mask;
+
+	while (buffer->_index[slot] != index) {
+		slot = (slot + 1) & mask;
+	}
+
+	/* Move later entries in the probe sequence back into the now empty slot, */
+	/*  so that lookups don't stop early when they reach it */
+	for (next = (slot + 1) & mask; buffer->_index[next] != STRINGSBUFFER_INDEX_EMPTY; next = (next + 1) & mask)
+	{
+		StringsBuffer_GetKey(buffer, buffer->_index[next], &key);
+		home = StringsBuffer_HashKey(&key) & mask;
+
+		/* Can only be moved back if the empty slot is still in this entry's probe sequence */
+		if (((next - home) & mask) < ((next - slot) & mask)) continue;
+		buffer->_index[slot] = buffer->_index[next];
+		slot = next;
+	}
+	buffer->_index[slot] = STRINGSBUFFER_INDEX_EMPTY;
+
+	/* Entries after the removed entry are all shifted down by one */
+	for (i = 0; i < buffer->_indexCapacity; i++)
+	{
+		if (buffer->_index[i] > index) buffer->_index[i]--;
+	}
+}
+
 cc_string StringsBuffer_UNSAFE_Get(struct StringsBuffer* buffer, int i) {
 	cc_uint32 flags, offset, len;
 	if (i < 0 || i >= buffer->count) Process_Abort("Tried to get String past StringsBuffer end");
@@ -885,12 +980,20 @@ void StringsBuffer_Add(struct StringsBuffer* buffer, const cc_string* str) {
 
 	buffer->count++;
 	buffer->totalLength += str->length;
+
+	if (!buffer->_index) return;
+	if (buffer->count * 2 > buffer->_indexCapacity) {
+		StringsBuffer_BuildIndex(buffer, buffer->_indexSeparator);
+	} else {
+		StringsBuffer_IndexInsert(buffer, buffer->count - 1);
+	}
 }
 
 void StringsBuffer_Remove(struct StringsBuffer* buffer, int index) {
 	cc_uint32 flags, offset, len;
 	cc_uint32 i, offsetAdj;
 	if (index < 0 || index >= buffer->count) Process_Abort("Tried to remove String past StringsBuffer end");
+	if (buffer->_index) StringsBuffer_IndexRemove(buffer, index);
 
 	flags  = buffer->flagsBuffer[index];
 	offset = StringsBuffer_GetOffset(flags);
@@ -941,6 +1044,43 @@ static void StringsBuffer_QuickSort(int left, int right) {
 void StringsBuffer_Sort(struct StringsBuffer* buffer) {
 	sort_buffer = buffer;
 	StringsBuffer_QuickSort(0, buffer->count - 1);
+
+	/* Entries have all moved around, so just rebuild hash index later if needed */
+	Mem_Free(buffer->_index);
+	buffer->_index         = NULL;
+	buffer->_indexCapacity = 0;
+}
+
+int StringsBuffer_FindKey(struct StringsBuffer* buffer, const cc_string* key, char separator) {
+	cc_string curEntry, curKey, curValue;
+	cc_uint32 mask, slot;
+	int i, match = -1;
+
+	if (!buffer->_index && buffer->count < STRINGSBUFFER_INDEX_MIN_COUNT) {
+		for (i = 0; i < buffer->count; i++) {
+			StringsBuffer_UNSAFE_GetRaw(buffer, i, &curEntry);
+			String_UNSAFE_Separate(&curEntry, separator, &curKey, &curValue);
+
+			if (String_CaselessEquals(key, &curKey)) return i;
+		}
+		return -1;
+	}
+
+	if (!buffer->_index || buffer->_indexSeparator != separator) {
+		StringsBuffer_BuildIndex(buffer, separator);
+	}
+	mask = buffer->_indexCapacity - 1;
+	slot = StringsBuffer_HashKey(key) & mask;
+
+	for (; (i = buffer->_index[slot]) != STRINGSBUFFER_INDEX_EMPTY; slot = (slot + 1) & mask)
+	{
+		/* There may be multiple entries with the same key, so must find the earliest one */
+		if (match != -1 && i > match) continue;
+
+		StringsBuffer_GetKey(buffer, i, &curKey);
+		if (String_CaselessEquals(key, &curKey)) match = i;
+	}
+	return match;
 }
 
 
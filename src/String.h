@@ -243,6 +243,13 @@ struct StringsBuffer {
 	int _lenShift;
 	/* Value to mask a flags value with to retrieve the length */
 	int _lenMask;
+	/* Open addressed hash table of entry indexes, keyed by the caseless hash of each entry's key */
+	/*  (NULL until StringsBuffer_FindKey is used on a large enough buffer) */
+	int* _index;
+	/* Number of slots in the hash table (always a power of two) */
+	int _indexCapacity;
+	/* Character separating key from value in each entry that the hash table was built for */
+	char _indexSeparator;
 };
 
 /* Resets counts to 0 and other state to default */
@@ -262,6 +269,9 @@ CC_API void StringsBuffer_Add(struct StringsBuffer* buffer, const cc_string* str
 CC_API void StringsBuffer_Remove(struct StringsBuffer* buffer, int index);
 /* Sorts all the entries in the given buffer using String_Compare */
 void StringsBuffer_Sort(struct StringsBuffer* buffer);
+/* Returns index of the first entry whose key (part before separator) caselessly equals the given key, or -1 if none do */
+/* NOTE: Lookups are O(1) on average, as a hash index of keys is built on demand and then kept in sync by Add/Remove */
+int StringsBuffer_FindKey(struct StringsBuffer* buffer, const cc_string* key, char separator);
 
 /* Performs line wrapping on the given string. */
 /* e.g. "some random tex|t* (| is lineLen) becomes "some random" "text" */
@@ -472,7 +472,7 @@ static void SysFont_Close(FT_Stream stream) {
 static cc_result SysFont_Init(const cc_string* path, struct SysFont* font, FT_Open_Args* args) {
 	cc_filepath str;
 	cc_file file;
-	cc_uint32 size;
+	cc_uint64 size;
 	cc_result res;
 #ifdef CC_BUILD_DARWIN
 	cc_string filename;
@@ -16,6 +16,7 @@
 #include "Utils.h"
 #include "Chat.h" /* TODO avoid this include */
 #include "Errors.h"
+#include "Profiler.h"
 
 /* Simple fallback terrain for when no texture packs are available at all */
 static BitmapCol fallback_terrain[16 * 8] = {
@@ -145,6 +146,15 @@ static void Atlas_Convert2DTo1D(void) {
 }
 #endif
 
+/* The world is rendered in one batch (i.e. pass over all visible chunks) per 1D atlas, */
+/*  so taller 1D atlases means fewer batches. On backends with a large max texture size, */
+/*  this usually allows the entire terrain atlas to fit into one 1D atlas. */
+#ifdef CC_BUILD_TALLATLAS
+	#define ATLAS1D_MAX_HEIGHT 16384
+#else
+	#define ATLAS1D_MAX_HEIGHT 4096
+#endif
+
 static void Atlas_Update1D(void) {
 	int maxAtlasHeight, maxTilesPerAtlas, maxTiles;
 	int maxTexHeight = Gfx.MaxTexHeight;
@@ -156,7 +166,7 @@ static void Atlas_Update1D(void) {
 		maxTexHeight     = min(maxTexHeight, maxCurHeight);
 	}
 
-	maxAtlasHeight   = min(4096, maxTexHeight);
+	maxAtlasHeight   = min(ATLAS1D_MAX_HEIGHT, maxTexHeight);
 	maxTilesPerAtlas = maxAtlasHeight / Atlas2D.TileSize;
 	maxTiles         = Atlas2D.RowsCount * ATLAS2D_TILES_PER_ROW;
 
@@ -480,10 +490,525 @@ static cc_result ExtractPng(struct Stream* stream) {
 }
 
 static cc_bool needReload;
+
+#ifdef CC_BUILD_ASYNCTEXPACK
+/*########################################################################################################################*
+*----------------------------------------------------Async extraction-----------------------------------------------------*
+*#########################################################################################################################*/
+/* Texture pack .zip archives are extracted, and the .png files in them decoded, on background worker threads. */
+/* Once a pack has been entirely processed, the main thread raises TextureEvents.FileChanged for its entries */
+/*  (terrain.png first, since other textures may depend on it), only a few per tick. This spreads out the */
+/*  cost of uploading the decoded textures to the GPU over several frames, avoiding one long freeze. */
+#define PACK_WORKERS 2
+#define PACK_APPLY_PER_TICK 4
+
+#define ENTRY_RAW      0 /* Entry is not a .png file */
+#define ENTRY_PENDING  1 /* Entry is a .png file waiting to be decoded */
+#define ENTRY_DECODING 2 /* Entry is a .png file being decoded by a worker */
+#define ENTRY_DECODED  3 /* Entry is a .png file that was decoded */
+
+struct PackEntry {
+	struct PackEntry* next;
+	cc_uint8* data;   /* Uncompressed contents of the entry */
+	cc_uint32 size;
+	struct Bitmap bmp; /* Decoded bitmap, if the entry is a .png file */
+	cc_result res;     /* Result of decoding the .png file */
+	int state, nameLength;
+	char name[FILENAME_SIZE];
+};
+
+struct PackJob {
+	struct PackJob* next;
+	cc_uint8* data;   /* Contents of the .zip archive */
+	cc_uint32 size;
+	struct PackEntry* entriesHead;
+	struct PackEntry* entriesTail;
+	int pendingDecodes;          /* Number of entries still waiting to be or being decoded */
+	cc_bool extracting, extracted, cancelled, applying;
+	cc_result res;               /* Result of extracting the .zip archive */
+	int pathLength;
+	char path[URL_MAX_SIZE];
+};
+
+static void* packMutex;
+static void* packWaitable;
+static void* packThreads[PACK_WORKERS];
+static volatile cc_bool packStopping;
+/* Jobs are applied by the main thread in the order they were queued in */
+static struct PackJob* jobsHead;
+static struct PackJob* jobsTail;
+
+/* Finds the next job to extract, or the next .png entry to decode. Must be called with packMutex held. */
+static struct PackJob* FindPackWork(struct PackEntry** entry) {
+	struct PackJob* job;
+	struct PackEntry* e;
+
+	for (job = jobsHead; job; job = job->next) 
+	{
+		if (!job->extracting) { *entry = NULL; return job; }
+
+		for (e = job->entriesHead; e; e = e->next) 
+		{
+			if (e->state == ENTRY_PENDING) { *entry = e; return job; }
+		}
+	}
+	return NULL;
+}
+
+static struct PackJob* extractJob; /* Job currently being extracted by Zip_Extract */
+static cc_bool SelectPackEntry(const cc_string* path) { return !extractJob->cancelled; }
+
+static cc_result ProcessPackEntry(const cc_string* path, struct Stream* stream, struct ZipEntry* source) {
+	static const cc_string png = String_FromConst(".png");
+	struct PackJob* job = extractJob;
+	struct PackEntry* entry;
+	cc_string name = *path;
+	cc_result res;
+
+	/* entry->size + 1 must also fit in 32 bits */
+	if (source->UncompressedSize >= 0xFFFFFFFFUL) return ZIP_ERR_FILE_TOO_LARGE;
+
+	Utils_UNSAFE_GetFilename(&name);
+	entry = (struct PackEntry*)Mem_TryAllocCleared(1, sizeof(struct PackEntry));
+	if (!entry) return ERR_OUT_OF_MEMORY;
+
+	entry->nameLength = min(name.length, FILENAME_SIZE);
+	Mem_Copy(entry->name, name.buffer, entry->nameLength);
+	entry->size = (cc_uint32)source->UncompressedSize;
+	entry->data = (cc_uint8*)Mem_TryAlloc(entry->size + 1, 1);
+
+	if (!entry->data) { 
+		Mem_Free(entry); return ERR_OUT_OF_MEMORY; 
+	}
+	if ((res = Stream_Read(stream, entry->data, entry->size))) {
+		Mem_Free(entry->data); Mem_Free(entry); return res;
+	}
+
+	Mutex_Lock(packMutex);
+	{
+		LinkedList_Append(entry, job->entriesHead, job->entriesTail);
+		if (String_CaselessEnds(&name, &png)) {
+			entry->state = ENTRY_PENDING;
+			job->pendingDecodes++;
+		}
+	}
+	Mutex_Unlock(packMutex);
+
+	/* Wake up another worker to decode the .png file */
+	if (entry->state == ENTRY_PENDING) Waitable_Signal(packWaitable);
+	return 0;
+}
+
+/* Zip_Extract callbacks have no context argument, so the job being extracted is stored */
+/*  in extractJob, and hence only one job can be extracted at a time */
+static void* extractMutex;
+
+static void ExtractPackJob(struct PackJob* job) {
+	struct ZipEntry entries[512];
+	struct Stream stream;
+	Stream_ReadonlyMemory(&stream, job->data, job->size);
+
+	Mutex_Lock(extractMutex);
+	{
+		extractJob = job;
+		job->res   = Zip_Extract(&stream, SelectPackEntry, ProcessPackEntry,
+								entries, Array_Elems(entries));
+		extractJob = NULL;
+	}
+	Mutex_Unlock(extractMutex);
+}
+
+/* Decoding a high resolution terrain.png takes a while, so its decoded pixels are also saved to */
+/*  texturecache, keyed by a hash of the .png data. Joining a server that uses the same texture */
+/*  pack again then only has to read the pixels back from disc. */
+#define DECODED_CACHE_SLOTS 4
+#define DECODED_CACHE_MIN_PIXELS (512 * 512)
+#define DECODED_HEADER_SIZE 24
+/* Layout of the cached pixels, in case the cache was written by a differently built client */
+#define DECODED_FORMAT ((BITMAPCOLOR_SIZE << 24) | (BITMAPCOLOR_R_SHIFT << 16) | (BITMAPCOLOR_G_SHIFT << 8) | BITMAPCOLOR_B_SHIFT)
+static void* cacheMutex;
+static cc_bool decodedCacheEnabled;
+/* Max size of the pixels saved in each cache slot, in bytes */
+static cc_uint32 decodedCacheMaxSize;
+
+static void DecodedCache_MakePath(cc_string* path, cc_uint32 crc) {
+	int slot = (int)(crc % DECODED_CACHE_SLOTS);
+	String_Format1(path, "texturecache/decoded%i.bin", &slot);
+}
+
+static void DecodedCache_MakeHeader(cc_uint8* header, struct PackEntry* entry, cc_uint32 crc, int width, int height) {
+	header[0] = 'C'; header[1] = 'C'; header[2] = 'D'; header[3] = 'C';
+	Stream_SetU32_LE(&header[4],  DECODED_FORMAT);
+	Stream_SetU32_LE(&header[8],  crc);
+	Stream_SetU32_LE(&header[12], entry->size);
+	Stream_SetU32_LE(&header[16], width);
+	Stream_SetU32_LE(&header[20], height);
+}
+
+static cc_bool DecodedCache_Load(struct PackEntry* entry, cc_uint32 crc) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_uint8 header[DECODED_HEADER_SIZE];
+	cc_uint8 expected[DECODED_HEADER_SIZE];
+	struct Stream stream;
+	struct Bitmap bmp;
+	int width, height;
+	cc_result res;
+
+	String_InitArray(path, pathBuffer);
+	DecodedCache_MakePath(&path, crc);
+	if (Stream_OpenFile(&stream, &path)) return false;
+
+	bmp.scan0 = NULL;
+	DecodedCache_MakeHeader(expected, entry, crc, 0, 0);
+	res = Stream_Read(&stream, header, DECODED_HEADER_SIZE);
+
+	/* Cache slot might be used by a different terrain.png */
+	if (!res && Mem_Equal(header, expected, 16)) {
+		width  = (int)Stream_GetU32_LE(&header[16]);
+		height = (int)Stream_GetU32_LE(&header[20]);
+
+		if (width > 0 && width <= 16384 && height > 0 && height <= 16384) {
+			Bitmap_TryAllocate(&bmp, width, height);
+		}
+		if (bmp.scan0) {
+			res = Stream_Read(&stream, (cc_uint8*)bmp.scan0, width * height * BITMAPCOLOR_SIZE);
+		}
+	}
+	stream.Close(&stream);
+
+	if (!bmp.scan0) return false;
+	if (res) { Mem_Free(bmp.scan0); return false; }
+
+	entry->bmp = bmp;
+	entry->res = 0;
+	return true;
+}
+
+static void DecodedCache_Save(struct PackEntry* entry, cc_uint32 crc) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_uint8 header[DECODED_HEADER_SIZE] = { 0 };
+	struct Bitmap* bmp = &entry->bmp;
+	struct Stream stream;
+	cc_result res;
+
+	String_InitArray(path, pathBuffer);
+	DecodedCache_MakePath(&path, crc);
+	if (Stream_CreateFile(&stream, &path)) return;
+
+	/* Real header is written last, so a partially written cache is never treated as valid */
+	res = Stream_Write(&stream, header, DECODED_HEADER_SIZE);
+	if (!res) res = Stream_Write(&stream, (cc_uint8*)bmp->scan0, bmp->width * bmp->height * BITMAPCOLOR_SIZE);
+	if (!res) res = stream.Seek(&stream, 0);
+
+	if (!res) {
+		DecodedCache_MakeHeader(header, entry, crc, bmp->width, bmp->height);
+		Stream_Write(&stream, header, DECODED_HEADER_SIZE);
+	}
+	stream.Close(&stream);
+}
+
+static cc_bool IsCachedEntry(struct PackEntry* entry) {
+	static const cc_string terrain = String_FromConst("terrain.png");
+	cc_string name = String_Init(entry->name, entry->nameLength, entry->nameLength);
+	return String_CaselessEquals(&name, &terrain);
+}
+
+static void DecodePackEntry(struct PackEntry* entry) {
+	struct Stream stream;
+	cc_bool cached = decodedCacheEnabled && IsCachedEntry(entry);
+	cc_bool loaded = false;
+	cc_uint32 crc  = 0;
+
+	if (cached) {
+		crc = Utils_CRC32(entry->data, entry->size);
+		Mutex_Lock(cacheMutex);
+		{
+			loaded = DecodedCache_Load(entry, crc);
+		}
+		Mutex_Unlock(cacheMutex);
+		if (loaded) return;
+	}
+
+	Stream_ReadonlyMemory(&stream, entry->data, entry->size);
+	entry->res = Png_DecodeData(&entry->bmp, &stream);
+
+	if (!cached || entry->res) return;
+	if (entry->bmp.width * entry->bmp.height < DECODED_CACHE_MIN_PIXELS) return;
+	if ((cc_uint64)entry->bmp.width * entry->bmp.height * BITMAPCOLOR_SIZE > decodedCacheMaxSize) return;
+
+	Mutex_Lock(cacheMutex);
+	{
+		DecodedCache_Save(entry, crc);
+	}
+	Mutex_Unlock(cacheMutex);
+}
+
+static void PackWorkerLoop(void) {
+	struct PackJob* job;
+	struct PackEntry* entry;
+	struct PackEntry* next;
+	cc_bool hasMore;
+	Profiler_NameThread("Texpack");
+
+	for (;;) 
+	{
+		if (packStopping) break;
+		Mutex_Lock(packMutex);
+		{
+			job = FindPackWork(&entry);
+			if (job && entry) { entry->state = ENTRY_DECODING; }
+			else if (job)     { job->extracting = true; }
+
+			hasMore = job && FindPackWork(&next) != NULL;
+		}
+		Mutex_Unlock(packMutex);
+
+		if (!job) {
+			/* Block until the main thread queues another texture pack */
+			Waitable_Wait(packWaitable); continue;
+		}
+		/* Wake up another worker to start on the remaining work */
+		if (hasMore) Waitable_Signal(packWaitable);
+
+		if (entry) {
+			Profiler_BeginZone("DecodePackEntry");
+			if (!job->cancelled) DecodePackEntry(entry);
+			Profiler_EndZone();
+		} else {
+			Profiler_BeginZone("ExtractPackJob");
+			ExtractPackJob(job);
+			Profiler_EndZone();
+		}
+
+		Mutex_Lock(packMutex);
+		{
+			if (entry) {
+				entry->state = ENTRY_DECODED;
+				job->pendingDecodes--;
+			} else {
+				job->extracted = true;
+			}
+		}
+		Mutex_Unlock(packMutex);
+	}
+	/* Wake up the next worker, so that it also notices it needs to stop */
+	Waitable_Signal(packWaitable);
+	Profiler_EndThread();
+}
+
+static void InitPackWorkers(void) {
+	int i;
+	if (packThreads[0]) return;
+
+	packMutex    = Mutex_Create("Texpack jobs");
+	extractMutex = Mutex_Create("Texpack extract");
+	cacheMutex   = Mutex_Create("Texpack cache");
+	packWaitable = Waitable_Create("Texpack wakeup");
+
+	decodedCacheEnabled = Options_GetBool(OPT_DECODED_CACHE, true);
+	decodedCacheMaxSize = (cc_uint32)Options_GetInt(OPT_DECODED_CACHE_MAX_SIZE, 1, 1024, 64) * 1024 * 1024;
+
+	for (i = 0; i < PACK_WORKERS; i++) 
+	{
+		Thread_Run(&packThreads[i], PackWorkerLoop, 256 * 1024, "Texpack");
+	}
+}
+
+/* Attempts to queue extracting the given texture pack on the worker threads */
+static cc_bool QueuePackJob(struct Stream* stream, const cc_string* path) {
+	struct PackJob* job;
+	cc_uint64 length;
+
+	if (stream->Length(stream, &length) || stream->Seek(stream, 0)) return false;
+	/* Too large to load into memory, so just extract it directly from the file instead */
+	if (length >= Int32_MaxValue) return false;
+	job = (struct PackJob*)Mem_TryAllocCleared(1, sizeof(struct PackJob));
+	if (!job) return false;
+
+	job->size = length;
+	job->data = (cc_uint8*)Mem_TryAlloc(length + 1, 1);
+	if (!job->data || Stream_Read(stream, job->data, length)) {
+		Mem_Free(job->data); Mem_Free(job); return false;
+	}
+
+	/* A single .png file is just the terrain atlas, which isn't worth doing asynchronously */
+	if (Png_Detect(job->data, length)) {
+		Mem_Free(job->data); Mem_Free(job);
+		stream->Seek(stream, 0); return false;
+	}
+
+	job->pathLength = min(path->length, URL_MAX_SIZE);
+	Mem_Copy(job->path, path->buffer, job->pathLength);
+	InitPackWorkers();
+
+	Mutex_Lock(packMutex);
+	{
+		LinkedList_Append(job, jobsHead, jobsTail);
+	}
+	Mutex_Unlock(packMutex);
+	Waitable_Signal(packWaitable);
+	return true;
+}
+
+static void FreePackJob(struct PackJob* job) {
+	struct PackEntry* entry;
+	struct PackEntry* next;
+
+	for (entry = job->entriesHead; entry; entry = next) 
+	{
+		next = entry->next;
+		Mem_Free(entry->data);
+		if (entry->state == ENTRY_DECODED) Mem_Free(entry->bmp.scan0);
+		Mem_Free(entry);
+	}
+	Mem_Free(job->data);
+	Mem_Free(job);
+}
+
+/* Cancels all queued texture packs, e.g. because the current texture pack is being reloaded */
+static void CancelPackJobs(void) {
+	struct PackJob* job;
+	if (!packMutex) return;
+
+	Mutex_Lock(packMutex);
+	{
+		for (job = jobsHead; job; job = job->next) { job->cancelled = true; }
+	}
+	Mutex_Unlock(packMutex);
+}
+
+/* Stops all the worker threads, and frees any texture packs that were still queued */
+static void StopPackWorkers(void) {
+	struct PackJob* job;
+	struct PackJob* next;
+	int i;
+	if (!packThreads[0]) return;
+
+	/* Cancelling makes any in progress extraction finish early */
+	CancelPackJobs();
+	packStopping = true;
+
+	Waitable_Signal(packWaitable);
+	for (i = 0; i < PACK_WORKERS; i++) 
+	{
+		Thread_Join(packThreads[i]);
+		packThreads[i] = NULL;
+	}
+
+	for (job = jobsHead; job; job = next) 
+	{
+		next = job->next;
+		FreePackJob(job);
+	}
+	jobsHead = NULL;
+	jobsTail = NULL;
+
+	Mutex_Free(packMutex);    packMutex    = NULL;
+	Mutex_Free(extractMutex); extractMutex = NULL;
+	Mutex_Free(cacheMutex);   cacheMutex   = NULL;
+	Waitable_Free(packWaitable); packWaitable = NULL;
+	packStopping = false;
+}
+
+static void ApplyPackEntry(struct PackEntry* entry) {
+	struct Stream stream;
+	cc_string name = String_Init(entry->name, entry->nameLength, entry->nameLength);
+	Stream_ReadonlyMemory(&stream, entry->data, entry->size);
+
+	/* Handlers decoding the .png file get the bitmap decoded by the worker instead */
+	if (entry->state == ENTRY_DECODED) Png_SetDecoded(&stream, &entry->bmp, entry->res);
+	Event_RaiseEntry(&TextureEvents.FileChanged, &stream, &name);
+
+	/* Ownership of the bitmap was transferred to the handler that decoded it */
+	if (entry->state == ENTRY_DECODED && !Png_ClearDecoded()) entry->state = ENTRY_RAW;
+}
+
+/* Moves terrain.png to be the first entry, as other textures may depend on the terrain atlas */
+static void SortPackEntries(struct PackJob* job) {
+	struct PackEntry* prev = NULL;
+	struct PackEntry* entry;
+	cc_string name;
+
+	for (entry = job->entriesHead; entry; prev = entry, entry = entry->next) 
+	{
+		name = String_Init(entry->name, entry->nameLength, entry->nameLength);
+		if (!String_CaselessEqualsConst(&name, "terrain.png")) continue;
+		if (!prev) return;
+
+		prev->next = entry->next;
+		if (job->entriesTail == entry) job->entriesTail = prev;
+		entry->next = job->entriesHead;
+		job->entriesHead = entry;
+		return;
+	}
+}
+
+static void ApplyPackJobs(struct ScheduledTask* task) {
+	struct PackJob* job;
+	struct PackEntry* entry;
+	cc_string path;
+	cc_bool ready;
+	int applied = 0;
+
+	while (jobsHead) 
+	{
+		Mutex_Lock(packMutex);
+		{
+			job   = jobsHead;
+			ready = job->extracted && !job->pendingDecodes;
+		}
+		Mutex_Unlock(packMutex);
+		if (!ready) return;
+
+		if (!job->applying && !job->cancelled) {
+			job->applying = true;
+			Event_RaiseVoid(&TextureEvents.PackChanged);
+			/* If context is lost, then trying to load textures will just fail */
+			/* So defer loading the texture pack until context is restored */
+			if (Gfx.LostContext) { needReload = true; job->cancelled = true; }
+
+			path = String_Init(job->path, job->pathLength, job->pathLength);
+			if (job->res) Logger_SysWarn2(job->res, "extracting", &path);
+			SortPackEntries(job);
+		}
+
+		while (!job->cancelled && (entry = job->entriesHead) && applied < PACK_APPLY_PER_TICK) 
+		{
+			ApplyPackEntry(entry);
+			applied++;
+
+			job->entriesHead = entry->next;
+			entry->next      = NULL;
+			job->entriesTail = job->entriesHead ? job->entriesTail : NULL;
+
+			Mem_Free(entry->data);
+			if (entry->state == ENTRY_DECODED) Mem_Free(entry->bmp.scan0);
+			Mem_Free(entry);
+		}
+		if (!job->cancelled && job->entriesHead) return;
+
+		Mutex_Lock(packMutex);
+		{
+			jobsHead = job->next;
+			if (!jobsHead) jobsTail = NULL;
+		}
+		Mutex_Unlock(packMutex);
+		FreePackJob(job);
+
+		/* Use fallback terrain texture with 1 pixel per tile */
+		if (!jobsHead && !Atlas2D.Bmp.scan0) LoadFallbackAtlas();
+	}
+}
+#endif
+
 static cc_result ExtractFrom(struct Stream* stream, const cc_string* path) {
 	struct ZipEntry entries[512];
 	cc_result res;
 
+#ifdef CC_BUILD_ASYNCTEXPACK
+	/* PackChanged is raised once the pack is about to be applied instead */
+	if (!Gfx.LostContext && QueuePackJob(stream, path)) { needReload = false; return 0; }
+#endif
 	Event_RaiseVoid(&TextureEvents.PackChanged);
 	/* If context is lost, then trying to load textures will just fail */
 	/* So defer loading the texture pack until context is restored */
@@ -552,6 +1077,10 @@ cc_result TexturePack_ExtractCurrent(cc_bool forceReload) {
 
 	/* don't pointlessly load default texture pack */
 	if (!usingDefault || forceReload) {
+#ifdef CC_BUILD_ASYNCTEXPACK
+		/* Any previously queued texture packs are about to be replaced anyways */
+		CancelPackJobs();
+#endif
 		res = ExtractUserTextures();
 		usingDefault = true;
 	}
@@ -565,6 +1094,9 @@ cc_result TexturePack_ExtractCurrent(cc_bool forceReload) {
 	}
 
 	/* Use fallback terrain texture with 1 pixel per tile */
+#ifdef CC_BUILD_ASYNCTEXPACK
+	if (jobsHead) return res;
+#endif
 	if (!Atlas2D.Bmp.scan0) LoadFallbackAtlas();
 	return res;
 }
@@ -693,6 +1225,9 @@ static void OnInit(void) {
 	entries_head = NULL;
 
 	TextureEntry_Register(&terrain_entry);
+#ifdef CC_BUILD_ASYNCTEXPACK
+	ScheduledTask_Add(GAME_NET_TICKS, ApplyPackJobs);
+#endif
 	Utils_EnsureDirectory("texpacks");
 	Utils_EnsureDirectory("texturecache");
 	TextureCache_Init();
@@ -705,6 +1240,9 @@ static void OnReset(void) {
 }
 
 static void OnFree(void) {
+#ifdef CC_BUILD_ASYNCTEXPACK
+	StopPackWorkers();
+#endif
 	OnContextLost(NULL);
 	Atlas2D_Free();
 	TexturePack_Url.length = 0;
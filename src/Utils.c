@@ -342,27 +342,15 @@ void EntryList_Set(struct StringsBuffer* list, const cc_string* key, const cc_st
 
 cc_string EntryList_UNSAFE_Get(struct StringsBuffer* list, const cc_string* key, char separator) {
 	cc_string curEntry, curKey, curValue;
-	int i;
-
-	for (i = 0; i < list->count; i++) {
-		StringsBuffer_UNSAFE_GetRaw(list, i, &curEntry);
-		String_UNSAFE_Separate(&curEntry, separator, &curKey, &curValue);
+	int i = StringsBuffer_FindKey(list, key, separator);
+	if (i == -1) return String_Empty;
 
-		if (String_CaselessEquals(key, &curKey)) return curValue;
-	}
-	return String_Empty;
+	StringsBuffer_UNSAFE_GetRaw(list, i, &curEntry);
+	String_UNSAFE_Separate(&curEntry, separator, &curKey, &curValue);
+	return curValue;
 }
 
 int EntryList_Find(struct StringsBuffer* list, const cc_string* key, char separator) {
-	cc_string curEntry, curKey, curValue;
-	int i;
-
-	for (i = 0; i < list->count; i++) {
-		StringsBuffer_UNSAFE_GetRaw(list, i, &curEntry);
-		String_UNSAFE_Separate(&curEntry, separator, &curKey, &curValue);
-
-		if (String_CaselessEquals(key, &curKey)) return i;
-	}
-	return -1;
+	return StringsBuffer_FindKey(list, key, separator);
 }
 
@@ -207,6 +207,26 @@ cc_bool FrustumCulling_SphereInFrustum(float x, float y, float z, float radius)
 	return true;
 }
 
+cc_bool FrustumCulling_SphereFullyInFrustum(float x, float y, float z, float radius) {
+	float d;
+
+	d = frustumR.a * x + frustumR.b * y + frustumR.c * z + frustumR.d;
+	if (d < radius) return false;
+
+	d = frustumL.a * x + frustumL.b * y + frustumL.c * z + frustumL.d;
+	if (d < radius) return false;
+
+	d = frustumB.a * x + frustumB.b * y + frustumB.c * z + frustumB.d;
+	if (d < radius) return false;
+
+	d = frustumT.a * x + frustumT.b * y + frustumT.c * z + frustumT.d;
+	if (d < radius) return false;
+
+	d = frustumF.a * x + frustumF.b * y + frustumF.c * z + frustumF.d;
+	if (d < radius) return false;
+	return true;
+}
+
 void FrustumCulling_CalcFrustumEquations(struct Matrix* clip) {
 	/* Extract the RIGHT plane */
 	frustumR.a = clip->row1.w - clip->row1.x;
@@ -1,4 +1,7 @@
 #include "Vorbis.h"
+#ifdef CC_BUILD_SSE2
+#include <emmintrin.h>
+#endif
 #include "Logger.h"
 #include "Platform.h"
 #include "Event.h"
@@ -142,14 +145,27 @@ void Ogg_Init(struct OggState* ctx, struct Stream* source) {
 #define Vorbis_ConsumeBits(ctx, bits) ctx->Bits >>= (bits); ctx->NumBits -= (bits);
 /* Aligns bit buffer to be on a byte boundary */
 #define Vorbis_AlignBits(ctx) alignSkip = ctx->NumBits & 7; Vorbis_ConsumeBits(ctx, alignSkip);
+/* Discards all bits in the bit buffer */
+#define Vorbis_ResetBits(ctx) ctx->Bits = 0; ctx->NumBits = 0;
 /* See https://xiph.org/vorbis/doc/Vorbis_I_spec.html */
 
-/* TODO: Make sure this is inlined */
+/* Tops up bit buffer to at least 25 bits, using only the bytes left in the current packet */
+/*  (i.e. never blocks on reading the next page, unlike the byte by byte fallback below) */
+static void Vorbis_Refill(struct VorbisState* ctx) {
+	struct OggState* source = ctx->source;
+
+	while (ctx->NumBits <= 24 && source->left) {
+		Vorbis_PushByte(ctx, *source->cur);
+		source->cur++; source->left--;
+	}
+}
+
 static cc_uint32 Vorbis_ReadBits(struct VorbisState* ctx, cc_uint32 bitsCount) {
 	cc_uint8 portion;
 	cc_uint32 data;
 	cc_result res;
 
+	if (ctx->NumBits < bitsCount) Vorbis_Refill(ctx);
 	while (ctx->NumBits < bitsCount) {
 		res = Ogg_ReadU8(ctx->source, &portion);
 		if (res) { Process_Abort2(res, "Failed to read byte for vorbis"); }
@@ -164,6 +180,7 @@ static cc_result Vorbis_TryReadBits(struct VorbisState* ctx, cc_uint32 bitsCount
 	cc_uint8 portion;
 	cc_result res;
 
+	if (ctx->NumBits < bitsCount) Vorbis_Refill(ctx);
 	while (ctx->NumBits < bitsCount) {
 		res = Ogg_ReadU8(ctx->source, &portion);
 		if (res) return res;
@@ -179,6 +196,7 @@ static cc_uint32 Vorbis_ReadBit(struct VorbisState* ctx) {
 	cc_uint32 data;
 	cc_result res;
 
+	if (!ctx->NumBits) Vorbis_Refill(ctx);
 	if (!ctx->NumBits) {
 		res = Ogg_ReadU8(ctx->source, &portion);
 		if (res) { Process_Abort2(res, "Failed to read byte for vorbis"); }
@@ -197,6 +215,15 @@ static int iLog(int x) {
 	return bits;
 }
 
+static cc_uint32 Vorbis_ReverseBits(cc_uint32 v) {
+	v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+	v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+	v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
+	v = ((v >> 8) & 0x00FF00FF) | ((v & 0x00FF00FF) << 8);
+	v = (v >> 16) | (v << 16);
+	return v;
+}
+
 /* https://en.wikipedia.org/wiki/Single-precision_floating-point_format */
 /* Float consists of: */
 /* - 1 bit for sign */
@@ -254,6 +281,8 @@ struct Codebook {
 	cc_uint32* codewords;
 	cc_uint32* values;
 	cc_uint32 numCodewords[33]; /* number of codewords of bit length i */
+	cc_uint32* table; /* lookup table for decoding codewords, see Codebook_BuildTable */
+	int tableBits;    /* number of bits used to index root of lookup table */
 	/* vector quantisation values */
 	float minValue, deltaValue;
 	cc_uint32 sequenceP, lookupType, lookupValues;
@@ -264,6 +293,7 @@ static void Codebook_Free(struct Codebook* c) {
 	Mem_Free(c->codewords);
 	Mem_Free(c->values);
 	Mem_Free(c->multiplicands);
+	Mem_Free(c->table);
 }
 
 static cc_uint32 Codebook_Pow(cc_uint32 base, cc_uint32 exp) {
@@ -357,6 +387,103 @@ static cc_bool Codebook_CalcCodewords(struct Codebook* c, cc_uint8* len) {
 	return true;
 }
 
+/* Codewords up to this many bits long are decoded with a single lookup in the root table */
+#define CODEBOOK_ROOT_BITS 10
+/* Longer codewords are decoded with a second lookup in a subtable linked from the root table */
+/*  (codewords too long to fit in a subtable fallback to Codebook_DecodeSlow instead) */
+#define CODEBOOK_MAX_SUB_BITS 10
+
+/* Table entry for a codeword of 'len' bits (0 means not in table) */
+#define CODEBOOK_LEAF(value, len) (((value) << 6) | (len))
+/* Table entry linking to a subtable at 'offset', indexed by the next 'bits' bits */
+#define CODEBOOK_LINK(offset, bits) (((offset) << 11) | ((bits) << 6) | 0x3F)
+#define Codebook_IsLink(entry) (((entry) & 0x3F) == 0x3F)
+
+static void Codebook_BuildTable(struct Codebook* c) {
+	cc_uint8 subBits[1 << CODEBOOK_ROOT_BITS];
+	cc_uint32 rootBits, rootSize, total, offset;
+	cc_uint32 depth, maxDepth = 0, i, j, idx;
+	cc_uint32 code, entry, bits;
+	cc_uint32* table;
+	cc_uint32* sub;
+
+	for (depth = 1; depth <= 32; depth++) 
+	{
+		if (c->numCodewords[depth]) maxDepth = depth;
+	}
+	if (!maxDepth) return;
+
+	rootBits = min(maxDepth, CODEBOOK_ROOT_BITS);
+	rootSize = 1 << rootBits;
+	Mem_Set(subBits, 0, rootSize);
+
+	/* Codewords are ordered by length, so skip past the ones that fit in root table */
+	for (depth = 1, i = 0; depth <= rootBits; depth++) 
+	{
+		i += c->numCodewords[depth];
+	}
+
+	/* Work out how many bits each subtable needs to be indexed by */
+	for (; depth <= maxDepth; depth++) 
+	{
+		for (j = 0; j < c->numCodewords[depth]; j++, i++) 
+		{
+			code = Vorbis_ReverseBits(c->codewords[i]) & (rootSize - 1);
+			subBits[code] = depth - rootBits;
+		}
+	}
+
+	total = rootSize;
+	for (i = 0; i < rootSize; i++) 
+	{
+		if (subBits[i] > CODEBOOK_MAX_SUB_BITS) subBits[i] = 0;
+		if (subBits[i]) total += 1 << subBits[i];
+	}
+
+	table = (cc_uint32*)Mem_TryAllocCleared(total, 4);
+	if (!table) return;
+	
+	for (i = 0, offset = rootSize; i < rootSize; i++) 
+	{
+		if (!subBits[i]) continue;
+		table[i] = CODEBOOK_LINK(offset, subBits[i]);
+		offset  += 1 << subBits[i];
+	}
+
+	/* Codewords are stored MSB first, but bit buffer is read LSB first */
+	/*  so reverse codeword, then fill every index that ends with that codeword */
+	for (depth = 1, i = 0; depth <= maxDepth; depth++) 
+	{
+		for (j = 0; j < c->numCodewords[depth]; j++, i++) 
+		{
+			code = Vorbis_ReverseBits(c->codewords[i]);
+
+			if (depth <= rootBits) {
+				for (idx = code; idx < rootSize; idx += 1 << depth) 
+				{
+					table[idx] = CODEBOOK_LEAF(c->values[i], depth);
+				}
+				continue;
+			}
+
+			/* Not a link when subtable would be too large, or a shorter codeword */
+			/*  overwrote it (only happens with malformed codebooks) */
+			entry = table[code & (rootSize - 1)];
+			if (!Codebook_IsLink(entry)) continue;
+
+			sub  = table + (entry >> 11);
+			bits = (entry >> 6) & 0x1F;
+			for (idx = code >> rootBits; idx < (1U << bits); idx += 1 << (depth - rootBits)) 
+			{
+				sub[idx] = CODEBOOK_LEAF(c->values[i], depth);
+			}
+		}
+	}
+
+	c->table     = table;
+	c->tableBits = rootBits;
+}
+
 static cc_result Codebook_DecodeSetup(struct VorbisState* ctx, struct Codebook* c) {
 	cc_uint32 sync;
 	cc_uint8* codewordLens;
@@ -366,6 +493,7 @@ static cc_result Codebook_DecodeSetup(struct VorbisState* ctx, struct Codebook*
 	int valueBits;
 	cc_uint32 lookupValues;
 
+	c->table = NULL;
 	sync = Vorbis_ReadBits(ctx, 24);
 	if (sync != CODEBOOK_SYNC) return VORBIS_ERR_CODEBOOK_SYNC;
 	c->dimensions = Vorbis_ReadBits(ctx, 16);
@@ -410,8 +538,12 @@ static cc_result Codebook_DecodeSetup(struct VorbisState* ctx, struct Codebook*
 	}
 
 	c->totalCodewords = entry;
-	Codebook_CalcCodewords(c, codewordLens);
+	if (!Codebook_CalcCodewords(c, codewordLens)) {
+		Mem_Free(codewordLens);
+		return VORBIS_ERR_CODEBOOK_ENTRY;
+	}
 	Mem_Free(codewordLens);
+	Codebook_BuildTable(c);
 
 	c->lookupType    = Vorbis_ReadBits(ctx, 4);
 	c->multiplicands = NULL;
@@ -438,12 +570,12 @@ static cc_result Codebook_DecodeSetup(struct VorbisState* ctx, struct Codebook*
 	return 0;
 }
 
-static cc_uint32 Codebook_DecodeScalar(struct VorbisState* ctx, struct Codebook* c) {
+/* Decodes a codeword by reading one bit at a time and comparing against all codewords of that length */
+static cc_uint32 Codebook_DecodeSlow(struct VorbisState* ctx, struct Codebook* c) {
 	cc_uint32 codeword = 0, shift = 31, depth, i;
 	cc_uint32* codewords = c->codewords;
 	cc_uint32* values    = c->values;
 
-	/* TODO: This is so massively slow */
 	for (depth = 1; depth <= 32; depth++, shift--) 
 	{
 		codeword |= Vorbis_ReadBit(ctx) << shift;
@@ -461,6 +593,26 @@ static cc_uint32 Codebook_DecodeScalar(struct VorbisState* ctx, struct Codebook*
 	return -1;
 }
 
+static cc_uint32 Codebook_DecodeScalar(struct VorbisState* ctx, struct Codebook* c) {
+	cc_uint32 entry, len;
+	if (!c->table) return Codebook_DecodeSlow(ctx, c);
+
+	Vorbis_Refill(ctx);
+	entry = c->table[Vorbis_PeekBits(ctx, c->tableBits)];
+
+	if (Codebook_IsLink(entry)) {
+		len   = c->tableBits + ((entry >> 6) & 0x1F);
+		entry = c->table[(entry >> 11) + (Vorbis_PeekBits(ctx, len) >> c->tableBits)];
+	}
+
+	/* Not enough bits buffered when near end of packet, or codeword not in table */
+	len = entry & 0x3F;
+	if (!len || len > ctx->NumBits) return Codebook_DecodeSlow(ctx, c);
+
+	Vorbis_ConsumeBits(ctx, len);
+	return entry >> 6;
+}
+
 static void Codebook_DecodeVectors(struct VorbisState* ctx, struct Codebook* c, float* v, int step) {
 	cc_uint32 lookupOffset = Codebook_DecodeScalar(ctx, c);
 	float last = 0.0f, value;
@@ -815,6 +967,15 @@ static void Floor_Synthesis(struct VorbisState* ctx, struct Floor* f, int ch) {
 	lx = hx; hx = ctx->dataSize;
 
 	value = floor1_inverse_dB_table[hy];
+#ifdef CC_BUILD_SSE2
+	{
+		__m128 scale = _mm_set1_ps(value);
+		for (; lx + 4 <= hx; lx += 4) 
+		{
+			_mm_storeu_ps(data + lx, _mm_mul_ps(_mm_loadu_ps(data + lx), scale));
+		}
+	}
+#endif
 	for (; lx < hx; lx++) { data[lx] *= value; }
 }
 
@@ -977,7 +1138,21 @@ static void Residue_DecodeFrame(struct VorbisState* ctx, struct Residue* r, int
 		Residue_DecodeCore(ctx, r, size * ch, 1, &decodeAny, &interleaved);
 
 		/* deinterleave type 2 output */	
-		for (i = 0; i < size; i++) 
+		i = 0;
+#ifdef CC_BUILD_SSE2
+		/* stereo is by far the most common case */
+		if (ch == 2) {
+			__m128 a, b;
+			for (; i + 4 <= size; i += 4) 
+			{
+				a = _mm_loadu_ps(interleaved + i * 2);
+				b = _mm_loadu_ps(interleaved + i * 2 + 4);
+				_mm_storeu_ps(data[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+				_mm_storeu_ps(data[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+			}
+		}
+#endif
+		for (; i < size; i++) 
 		{
 			for (j = 0; j < ch; j++) 
 			{
@@ -1058,14 +1233,6 @@ static cc_result Mapping_DecodeSetup(struct VorbisState* ctx, struct Mapping* m)
 *------------------------------------------------------imdct impl---------------------------------------------------------*
 *#########################################################################################################################*/
 #define PI MATH_PI
-static cc_uint32 Vorbis_ReverseBits(cc_uint32 v) {
-	v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
-	v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
-	v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
-	v = ((v >> 8) & 0x00FF00FF) | ((v & 0x00FF00FF) << 8);
-	v = (v >> 16) | (v << 16);
-	return v;
-}
 
 void imdct_init(struct imdct_state* state, int n) {
 	int k, k2, n4 = n >> 2, n8 = n >> 3, log2_n;
@@ -1137,8 +1304,32 @@ void imdct_calc(float* in, float* out, struct imdct_state* state) {
 	{
 		int k0 = n >> (l+3), k1 = 1 << (l+3);
 		int r, r2, rMax = n >> (l+4), s2, s2Max = 1 << (l+2);
+		r = 0;
+
+#ifdef CC_BUILD_SSE2
+		/* Calculate butterflies for 'r' and 'r+1' at once */
+		/* (same operations as scalar loop below, so results are identical) */
+		for (r2 = 0; r + 2 <= rMax; r += 2, r2 += 4) 
+		{
+			__m128 a0 = _mm_setr_ps(A[(r+1)*k1],    A[(r+1)*k1],   A[r*k1],    A[r*k1]);
+			__m128 a1 = _mm_setr_ps(A[(r+1)*k1+1], -A[(r+1)*k1+1], A[r*k1+1], -A[r*k1+1]);
+			__m128 e, f, d;
+
+			for (s2 = 0; s2 < s2Max; s2 += 2) 
+			{
+				/* e_2/e_1 and f_2/f_1 values for r+1, then for r */
+				e = _mm_loadu_ps(&w[n2-4-k0*s2-r2]);
+				f = _mm_loadu_ps(&w[n2-4-k0*(s2+1)-r2]);
+				d = _mm_sub_ps(e, f);
+
+				_mm_storeu_ps(&u[n2-4-k0*s2-r2], _mm_add_ps(e, f));
+				_mm_storeu_ps(&u[n2-4-k0*(s2+1)-r2], _mm_add_ps(_mm_mul_ps(d, a0),
+							  _mm_mul_ps(_mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)), a1)));
+			}
+		}
+#endif
 
-		for (r = 0, r2 = 0; r < rMax; r++, r2 += 2) 
+		for (r2 = r * 2; r < rMax; r++, r2 += 2) 
 		{
 			for (s2 = 0; s2 < s2Max; s2 += 2) 
 			{
@@ -1413,6 +1604,7 @@ cc_result Vorbis_DecodeHeaders(struct VorbisState* ctx) {
 	if ((res = Vorbis_CheckHeader(ctx, 5)))   return res;
 	if ((res = Vorbis_DecodeSetup(ctx)))      return res;
 	Ogg_DiscardPacket(ctx->source);
+	Vorbis_ResetBits(ctx); /* may have buffered bytes from rest of setup packet */
 
 	/* window calculations can be pre-computed here */
 	count = ctx->blockSizes[0] + ctx->blockSizes[1];
@@ -1484,7 +1676,7 @@ cc_result Vorbis_DecodeFrame(struct VorbisState* ctx) {
 
 	/* swap prev and cur outputs around */
 	tmp = ctx->values[1]; ctx->values[1] = ctx->values[0]; ctx->values[0] = tmp;
-	Mem_Set(ctx->values[0], 0, ctx->channels * ctx->curBlockSize);
+	Mem_Set(ctx->values[0], 0, ctx->channels * ctx->curBlockSize * sizeof(float));
 
 	for (i = 0; i < ctx->channels; i++) 
 	{
@@ -1535,8 +1727,33 @@ cc_result Vorbis_DecodeFrame(struct VorbisState* ctx) {
 	{
 		magValues = ctx->curOutput[mapping->magnitude[i]];
 		angValues = ctx->curOutput[mapping->angle[i]];
+		j = 0;
 
-		for (j = 0; j < ctx->dataSize; j++) 
+#ifdef CC_BUILD_SSE2
+		{
+			__m128 zero = _mm_setzero_ps(), sign = _mm_set1_ps(-0.0f);
+			__m128 mv, av, mPos, aPos, adj;
+
+			for (; j + 4 <= ctx->dataSize; j += 4) 
+			{
+				mv   = _mm_loadu_ps(magValues + j);
+				av   = _mm_loadu_ps(angValues + j);
+				mPos = _mm_cmpgt_ps(mv, zero);
+				aPos = _mm_cmpgt_ps(av, zero);
+				/* a when m > 0, -a otherwise */
+				adj  = _mm_xor_ps(av, _mm_andnot_ps(mPos, sign));
+
+				/* a > 0: magnitude = m, angle = m - adj */
+				/* else : magnitude = m + adj, angle = m */
+				_mm_storeu_ps(magValues + j, _mm_or_ps(_mm_and_ps(aPos, mv),
+							  _mm_andnot_ps(aPos, _mm_add_ps(mv, adj))));
+				_mm_storeu_ps(angValues + j, _mm_or_ps(_mm_and_ps(aPos, _mm_sub_ps(mv, adj)),
+							  _mm_andnot_ps(aPos, mv)));
+			}
+		}
+#endif
+
+		for (; j < ctx->dataSize; j++) 
 		{
 			m = magValues[j]; a = angValues[j];
 
@@ -1585,6 +1802,86 @@ cc_result Vorbis_DecodeFrame(struct VorbisState* ctx) {
 	return 0;
 }
 
+/* Converts 'count' samples from each channel to 16 bit PCM, interleaving them into 'data' */
+static cc_int16* Vorbis_Interleave(cc_int16* data, float** src, int channels, int count) {
+	float sample;
+	int i = 0, ch;
+
+#ifdef CC_BUILD_SSE2
+	__m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+	__m128i a, b;
+	#define Vorbis_Convert8(src) _mm_packs_epi32( \
+		_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src),     lo), hi), scale)), \
+		_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + 4), lo), hi), scale)))
+
+	if (channels == 1) {
+		for (; i + 8 <= count; i += 8, data += 8) 
+		{
+			_mm_storeu_si128((__m128i*)data, Vorbis_Convert8(src[0] + i));
+		}
+	} else if (channels == 2) {
+		for (; i + 8 <= count; i += 8, data += 16) 
+		{
+			a = Vorbis_Convert8(src[0] + i);
+			b = Vorbis_Convert8(src[1] + i);
+			_mm_storeu_si128((__m128i*)data,       _mm_unpacklo_epi16(a, b));
+			_mm_storeu_si128((__m128i*)(data + 8), _mm_unpackhi_epi16(a, b));
+		}
+	}
+#endif
+
+	for (; i < count; i++) 
+	{
+		for (ch = 0; ch < channels; ch++) 
+		{
+			sample = src[ch][i];
+			Math_Clamp(sample, -1.0f, 1.0f);
+			*data++ = (cc_int16)(sample * 32767);
+		}
+	}
+	return data;
+}
+
+/* Applies window to overlapping samples from 'prev' and 'cur', then interleaves them into 'data' */
+static cc_int16* Vorbis_InterleaveOverlap(cc_int16* data, float** prev, float** cur, 
+										struct VorbisWindow* window, int channels, int count) {
+	float overlap[VORBIS_MAX_CHANS][256];
+	float* src[VORBIS_MAX_CHANS];
+	float* wPrev;
+	float* wCur;
+	int i, j, ch, size;
+
+	for (ch = 0; ch < channels; ch++) { src[ch] = overlap[ch]; }
+
+	for (i = 0; i < count; i += size) 
+	{
+		size  = min(count - i, 256);
+		wPrev = window->Prev + i;
+		wCur  = window->Cur  + i;
+
+		for (ch = 0; ch < channels; ch++) 
+		{
+			float* p = prev[ch] + i;
+			float* c = cur[ch]  + i;
+			j = 0;
+#ifdef CC_BUILD_SSE2
+			for (; j + 4 <= size; j += 4) 
+			{
+				_mm_storeu_ps(&overlap[ch][j], _mm_add_ps(
+					_mm_mul_ps(_mm_loadu_ps(p + j), _mm_loadu_ps(wPrev + j)),
+					_mm_mul_ps(_mm_loadu_ps(c + j), _mm_loadu_ps(wCur  + j))));
+			}
+#endif
+			for (; j < size; j++) 
+			{
+				overlap[ch][j] = p[j] * wPrev[j] + c[j] * wCur[j];
+			}
+		}
+		data = Vorbis_Interleave(data, src, channels, size);
+	}
+	return data;
+}
+
 int Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data) {
 	struct VorbisWindow window;
 	float* prev[VORBIS_MAX_CHANS];
@@ -1592,8 +1889,7 @@ int Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data) {
 
 	int curQrtr, prevQrtr, overlapQtr;
 	int curOffset, prevOffset, overlapSize;
-	float sample;
-	int i, ch;
+	int i;
 
 	/* first frame decoded has no data */
 	if (ctx->prevBlockSize == 0) {
@@ -1626,15 +1922,7 @@ int Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data) {
 	}
 
 	/* for long prev and short cur block, there will be non-overlapped data before */
-	for (i = 0; i < prevOffset; i++) 
-	{
-		for (ch = 0; ch < ctx->channels; ch++) 
-		{
-			sample = prev[ch][i];
-			Math_Clamp(sample, -1.0f, 1.0f);
-			*data++ = (cc_int16)(sample * 32767);
-		}
-	}
+	data = Vorbis_Interleave(data, prev, ctx->channels, prevOffset);
 
 	/* adjust pointers to start at 0 for overlapping */
 	for (i = 0; i < ctx->channels; i++) 
@@ -1647,27 +1935,11 @@ int Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data) {
 
 	/* overlap and add data */
 	/* also perform windowing here */
-	for (i = 0; i < overlapSize; i++) 
-	{
-		for (ch = 0; ch < ctx->channels; ch++) 
-		{
-			sample = prev[ch][i] * window.Prev[i] + cur[ch][i] * window.Cur[i];
-			Math_Clamp(sample, -1.0f, 1.0f);
-			*data++ = (cc_int16)(sample * 32767);
-		}
-	}
+	data = Vorbis_InterleaveOverlap(data, prev, cur, &window, ctx->channels, overlapSize);
 
 	/* for long cur and short prev block, there will be non-overlapped data after */
 	for (i = 0; i < ctx->channels; i++) { cur[i] += overlapSize; }
-	for (i = 0; i < curOffset; i++) 
-	{
-		for (ch = 0; ch < ctx->channels; ch++) 
-		{
-			sample = cur[ch][i];
-			Math_Clamp(sample, -1.0f, 1.0f);
-			*data++ = (cc_int16)(sample * 32767);
-		}
-	}
+	Vorbis_Interleave(data, cur, ctx->channels, curOffset);
 
 	ctx->prevBlockSize = ctx->curBlockSize;
 	return (prevQrtr + curQrtr) * ctx->channels;
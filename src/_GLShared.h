@@ -68,8 +68,10 @@ static void* FastAllocTempMem(int size) {
 *---------------------------------------------------------Textures--------------------------------------------------------*
 *#########################################################################################################################*/
 static void Gfx_DoMipmaps(int x, int y, struct Bitmap* bmp, int rowWidth, cc_bool partial) {
+	BitmapCol buffer[MIPMAPS_FAST_SIZE];
+	BitmapCol* data = AllocMipmaps(bmp, buffer);
 	BitmapCol* prev = bmp->scan0;
-	BitmapCol* cur;
+	BitmapCol* cur  = data;
 
 	int lvls = CalcMipmapsLevels(bmp->width, bmp->height);
 	int lvl, width = bmp->width, height = bmp->height;
@@ -79,7 +81,6 @@ static void Gfx_DoMipmaps(int x, int y, struct Bitmap* bmp, int rowWidth, cc_boo
 		if (width > 1)  width /= 2;
 		if (height > 1) height /= 2;
 
-		cur = (BitmapCol*)Mem_Alloc(width * height, BITMAPCOLOR_SIZE, "mipmaps");
 		GenMipmaps(width, height, cur, prev, rowWidth);
 
 		if (partial) {
@@ -88,11 +89,11 @@ static void Gfx_DoMipmaps(int x, int y, struct Bitmap* bmp, int rowWidth, cc_boo
 			_glTexImage2D(GL_TEXTURE_2D, lvl, GL_RGBA, width, height, 0, PIXEL_FORMAT, TRANSFER_FORMAT, cur);
 		}
 
-		if (prev != bmp->scan0) Mem_Free(prev);
-		prev    = cur;
+		prev     = cur;
+		cur     += width * height;
 		rowWidth = width;
 	}
-	if (prev != bmp->scan0) Mem_Free(prev);
+	FreeMipmaps(data, buffer);
 }
 
 /* TODO: Use GL_UNPACK_ROW_LENGTH for Desktop OpenGL instead */
@@ -1,4 +1,7 @@
 #include "Graphics.h"
+#ifdef CC_BUILD_SSE2
+#include <emmintrin.h>
+#endif
 #include "String.h"
 #include "Platform.h"
 #include "Funcs.h"
@@ -15,7 +18,7 @@ struct _GfxData Gfx;
 static GfxResourceID Gfx_quadVb, Gfx_texVb;
 const cc_string Gfx_LowPerfMessage = String_FromConst("&eRunning in reduced performance mode (game minimised or hidden)");
 
-static const int strideSizes[] = { SIZEOF_VERTEX_COLOURED, SIZEOF_VERTEX_TEXTURED };
+static const int strideSizes[] = { SIZEOF_VERTEX_COLOURED, SIZEOF_VERTEX_TEXTURED, SIZEOF_VERTEX_CHUNK };
 /* Whether mipmaps must be created for all dimensions down to 1x1 or not */
 static cc_bool customMipmapsLevels;
 /* Current format and size of vertices */
@@ -362,6 +365,68 @@ static BitmapCol AverageColor(BitmapCol p1, BitmapCol p2) {
 		aSum >> 1);
 }
 
+#if defined CC_BUILD_SSE2 && !defined BITMAP_16BPP
+#define MIPMAPS_SSE2
+/* Components of 4 pixels, widened to 32 bits each */
+struct MipmapsPixels { __m128i r, g, b, a; };
+
+static CC_INLINE struct MipmapsPixels Mipmaps_Unpack(__m128i v) {
+	__m128i mask = _mm_set1_epi32(0xFF);
+	struct MipmapsPixels p;
+
+	p.r = _mm_and_si128(_mm_srli_epi32(v, BITMAPCOLOR_R_SHIFT), mask);
+	p.g = _mm_and_si128(_mm_srli_epi32(v, BITMAPCOLOR_G_SHIFT), mask);
+	p.b = _mm_and_si128(_mm_srli_epi32(v, BITMAPCOLOR_B_SHIFT), mask);
+	p.a = _mm_and_si128(_mm_srli_epi32(v, BITMAPCOLOR_A_SHIFT), mask);
+	return p;
+}
+
+static CC_INLINE __m128i Mipmaps_Pack(struct MipmapsPixels p) {
+	__m128i rg = _mm_or_si128(_mm_slli_epi32(p.r, BITMAPCOLOR_R_SHIFT), _mm_slli_epi32(p.g, BITMAPCOLOR_G_SHIFT));
+	__m128i ba = _mm_or_si128(_mm_slli_epi32(p.b, BITMAPCOLOR_B_SHIFT), _mm_slli_epi32(p.a, BITMAPCOLOR_A_SHIFT));
+	return _mm_or_si128(rg, ba);
+}
+
+/* Computes (c1 * a1 + c2 * a2) / aSum */
+/* NOTE: Components are at most 255, so the products fit in the lower 16 bits of each lane. */
+/*  Quotients are also always exact after truncating, as the numerators are less than 2^24 */
+static CC_INLINE __m128i Mipmaps_Blend(__m128i c1, __m128i a1, __m128i c2, __m128i a2, __m128 aSum) {
+	__m128i sum = _mm_add_epi32(_mm_mullo_epi16(c1, a1), _mm_mullo_epi16(c2, a2));
+	return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(sum), aSum));
+}
+
+/* Same as AverageColor, but for 4 pairs of pixels at once */
+static CC_INLINE struct MipmapsPixels Mipmaps_Average(struct MipmapsPixels p1, struct MipmapsPixels p2) {
+	__m128i aSum = _mm_add_epi32(p1.a, p2.a);
+	/* avoid divide by 0 below (comparison result is -1 where aSum is 0) */
+	__m128i zero = _mm_cmpeq_epi32(aSum, _mm_setzero_si128());
+	__m128  div  = _mm_cvtepi32_ps(_mm_sub_epi32(aSum, zero));
+	struct MipmapsPixels ave;
+
+	ave.r = Mipmaps_Blend(p1.r, p1.a, p2.r, p2.a, div);
+	ave.g = Mipmaps_Blend(p1.g, p1.a, p2.g, p2.a, div);
+	ave.b = Mipmaps_Blend(p1.b, p1.a, p2.b, p2.a, div);
+	ave.a = _mm_srli_epi32(aSum, 1);
+	return ave;
+}
+
+/* Downsamples 8 pixels from each of the two source rows into 4 pixels */
+static CC_INLINE __m128i Mipmaps_Downsample(const BitmapCol* src0, const BitmapCol* src1) {
+	__m128 a0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(src0 + 0)));
+	__m128 a1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(src0 + 4)));
+	__m128 b0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(src1 + 0)));
+	__m128 b1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(src1 + 4)));
+	struct MipmapsPixels ave0, ave1;
+
+	/* Separate even and odd pixels of each row */
+	ave0 = Mipmaps_Average(Mipmaps_Unpack(_mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)))),
+						   Mipmaps_Unpack(_mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)))));
+	ave1 = Mipmaps_Average(Mipmaps_Unpack(_mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)))),
+						   Mipmaps_Unpack(_mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)))));
+	return Mipmaps_Pack(Mipmaps_Average(ave0, ave1));
+}
+#endif
+
 /* Generates the next mipmaps level bitmap by downsampling from the given bitmap. */
 static void GenMipmaps(int width, int height, BitmapCol* dst, BitmapCol* src, int srcWidth) {
 	int x, y;
@@ -380,8 +445,14 @@ static void GenMipmaps(int width, int height, BitmapCol* dst, BitmapCol* src, in
 	for (y = 0; y < height; y++) {
 		BitmapCol* src0 = src;
 		BitmapCol* src1 = src + srcWidth;
+		x = 0;
 
-		for (x = 0; x < width; x++) {
+#ifdef MIPMAPS_SSE2
+		for (; x + 4 <= width; x += 4) {
+			_mm_storeu_si128((__m128i*)&dst[x], Mipmaps_Downsample(&src0[x << 1], &src1[x << 1]));
+		}
+#endif
+		for (; x < width; x++) {
 			int srcX = (x << 1);
 			/* 2x2 bilinear filter */
 			BitmapCol ave0 = AverageColor(src0[srcX], src0[srcX + 1]);
@@ -404,6 +475,28 @@ static CC_NOINLINE int CalcMipmapsLevels(int width, int height) {
 	}
 }
 
+/* Mipmaps of up to this many pixels in total are generated on the stack (e.g. animated tiles) */
+#define MIPMAPS_FAST_SIZE (32 * 32)
+/* Returns storage large enough for all the mipmaps levels of the given bitmap, one after another. */
+/* buffer is returned when the levels fit within MIPMAPS_FAST_SIZE, avoiding a heap allocation. */
+static BitmapCol* AllocMipmaps(struct Bitmap* bmp, BitmapCol* buffer) {
+	int lvls = CalcMipmapsLevels(bmp->width, bmp->height);
+	int lvl, width = bmp->width, height = bmp->height, size = 0;
+
+	for (lvl = 1; lvl <= lvls; lvl++) {
+		if (width > 1)  width  /= 2;
+		if (height > 1) height /= 2;
+		size += width * height;
+	}
+
+	if (size <= MIPMAPS_FAST_SIZE) return buffer;
+	return (BitmapCol*)Mem_Alloc(size, BITMAPCOLOR_SIZE, "mipmaps");
+}
+
+static void FreeMipmaps(BitmapCol* data, BitmapCol* buffer) {
+	if (data != buffer) Mem_Free(data);
+}
+
 cc_bool Gfx_CheckTextureSize(int width, int height, cc_uint8 flags) {
 	int maxSize;
 	if (width  > Gfx.MaxTexWidth)  return false;
@@ -200,6 +200,11 @@ static int RunProgram(int argc, char** argv) {
 	} else if (argsCount == 1) {
 		String_Copy(&Game_Username, &args[0]);
 		RunGame();
+	/* --replay [file path] - replay packets recorded from a multiplayer server */
+	} else if (argsCount == 2 && String_CaselessEqualsConst(&args[0], DEFAULT_REPLAY_ARG)) {
+		Options_Get(LOPT_USERNAME, &Game_Username, DEFAULT_USERNAME);
+		String_Copy(&MP_ReplayFile, &args[1]);
+		RunGame();
 	/* 2 to 3 arguments - unsupported at present */
 	} else if (argsCount < 4) {
 		WarnMissingArgs(argsCount, args);